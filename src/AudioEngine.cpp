@@ -14,6 +14,10 @@
 #include "DSPChain.h"
 #include "Looper.h"
 #include "Recorder.h"
+#include "RetroCapture.h"
+#include "PresetPreview.h"
+#include "ClipPlayer.h"
+#include "BackingTrack.h"
 #include <cmath>
 #include <algorithm>
 #include <cstring>
@@ -33,6 +37,10 @@ AudioEngine::AudioEngine()
     dspChain_ = std::make_unique<DSPChain>();
     looper_ = std::make_unique<Looper>();
     recorder_ = std::make_unique<Recorder>();
+    retroCapture_ = std::make_unique<RetroCapture>();
+    presetPreview_ = std::make_unique<PresetPreview>();
+    clipPlayer_ = std::make_unique<ClipPlayer>();
+    backingTrack_ = std::make_unique<BackingTrack>();
 }
 
 AudioEngine::~AudioEngine()
@@ -106,6 +114,9 @@ bool AudioEngine::start(const std::string& inputDeviceId, const std::string& out
     dspChain_->setSampleRate(sampleRate);
     looper_->setSampleRate(sampleRate);
     recorder_->setSampleRate(sampleRate);
+    retroCapture_->setSampleRate(sampleRate);
+    presetPreview_->setSampleRate(sampleRate);
+    backingTrack_->setSampleRate(sampleRate);
     
     ma_device_config config = ma_device_config_init(ma_device_type_duplex);
     // Low latency tuning
@@ -183,8 +194,13 @@ bool AudioEngine::start(const std::string& inputDeviceId, const std::string& out
     uint32_t allocFrames = device_.playback.internalPeriodSizeInFrames; // internal resolved size
     if (allocFrames == 0) allocFrames = bufferSize; // fallback
     inputBuffer_.resize(allocFrames);
+    dryBuffer_.resize(allocFrames);
     processedLeft_.resize(allocFrames);
     processedRight_.resize(allocFrames);
+    wetLeft_.resize(allocFrames);
+    wetRight_.resize(allocFrames);
+    loopLeft_.resize(allocFrames);
+    loopRight_.resize(allocFrames);
     outputMono_.resize(allocFrames);
 
     // Inform DSP chain of low latency mode so it can skip high-latency effects.
@@ -217,10 +233,38 @@ void AudioEngine::processAudio(float* output, const float* input, uint32_t frame
         inputBuffer_[i] = input[i] * inputGain_.load();
     }
     updateMeters(inputBuffer_.data(), frameCount, inputLevel_, inputPeak_);
+    
+    // Raw DI for preset previews, which apply each preset's own input gain
+    presetPreview_->captureInput(input, frameCount);
+
+    // Stem recording and retro capture keep the DI as played, before clips
+    // and backing tracks join it
+    const bool recording = recorder_->isRecording();
+    const bool retro = retroCapture_->isEnabled();
+    if (recording || retro) {
+        std::copy(inputBuffer_.begin(), inputBuffer_.begin() + frameCount, dryBuffer_.begin());
+    }
+
+    // Clips and backing tracks routed through the effects play as if they were the DI
+    clipPlayer_->mixIntoInput(inputBuffer_.data(), frameCount);
+    backingTrack_->mixIntoInput(inputBuffer_.data(), frameCount);
 
     // DSP processing
     dspChain_->process(inputBuffer_.data(), processedLeft_.data(), processedRight_.data(), frameCount);
-    looper_->process(processedLeft_.data(), processedRight_.data(), frameCount);
+
+    // Stem recording and retro capture need the wet signal before the looper
+    if (recording || retro) {
+        std::copy(processedLeft_.begin(), processedLeft_.begin() + frameCount, wetLeft_.begin());
+        std::copy(processedRight_.begin(), processedRight_.begin() + frameCount, wetRight_.begin());
+    }
+
+    // The loop stem is tapped from the looper itself
+    looper_->process(processedLeft_.data(), processedRight_.data(), frameCount,
+                     recording ? loopLeft_.data() : nullptr, recording ? loopRight_.data() : nullptr);
+
+    if (retro) {
+        retroCapture_->process(dryBuffer_.data(), wetLeft_.data(), wetRight_.data(), frameCount);
+    }
 
     // Output gain
     float outGain = outputGain_.load();
@@ -229,8 +273,19 @@ void AudioEngine::processAudio(float* output, const float* input, uint32_t frame
         processedRight_[i] *= outGain;
     }
 
+    // Clips and backing tracks are heard and recorded with the live mix
+    clipPlayer_->mixInto(processedLeft_.data(), processedRight_.data(), frameCount);
+    backingTrack_->mixInto(processedLeft_.data(), processedRight_.data(), frameCount);
+
     // Recorder
-    recorder_->processAudio(processedLeft_.data(), processedRight_.data(), frameCount);
+    if (recording) {
+        RecorderStreams streams{ processedLeft_.data(), processedRight_.data(), dryBuffer_.data(),
+                                 wetLeft_.data(), wetRight_.data(), loopLeft_.data(), loopRight_.data() };
+        recorder_->processAudio(streams, frameCount);
+    }
+
+    // Preset preview is monitored only, never recorded
+    presetPreview_->mixInto(processedLeft_.data(), processedRight_.data(), frameCount, outGain);
 
     // Interleave
     for (uint32_t i = 0; i < frameCount; ++i) {
@@ -12,6 +12,10 @@
 class DSPChain;
 class Looper;
 class Recorder;
+class RetroCapture;
+class PresetPreview;
+class ClipPlayer;
+class BackingTrack;
 
 struct AudioDeviceInfo {
     std::string id;
@@ -51,6 +55,10 @@ public:
     DSPChain* getDSPChain() { return dspChain_.get(); }
     Looper* getLooper() { return looper_.get(); }
     Recorder* getRecorder() { return recorder_.get(); }
+    RetroCapture* getRetroCapture() { return retroCapture_.get(); }
+    PresetPreview* getPresetPreview() { return presetPreview_.get(); }
+    ClipPlayer* getClipPlayer() { return clipPlayer_.get(); }
+    BackingTrack* getBackingTrack() { return backingTrack_.get(); }
     
     // Info
     int getSampleRate() const { return sampleRate_; }
@@ -80,6 +88,10 @@ private:
     std::unique_ptr<DSPChain> dspChain_;
     std::unique_ptr<Looper> looper_;
     std::unique_ptr<Recorder> recorder_;
+    std::unique_ptr<RetroCapture> retroCapture_;
+    std::unique_ptr<PresetPreview> presetPreview_;
+    std::unique_ptr<ClipPlayer> clipPlayer_;
+    std::unique_ptr<BackingTrack> backingTrack_;
     
     // Smoothing for meters
     float inputLevelSmooth_{0.0f};
@@ -87,8 +99,13 @@ private:
 
     // Preallocated buffers to avoid per-callback allocations
     std::vector<float> inputBuffer_;
+    std::vector<float> dryBuffer_;
     std::vector<float> processedLeft_;
     std::vector<float> processedRight_;
+    std::vector<float> wetLeft_;
+    std::vector<float> wetRight_;
+    std::vector<float> loopLeft_;
+    std::vector<float> loopRight_;
     std::vector<float> outputMono_;
     bool lowLatencyMode_{false};
 };
@@ -0,0 +1,15 @@
+#include "AudioFileReader.h"
+
+bool AudioFileReader::open(const std::string& filepath)
+{
+    close();
+    isFlac_ = FlacReader::isFlacFile(filepath);
+    return isFlac_ ? flac_.open(filepath) : wav_.open(filepath);
+}
+
+void AudioFileReader::close()
+{
+    wav_.close();
+    flac_.close();
+    isFlac_ = false;
+}
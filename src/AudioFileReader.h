@@ -0,0 +1,53 @@
+#ifndef AUDIOFILEREADER_H
+#define AUDIOFILEREADER_H
+
+#include <string>
+#include <cstdint>
+#include "WavReader.h"
+#include "FlacReader.h"
+
+// A WAV or FLAC clip behind the WavReader interface. open() picks the
+// decoder from the file's marker rather than its extension, and everything
+// else forwards to it, so clip playback, backing tracks, reamping and
+// export read both formats the same way.
+class AudioFileReader {
+public:
+    AudioFileReader() = default;
+
+    bool open(const std::string& filepath);
+    void close();
+
+    bool isOpen() const { return isFlac_ ? flac_.isOpen() : wav_.isOpen(); }
+    bool isFlac() const { return isFlac_; }
+    int getSampleRate() const { return isFlac_ ? flac_.getSampleRate() : wav_.getSampleRate(); }
+    int getNumChannels() const { return isFlac_ ? flac_.getNumChannels() : wav_.getNumChannels(); }
+    int getBitsPerSample() const { return isFlac_ ? flac_.getBitsPerSample() : wav_.getBitsPerSample(); }
+    bool isFloat() const { return isFlac_ ? flac_.isFloat() : wav_.isFloat(); }
+    uint64_t getNumFrames() const { return isFlac_ ? flac_.getNumFrames() : wav_.getNumFrames(); }
+
+    int read(uint64_t startFrame, float* const* channels, int numChannels, int numFrames) const
+    {
+        return isFlac_ ? flac_.read(startFrame, channels, numChannels, numFrames)
+                       : wav_.read(startFrame, channels, numChannels, numFrames);
+    }
+
+    int readInt(uint64_t startFrame, int32_t* const* channels, int numChannels, int numFrames) const
+    {
+        return isFlac_ ? flac_.readInt(startFrame, channels, numChannels, numFrames)
+                       : wav_.readInt(startFrame, channels, numChannels, numFrames);
+    }
+
+    // WAV: faults in the mapped pages; FLAC: decodes the frames into the reader's cache
+    void prefetch(uint64_t startFrame, uint64_t numFrames) const
+    {
+        if (isFlac_) flac_.prefetch(startFrame, numFrames);
+        else wav_.prefetch(startFrame, numFrames);
+    }
+
+private:
+    WavReader wav_;
+    FlacReader flac_;
+    bool isFlac_{false};
+};
+
+#endif // AUDIOFILEREADER_H
@@ -0,0 +1,234 @@
+#include "AuditionRenderer.h"
+#include "ThreadPool.h"
+#include "WavWriter.h"
+#include "LoudnessMeter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+AuditionRenderer::AuditionRenderer()
+    : pool_(std::make_unique<ThreadPool>())
+{
+}
+
+AuditionRenderer::~AuditionRenderer()
+{
+    cancel();
+    pool_->waitAll();
+}
+
+std::vector<AuditionVariant> AuditionRenderer::makeGrid(const AuditionVariant& base, const std::vector<AuditionAxis>& axes)
+{
+    // Names are built from the swept values only; the base name is kept
+    // when there is nothing to sweep
+    std::vector<AuditionVariant> variants(1, base);
+    bool first = true;
+    for (const auto& axis : axes) {
+        if (axis.values.empty()) continue;
+
+        std::vector<AuditionVariant> expanded;
+        expanded.reserve(variants.size() * axis.values.size());
+        for (const auto& variant : variants) {
+            for (float value : axis.values) {
+                std::ostringstream label;
+                label << DSPParams::name(axis.id) << "=" << value;
+
+                AuditionVariant v = variant;
+                v.params[static_cast<int>(axis.id)] = value;
+                v.name = first ? label.str() : variant.name + "_" + label.str();
+                expanded.push_back(std::move(v));
+            }
+        }
+        variants.swap(expanded);
+        first = false;
+    }
+    return variants;
+}
+
+bool AuditionRenderer::start(const std::string& diPath, const std::vector<AuditionVariant>& variants,
+                             const EffectGraph& graph, const std::string& outputDir, SampleFormat format)
+{
+    if (isRunning()) return false;
+    pool_->waitAll();
+
+    if (variants.empty() || !reader_.open(diPath)) return false;
+
+    variants_ = variants;
+    graph_ = graph;
+    outputDir_ = outputDir;
+    format_ = format;
+    summaryPath_ = outputDir_ + "/summary.csv";
+
+    // File names are unique even if two presets sanitise to the same name
+    results_.assign(variants_.size(), AuditionResult{});
+    std::set<std::string> used;
+    for (size_t i = 0; i < variants_.size(); ++i) {
+        std::string base = safeFileName(variants_[i].name);
+        std::string fileName = base;
+        for (int n = 2; !used.insert(fileName).second; ++n) {
+            fileName = base + "_" + std::to_string(n);
+        }
+        results_[i].name = variants_[i].name;
+        results_[i].path = outputDir_ + "/" + fileName + ".wav";
+    }
+
+    renderedJobs_.store(0);
+    finishedJobs_.store(0);
+    failedJobs_.store(0);
+    summaryOk_.store(false);
+    cancelled_.store(false);
+    elapsedMicros_.store(0);
+    startTime_ = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < variants_.size(); ++i) {
+        pool_->submit([this, i] { renderVariant(i); });
+    }
+    return true;
+}
+
+void AuditionRenderer::cancel()
+{
+    cancelled_.store(true);
+}
+
+bool AuditionRenderer::isRunning() const
+{
+    return finishedJobs_.load() < getTotalJobs();
+}
+
+float AuditionRenderer::getRealtimeFactor() const
+{
+    int64_t micros = elapsedMicros_.load();
+    double elapsed = micros > 0
+        ? micros * 1e-6
+        : std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+    if (elapsed <= 0.0 || reader_.getSampleRate() <= 0) return 0.0f;
+
+    double clipSeconds = static_cast<double>(reader_.getNumFrames()) / reader_.getSampleRate();
+    int rendered = finishedJobs_.load() - failedJobs_.load();
+    return static_cast<float>(rendered * clipSeconds / elapsed);
+}
+
+void AuditionRenderer::renderVariant(size_t index)
+{
+    const AuditionVariant& variant = variants_[index];
+    AuditionResult& result = results_[index];
+
+    const int sampleRate = reader_.getSampleRate();
+    const int inputChannels = std::min(reader_.getNumChannels(), 2);
+
+    WavWriter writer;
+    writer.setFormat(format_);
+    bool ok = !cancelled_.load() && writer.open(result.path, sampleRate, 2);
+
+    if (ok) {
+        DSPChain chain;
+        chain.setSampleRate(sampleRate);
+        chain.getParams().apply(variant.params);
+        chain.setEffectGraph(graph_);
+
+        LoudnessMeter meter;
+        meter.reset(sampleRate, 2);
+
+        std::vector<float> inL(BLOCK_FRAMES), inR(BLOCK_FRAMES);
+        std::vector<float> outL(BLOCK_FRAMES), outR(BLOCK_FRAMES);
+        float* in[2] = { inL.data(), inR.data() };
+        const float* out[2] = { outL.data(), outR.data() };
+
+        uint64_t position = 0;
+        const uint64_t numFrames = reader_.getNumFrames();
+        while (ok && position < numFrames) {
+            if (cancelled_.load()) {
+                ok = false;
+                break;
+            }
+            int frames = static_cast<int>(std::min<uint64_t>(BLOCK_FRAMES, numFrames - position));
+            frames = reader_.read(position, in, inputChannels, frames);
+            if (frames <= 0) break;
+
+            // Same gain staging as the engine: input gain, chain, output gain
+            for (int i = 0; i < frames; ++i) {
+                float x = (inputChannels == 2) ? 0.5f * (inL[i] + inR[i]) : inL[i];
+                inL[i] = x * variant.inputGain;
+            }
+            chain.process(inL.data(), outL.data(), outR.data(), frames);
+            for (int i = 0; i < frames; ++i) {
+                outL[i] *= variant.outputGain;
+                outR[i] *= variant.outputGain;
+            }
+
+            meter.process(out, frames);
+            ok = writer.write(out, frames);
+            position += frames;
+        }
+
+        result.loudness = meter.getIntegratedLoudness();
+        result.peak = meter.getSamplePeak();
+    }
+
+    bool wasOpen = writer.isOpen();
+    if (!writer.close()) ok = false;
+    result.ok = ok;
+    if (!ok) {
+        failedJobs_.fetch_add(1);
+        if (wasOpen) std::remove(result.path.c_str());
+    }
+
+    // The last render to complete writes the summary and stops the clock;
+    // finishedJobs_ only reaches the total after that, so a finished batch
+    // always has its CSV
+    if (renderedJobs_.fetch_add(1) + 1 == getTotalJobs()) {
+        int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime_).count();
+        elapsedMicros_.store(std::max<int64_t>(1, micros));
+        summaryOk_.store(writeSummary());
+    }
+    finishedJobs_.fetch_add(1);
+}
+
+bool AuditionRenderer::writeSummary() const
+{
+    std::ofstream csv(summaryPath_);
+    if (!csv.is_open()) return false;
+
+    csv << "name,file,integrated_lufs,peak_dbfs,status\n";
+    for (const auto& result : results_) {
+        std::string name = result.name;
+        std::string::size_type pos = 0;
+        while ((pos = name.find('"', pos)) != std::string::npos) {
+            name.insert(pos, 1, '"');
+            pos += 2;
+        }
+        std::string file = result.path.substr(result.path.find_last_of('/') + 1);
+
+        csv << '"' << name << "\"," << file << ',';
+        char numbers[64];
+        if (result.ok && std::isfinite(result.loudness)) {
+            std::snprintf(numbers, sizeof(numbers), "%.2f,", result.loudness);
+        } else {
+            std::snprintf(numbers, sizeof(numbers), ",");
+        }
+        csv << numbers;
+        if (result.ok && result.peak > 0.0f) {
+            std::snprintf(numbers, sizeof(numbers), "%.2f,", 20.0 * std::log10(result.peak));
+        } else {
+            std::snprintf(numbers, sizeof(numbers), ",");
+        }
+        csv << numbers << (result.ok ? "ok" : "failed") << '\n';
+    }
+    return static_cast<bool>(csv.flush());
+}
+
+std::string AuditionRenderer::safeFileName(const std::string& name)
+{
+    std::string out;
+    for (char c : name) {
+        bool reserved = c == '/' || c == '\\' || c == ':' || c == '*' || c == '?'
+                     || c == '"' || c == '<' || c == '>' || c == '|';
+        out += (reserved || static_cast<unsigned char>(c) < 32) ? '_' : c;
+    }
+    return out.empty() ? "variant" : out;
+}
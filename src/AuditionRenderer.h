@@ -0,0 +1,93 @@
+#ifndef AUDITIONRENDERER_H
+#define AUDITIONRENDERER_H
+
+#include <atomic>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include "DSPChain.h"
+#include "PcmConverter.h"
+#include "AudioFileReader.h"
+
+class ThreadPool;
+
+// One combination to render: full parameter set plus the preset's gains
+struct AuditionVariant {
+    std::string name;
+    ParamValues params{};
+    float inputGain{1.0f};
+    float outputGain{1.0f};
+};
+
+// A parameter swept over a list of values
+struct AuditionAxis {
+    ParamId id;
+    std::vector<float> values;
+};
+
+struct AuditionResult {
+    std::string name;
+    std::string path;
+    bool ok{false};
+    double loudness{0.0}; // integrated LUFS
+    float peak{0.0f};     // linear sample peak
+};
+
+// Renders one DI file through many parameter sets at once, each on its own
+// DSPChain on a work-stealing pool, into <outputDir>/<variant>.wav. When the
+// batch finishes a summary.csv with loudness and peak per clip is written.
+class AuditionRenderer {
+public:
+    AuditionRenderer();
+    ~AuditionRenderer();
+
+    // Cartesian product of the axes applied on top of base. Names look like
+    // "driveAmount=0.5_delayMix=0.3".
+    static std::vector<AuditionVariant> makeGrid(const AuditionVariant& base, const std::vector<AuditionAxis>& axes);
+
+    // Returns false if a batch is running or the DI file cannot be read.
+    // Every variant runs in the given effect order.
+    bool start(const std::string& diPath, const std::vector<AuditionVariant>& variants,
+               const EffectGraph& graph, const std::string& outputDir, SampleFormat format);
+    void cancel();
+
+    bool isRunning() const;
+    int getTotalJobs() const { return static_cast<int>(variants_.size()); }
+    int getFinishedJobs() const { return finishedJobs_.load(); }
+    int getFailedJobs() const { return failedJobs_.load(); }
+    float getRealtimeFactor() const;
+    const std::string& getSummaryPath() const { return summaryPath_; }
+    bool summaryWritten() const { return summaryOk_.load(); }
+
+    // Valid once the batch has finished
+    const std::vector<AuditionResult>& getResults() const { return results_; }
+
+private:
+    void renderVariant(size_t index);
+    bool writeSummary() const;
+    static std::string safeFileName(const std::string& name);
+
+    std::unique_ptr<ThreadPool> pool_;
+    AudioFileReader reader_; // shared read-only by all workers
+    std::vector<AuditionVariant> variants_;
+    EffectGraph graph_;
+    std::vector<AuditionResult> results_; // each worker writes only its own entry
+    std::string outputDir_;
+    std::string summaryPath_;
+    SampleFormat format_{SampleFormat::Pcm24};
+
+    std::atomic<int> renderedJobs_{0};
+    std::atomic<int> finishedJobs_{0};
+    std::atomic<int> failedJobs_{0};
+    std::atomic<bool> cancelled_{false};
+    std::atomic<bool> summaryOk_{false};
+    std::chrono::steady_clock::time_point startTime_;
+    std::atomic<int64_t> elapsedMicros_{0}; // frozen when the last job finishes
+
+    static const int BLOCK_FRAMES = 1024;
+};
+
+#endif // AUDITIONRENDERER_H
@@ -0,0 +1,239 @@
+#include "BackingTrack.h"
+#include <algorithm>
+#include <chrono>
+
+BackingTrack::BackingTrack()
+    : left_(RENDER_BLOCK), right_(RENDER_BLOCK)
+{
+    prefetchThread_ = std::thread(&BackingTrack::prefetchLoop, this);
+}
+
+BackingTrack::~BackingTrack()
+{
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex_);
+        stopPrefetch_ = true;
+    }
+    prefetchCV_.notify_one();
+    if (prefetchThread_.joinable()) {
+        prefetchThread_.join();
+    }
+    unload();
+}
+
+void BackingTrack::setSampleRate(int sampleRate)
+{
+    if (sampleRate == sampleRate_) return;
+    const double position = getPosition();
+    sampleRate_ = sampleRate;
+    if (reader_) {
+        startStream(static_cast<uint64_t>(position * reader_->getSampleRate()));
+    }
+}
+
+bool BackingTrack::load(const std::string& path)
+{
+    auto reader = std::make_shared<AudioFileReader>();
+    if (!reader->open(path) || reader->getNumFrames() == 0) {
+        return false;
+    }
+
+    unload();
+    path_ = path;
+    reader_ = std::move(reader);
+    startStream(0);
+    return true;
+}
+
+void BackingTrack::unload()
+{
+    playing_.store(false);
+    stream_.store(nullptr);
+
+    // A callback that loaded the old stream may still be reading its ring
+    while (processing_.load()) {
+        std::this_thread::yield();
+    }
+    streamHold_.reset();
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex_);
+        prefetchStream_.reset();
+    }
+    reader_.reset();
+    path_.clear();
+}
+
+void BackingTrack::startStream(uint64_t trackFrame)
+{
+    auto stream = std::make_shared<Stream>();
+    stream->reader = reader_;
+    stream->resampler.reset(2, reader_->getSampleRate(), sampleRate_);
+    stream->ring.reset(2, static_cast<size_t>(RING_SECONDS) * sampleRate_);
+    stream->startFrame = std::min(trackFrame, reader_->getNumFrames());
+    stream->readFrame = stream->startFrame;
+    for (int ch = 0; ch < 2; ++ch) {
+        stream->decoded[ch].resize(DECODE_BLOCK);
+        stream->converted[ch].resize(DECODE_BLOCK);
+    }
+
+    // Prime the ring here so a seek while playing does not drop out
+    fill(*stream);
+
+    stream_.store(stream.get());
+    while (processing_.load()) {
+        std::this_thread::yield();
+    }
+    streamHold_ = stream;
+
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex_);
+        prefetchStream_ = std::move(stream);
+    }
+    prefetchCV_.notify_one();
+}
+
+void BackingTrack::play()
+{
+    if (!streamHold_) return;
+    if (streamHold_->endOfTrack.load() && streamHold_->ring.getReadAvailable() == 0) {
+        startStream(0);
+    }
+    playing_.store(true);
+}
+
+void BackingTrack::pause()
+{
+    playing_.store(false);
+}
+
+void BackingTrack::stop()
+{
+    playing_.store(false);
+    if (reader_) {
+        startStream(0);
+    }
+}
+
+void BackingTrack::seek(double seconds)
+{
+    if (!reader_) return;
+    startStream(static_cast<uint64_t>(std::max(0.0, seconds) * reader_->getSampleRate()));
+}
+
+double BackingTrack::getPosition() const
+{
+    if (!streamHold_ || !reader_) return 0.0;
+    const double position = static_cast<double>(streamHold_->startFrame) / reader_->getSampleRate()
+                          + static_cast<double>(streamHold_->played.load()) / sampleRate_;
+    return std::min(position, getDuration());
+}
+
+double BackingTrack::getDuration() const
+{
+    if (!reader_) return 0.0;
+    return static_cast<double>(reader_->getNumFrames()) / reader_->getSampleRate();
+}
+
+int BackingTrack::render(int numSamples)
+{
+    Stream* stream = stream_.load();
+    if (!stream || !playing_.load()) return 0;
+
+    float* channels[2] = { left_.data(), right_.data() };
+    const int wanted = std::min(numSamples, RENDER_BLOCK);
+    const int frames = static_cast<int>(stream->ring.read(channels, wanted));
+    stream->played.fetch_add(frames);
+    if (frames < wanted) {
+        if (stream->endOfTrack.load() && stream->ring.getReadAvailable() == 0) {
+            playing_.store(false);
+        } else {
+            underruns_.fetch_add(1);
+        }
+    }
+    return frames;
+}
+
+void BackingTrack::mixIntoInput(float* input, int numSamples)
+{
+    if (placement_.load() != Placement::PreChain) return;
+
+    processing_.store(true);
+    const float gain = volume_.load() * 0.5f;
+    for (int offset = 0; offset < numSamples; ) {
+        const int wanted = std::min(numSamples - offset, RENDER_BLOCK);
+        const int frames = render(wanted);
+        for (int i = 0; i < frames; ++i) {
+            input[offset + i] += (left_[i] + right_[i]) * gain;
+        }
+        if (frames < wanted) break;
+        offset += frames;
+    }
+    processing_.store(false);
+}
+
+void BackingTrack::mixInto(float* left, float* right, int numSamples)
+{
+    if (placement_.load() != Placement::PostChain) return;
+
+    processing_.store(true);
+    const float gain = volume_.load();
+    for (int offset = 0; offset < numSamples; ) {
+        const int wanted = std::min(numSamples - offset, RENDER_BLOCK);
+        const int frames = render(wanted);
+        for (int i = 0; i < frames; ++i) {
+            left[offset + i] += left_[i] * gain;
+            right[offset + i] += right_[i] * gain;
+        }
+        if (frames < wanted) break;
+        offset += frames;
+    }
+    processing_.store(false);
+}
+
+bool BackingTrack::fill(Stream& stream)
+{
+    float* decoded[2] = { stream.decoded[0].data(), stream.decoded[1].data() };
+    float* converted[2] = { stream.converted[0].data(), stream.converted[1].data() };
+    bool wrote = false;
+
+    while (!stream.endOfTrack.load()) {
+        const size_t space = stream.ring.getWriteAvailable();
+        if (space == 0) break;
+
+        if (stream.resampler.getAvailable() == 0) {
+            if (stream.flushed) {
+                stream.endOfTrack.store(true);
+                break;
+            }
+            // Mono tracks are duplicated, extra channels are ignored
+            const int frames = stream.reader->read(stream.readFrame, decoded, 2, DECODE_BLOCK);
+            if (frames > 0) {
+                stream.resampler.push(decoded, frames);
+                stream.readFrame += frames;
+            } else {
+                stream.resampler.flush();
+                stream.flushed = true;
+            }
+            continue;
+        }
+
+        const int frames = stream.resampler.pull(converted, static_cast<int>(std::min<size_t>(space, DECODE_BLOCK)));
+        stream.ring.write(converted, frames);
+        wrote = true;
+    }
+    return wrote;
+}
+
+void BackingTrack::prefetchLoop()
+{
+    std::unique_lock<std::mutex> lock(prefetchMutex_);
+    while (!stopPrefetch_) {
+        std::shared_ptr<Stream> stream = prefetchStream_;
+        if (stream) {
+            lock.unlock();
+            fill(*stream);
+            lock.lock();
+        }
+        prefetchCV_.wait_for(lock, std::chrono::milliseconds(PREFETCH_POLL_MS));
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef BACKINGTRACK_H
+#define BACKINGTRACK_H
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <string>
+#include <cstdint>
+#include "AudioFileReader.h"
+#include "Resampler.h"
+#include "SpscRingBuffer.h"
+
+// Backing track streamed from disk for playing along. A prefetch thread
+// reads and decodes the WAV or FLAC (any supported format, mono or stereo,
+// any sample rate), converts it to the engine rate and keeps a ring a couple
+// of seconds ahead; the audio thread only reads the ring. The track is mixed
+// after the effects, or summed to mono before them.
+class BackingTrack {
+public:
+    enum class Placement {
+        PostChain,
+        PreChain
+    };
+
+    BackingTrack();
+    ~BackingTrack();
+
+    // Engine stopped. A loaded track restarts at its position at the new rate.
+    void setSampleRate(int sampleRate);
+
+    // UI thread
+    bool load(const std::string& path);
+    void unload();
+    bool isLoaded() const { return stream_.load() != nullptr; }
+    const std::string& getPath() const { return path_; }
+
+    void play();
+    void pause();
+    void stop();
+    bool isPlaying() const { return playing_.load(); }
+
+    // Position and length in seconds of the track
+    void seek(double seconds);
+    double getPosition() const;
+    double getDuration() const;
+
+    // Blocks where the ring ran dry while playing
+    uint64_t getUnderruns() const { return underruns_.load(); }
+
+    void setVolume(float volume) { volume_.store(volume); }
+    void setPlacement(Placement placement) { placement_.store(placement); }
+    Placement getPlacement() const { return placement_.load(); }
+
+    // Audio thread. Each call only acts for its placement.
+    void mixIntoInput(float* input, int numSamples);
+    void mixInto(float* left, float* right, int numSamples);
+
+private:
+    // One pass over the track from startFrame; a seek replaces the whole stream
+    struct Stream {
+        std::shared_ptr<AudioFileReader> reader;
+        Resampler resampler;
+        SpscRingBuffer ring;
+        uint64_t startFrame{0};     // track frames
+        uint64_t readFrame{0};      // next track frame to decode
+        bool flushed{false};
+        std::atomic<uint64_t> played{0}; // engine frames taken from the ring
+        std::atomic<bool> endOfTrack{false};
+
+        // Producer scratch
+        std::vector<float> decoded[2];
+        std::vector<float> converted[2];
+    };
+
+    void startStream(uint64_t trackFrame);
+    int render(int numSamples);
+    void prefetchLoop();
+    static bool fill(Stream& stream);
+
+    int sampleRate_{48000};
+    std::string path_;
+    std::shared_ptr<AudioFileReader> reader_;
+
+    // The UI keeps the stream alive, the audio thread reads through it
+    std::shared_ptr<Stream> streamHold_;
+    std::atomic<Stream*> stream_{nullptr};
+    std::atomic<bool> processing_{false};
+
+    std::atomic<bool> playing_{false};
+    std::atomic<float> volume_{1.0f};
+    std::atomic<Placement> placement_{Placement::PostChain};
+    std::atomic<uint64_t> underruns_{0};
+
+    // Audio thread only
+    std::vector<float> left_;
+    std::vector<float> right_;
+
+    std::thread prefetchThread_;
+    std::mutex prefetchMutex_;
+    std::condition_variable prefetchCV_;
+    std::shared_ptr<Stream> prefetchStream_;
+    bool stopPrefetch_{false};
+
+    static const int RING_SECONDS = 2;
+    static const int DECODE_BLOCK = 4096;
+    static const int RENDER_BLOCK = 1024;
+    static const int PREFETCH_POLL_MS = 10;
+};
+
+#endif // BACKINGTRACK_H
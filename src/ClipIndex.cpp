@@ -0,0 +1,356 @@
+#include "ClipIndex.h"
+#include "ThreadPool.h"
+#include "AudioFileReader.h"
+#include "LoudnessMeter.h"
+#include "PeakFile.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    const char* const INDEX_FILE_NAME = ".clipindex";
+    const int RESCAN_DELAY_MS = 200;  // coalesces bursts of directory events
+    const int SAVE_DELAY_MS = 2000;
+    const int NOTIFY_DELAY_MS = 100;
+    const int MEASURE_BLOCK_FRAMES = 16384;
+}
+
+ClipIndex::ClipIndex(QObject* parent)
+    : QObject(parent)
+    , pool_(std::make_unique<ThreadPool>())
+{
+    rescanTimer_.setSingleShot(true);
+    rescanTimer_.setInterval(RESCAN_DELAY_MS);
+    saveTimer_.setSingleShot(true);
+    saveTimer_.setInterval(SAVE_DELAY_MS);
+    changedTimer_.setSingleShot(true);
+    changedTimer_.setInterval(NOTIFY_DELAY_MS);
+
+    connect(&watcher_, &QFileSystemWatcher::directoryChanged, this, [this]() { rescanTimer_.start(); });
+    connect(&rescanTimer_, &QTimer::timeout, this, &ClipIndex::sync);
+    connect(&saveTimer_, &QTimer::timeout, this, &ClipIndex::save);
+    connect(&changedTimer_, &QTimer::timeout, this, &ClipIndex::clipsChanged);
+}
+
+ClipIndex::~ClipIndex()
+{
+    cancelled_.store(true);
+    pool_->waitAll();
+    if (saveTimer_.isActive()) {
+        save();
+    }
+}
+
+void ClipIndex::setDirectory(const QString& directory)
+{
+    if (!directory_.isEmpty()) {
+        watcher_.removePath(directory_);
+        if (saveTimer_.isActive()) {
+            saveTimer_.stop();
+            save();
+        }
+    }
+
+    directory_ = directory;
+    ++generation_;
+    entries_.clear();
+    pending_.clear();
+
+    load();
+    watcher_.addPath(directory_);
+    sync();
+    emit clipsChanged();
+}
+
+QStringList ClipIndex::clipNames() const
+{
+    std::vector<const Entry*> sorted;
+    sorted.reserve(entries_.size());
+    for (const Entry& entry : entries_) {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) {
+        return a->mtime != b->mtime ? a->mtime > b->mtime : a->fileName < b->fileName;
+    });
+
+    QStringList names;
+    QSet<QString> seen;
+    for (const Entry* entry : sorted) {
+        QString name = QFileInfo(entry->fileName).completeBaseName();
+        if (!seen.contains(name)) {
+            seen.insert(name);
+            names.append(name);
+        }
+    }
+    return names;
+}
+
+QString ClipIndex::peaksPath(const QString& clipName) const
+{
+    return directory_ + "/" + clipName + ".peaks";
+}
+
+bool ClipIndex::clipInfo(const QString& clipName, ClipInfo& info) const
+{
+    auto it = entries_.find(clipName + ".wav");
+    if (it == entries_.end()) {
+        it = entries_.find(clipName + ".flac");
+    }
+    if (it == entries_.end()) return false;
+
+    const Entry& entry = it.value();
+    info.name = clipName;
+    info.filepath = directory_ + "/" + entry.fileName;
+    info.timestamp = QDateTime::fromMSecsSinceEpoch(entry.mtime);
+    info.fileSize = entry.size;
+    info.duration = entry.duration;
+    info.sampleRate = entry.sampleRate;
+    info.numChannels = entry.numChannels;
+    info.peak = entry.peak;
+    info.truePeak = entry.truePeak;
+    info.loudness = entry.loudness;
+    info.loudnessRange = entry.loudnessRange;
+    return true;
+}
+
+void ClipIndex::refreshFile(const QString& fileName)
+{
+    QFileInfo fileInfo(directory_ + "/" + fileName);
+    if (!fileInfo.exists()) {
+        if (entries_.remove(fileName) > 0) {
+            scheduleSave();
+            notifyChanged();
+        }
+        return;
+    }
+
+    auto it = entries_.find(fileName);
+    const qint64 mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+    if (it != entries_.end() && it->size == fileInfo.size() && it->mtime == mtime) return;
+
+    // The header is cheap to read now; peak and loudness follow from the pool
+    Entry entry;
+    entry.fileName = fileName;
+    entry.size = fileInfo.size();
+    entry.mtime = mtime;
+    readHeader(fileInfo.filePath(), entry);
+    entries_[fileName] = entry;
+    analyse(fileName);
+    notifyChanged();
+}
+
+void ClipIndex::sync()
+{
+    if (directory_.isEmpty()) return;
+
+    QDir dir(directory_);
+    QFileInfoList files = dir.entryInfoList(QStringList() << "*.wav" << "*.flac", QDir::Files);
+
+    bool changed = false;
+    QSet<QString> present;
+    for (const QFileInfo& file : files) {
+        const QString fileName = file.fileName();
+        present.insert(fileName);
+
+        auto it = entries_.find(fileName);
+        const qint64 mtime = file.lastModified().toMSecsSinceEpoch();
+        if (it != entries_.end() && it->size == file.size() && it->mtime == mtime) continue;
+        if (pending_.contains(fileName)) continue;
+
+        // Listed straight away; the worker fills in the rest
+        if (it == entries_.end()) {
+            Entry entry;
+            entry.fileName = fileName;
+            entry.size = -1;
+            entry.mtime = mtime;
+            entries_.insert(fileName, entry);
+            changed = true;
+        }
+        analyse(fileName);
+    }
+
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (!present.contains(it.key())) {
+            it = entries_.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    if (changed) {
+        scheduleSave();
+        notifyChanged();
+    }
+}
+
+void ClipIndex::analyse(const QString& fileName)
+{
+    if (pending_.contains(fileName)) return;
+    pending_.insert(fileName);
+
+    const QString path = directory_ + "/" + fileName;
+    const QString peaks = peaksPath(QFileInfo(fileName).completeBaseName());
+    const quint64 generation = generation_;
+    pool_->submit([this, path, peaks, fileName, generation]() {
+        Entry entry;
+        entry.fileName = fileName;
+
+        // Stat before reading, so a file still being written is seen as
+        // changed again on the next sync
+        QFileInfo fileInfo(path);
+        bool exists = fileInfo.exists();
+        if (exists) {
+            entry.size = fileInfo.size();
+            entry.mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+            if (readHeader(path, entry)) {
+                measure(path, peaks, entry, cancelled_);
+            }
+        }
+        QMetaObject::invokeMethod(this, [this, entry, exists, generation]() {
+            applyResult(entry, exists, generation);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ClipIndex::applyResult(const Entry& entry, bool exists, quint64 generation)
+{
+    if (generation != generation_) return;
+    pending_.remove(entry.fileName);
+
+    if (exists) {
+        entries_[entry.fileName] = entry;
+    } else {
+        entries_.remove(entry.fileName);
+    }
+    scheduleSave();
+    notifyChanged();
+}
+
+void ClipIndex::notifyChanged()
+{
+    // Many results arriving together cause one refresh
+    if (!changedTimer_.isActive()) {
+        changedTimer_.start();
+    }
+}
+
+void ClipIndex::scheduleSave()
+{
+    if (!saveTimer_.isActive()) {
+        saveTimer_.start();
+    }
+}
+
+bool ClipIndex::readHeader(const QString& path, Entry& entry)
+{
+    if (path.endsWith(".flac", Qt::CaseInsensitive)) {
+        // STREAMINFO follows the marker and block header; read directly so
+        // listing doesn't decode the whole file
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(18)) return false;
+        QByteArray bytes = file.read(8);
+        if (bytes.size() != 8) return false;
+
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(bytes.constData());
+        entry.sampleRate = (b[0] << 12) | (b[1] << 4) | (b[2] >> 4);
+        entry.numChannels = ((b[2] >> 1) & 0x07) + 1;
+        quint64 totalSamples = (quint64(b[3] & 0x0F) << 32) | (quint64(b[4]) << 24)
+                             | (quint64(b[5]) << 16) | (quint64(b[6]) << 8) | b[7];
+        entry.duration = entry.sampleRate > 0 ? static_cast<float>(totalSamples) / entry.sampleRate : 0.0f;
+        return entry.sampleRate > 0;
+    }
+
+    WavReader reader;
+    if (!reader.open(path.toStdString())) return false;
+    entry.sampleRate = reader.getSampleRate();
+    entry.numChannels = reader.getNumChannels();
+    entry.duration = static_cast<float>(static_cast<double>(reader.getNumFrames()) / reader.getSampleRate());
+    return true;
+}
+
+void ClipIndex::measure(const QString& path, const QString& peaksPath, Entry& entry,
+                        const std::atomic<bool>& cancelled)
+{
+    AudioFileReader reader;
+    if (!reader.open(path.toStdString())) return;
+
+    const int numChannels = reader.getNumChannels();
+    std::vector<std::vector<float>> buffers(numChannels, std::vector<float>(MEASURE_BLOCK_FRAMES));
+    std::vector<float*> channels(numChannels);
+    for (int ch = 0; ch < numChannels; ++ch) {
+        channels[ch] = buffers[ch].data();
+    }
+
+    LoudnessMeter meter;
+    meter.reset(reader.getSampleRate(), numChannels);
+    PeakFile::Builder peaks;
+    peaks.reset(reader.getSampleRate(), numChannels);
+    const uint64_t numFrames = reader.getNumFrames();
+    for (uint64_t pos = 0; pos < numFrames; pos += MEASURE_BLOCK_FRAMES) {
+        if (cancelled.load()) return;
+        int frames = static_cast<int>(std::min<uint64_t>(MEASURE_BLOCK_FRAMES, numFrames - pos));
+        frames = reader.read(pos, channels.data(), numChannels, frames);
+        if (frames <= 0) break;
+        meter.process(channels.data(), frames);
+        peaks.process(channels.data(), frames);
+    }
+
+    // A FLAC take cut short has a stale STREAMINFO count; the decoded length wins
+    entry.duration = static_cast<float>(static_cast<double>(numFrames) / reader.getSampleRate());
+    entry.peak = meter.getSamplePeak();
+    entry.truePeak = meter.getTruePeak();
+    entry.loudness = meter.getIntegratedLoudness();
+    entry.loudnessRange = meter.getLoudnessRange();
+    peaks.write(peaksPath.toStdString(), static_cast<uint64_t>(entry.size), entry.mtime);
+}
+
+void ClipIndex::load()
+{
+    QFile file(directory_ + "/" + INDEX_FILE_NAME);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0, count = 0;
+    in >> magic >> version >> count;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION) return;
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Entry entry;
+        qint32 sampleRate = 0, numChannels = 0;
+        in >> entry.fileName >> entry.size >> entry.mtime >> entry.duration
+           >> sampleRate >> numChannels >> entry.peak >> entry.truePeak
+           >> entry.loudness >> entry.loudnessRange;
+        entry.sampleRate = sampleRate;
+        entry.numChannels = numChannels;
+        if (in.status() == QDataStream::Ok) {
+            entries_.insert(entry.fileName, entry);
+        }
+    }
+    if (in.status() != QDataStream::Ok) {
+        entries_.clear(); // damaged; the sync rebuilds it
+    }
+}
+
+void ClipIndex::save()
+{
+    if (directory_.isEmpty()) return;
+
+    // Written to a temporary and renamed, so a crash never leaves half an index
+    QSaveFile file(directory_ + "/" + INDEX_FILE_NAME);
+    if (!file.open(QIODevice::WriteOnly)) return;
+
+    QDataStream out(&file);
+    out << INDEX_MAGIC << INDEX_VERSION << static_cast<quint32>(entries_.size());
+    for (const Entry& entry : entries_) {
+        out << entry.fileName << entry.size << entry.mtime << entry.duration
+            << static_cast<qint32>(entry.sampleRate) << static_cast<qint32>(entry.numChannels)
+            << entry.peak << entry.truePeak << entry.loudness << entry.loudnessRange;
+    }
+    file.commit();
+}
@@ -0,0 +1,93 @@
+#ifndef CLIPINDEX_H
+#define CLIPINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <atomic>
+#include <memory>
+#include "ClipManager.h"
+
+class ThreadPool;
+
+// Persistent metadata for every clip in a directory, so the clip panel
+// never has to open audio files to list them. The index is saved next to
+// the clips and kept current by a QFileSystemWatcher: a directory change
+// only stats the listing, and files whose size or mtime changed are
+// re-analysed (header, peaks, loudness and range) on a worker pool. The same pass
+// writes the clip's waveform sidecar (<clip>.peaks, see PeakFile).
+class ClipIndex : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ClipIndex(QObject* parent = nullptr);
+    ~ClipIndex();
+
+    // Loads the saved index for the directory, then syncs in the background
+    void setDirectory(const QString& directory);
+
+    // Clip names (file name without extension), newest first
+    QStringList clipNames() const;
+
+    // Indexed metadata, no file access. A clip stored as both WAV and FLAC
+    // reports the WAV, like ClipManager::getClipPath().
+    bool clipInfo(const QString& clipName, ClipInfo& info) const;
+
+    // Stats one file ("Clip_x.wav") and re-reads it if it changed; catches
+    // files rewritten in place, which raise no directory event
+    void refreshFile(const QString& fileName);
+
+    // Compares the directory listing with the index
+    void sync();
+
+    // Waveform sidecar for a clip name
+    QString peaksPath(const QString& clipName) const;
+
+signals:
+    void clipsChanged();
+
+private:
+    struct Entry {
+        QString fileName;
+        qint64 size{0};
+        qint64 mtime{0}; // ms since epoch
+        float duration{0.0f};
+        int sampleRate{0};
+        int numChannels{0};
+        float peak{-1.0f};
+        float truePeak{-1.0f};
+        double loudness{0.0};
+        double loudnessRange{0.0};
+    };
+
+    void load();
+    void save();
+    void scheduleSave();
+    void analyse(const QString& fileName);
+    void applyResult(const Entry& entry, bool exists, quint64 generation);
+    void notifyChanged();
+    static bool readHeader(const QString& path, Entry& entry);
+    static void measure(const QString& path, const QString& peaksPath, Entry& entry,
+                        const std::atomic<bool>& cancelled);
+
+    QString directory_;
+    QHash<QString, Entry> entries_; // by file name
+    QSet<QString> pending_;         // files being analysed
+    quint64 generation_{0};         // bumped per directory, drops stale results
+
+    QFileSystemWatcher watcher_;
+    QTimer rescanTimer_;
+    QTimer saveTimer_;
+    QTimer changedTimer_;
+    std::unique_ptr<ThreadPool> pool_;
+    std::atomic<bool> cancelled_{false};
+
+    static const quint32 INDEX_MAGIC = 0x47434958; // "GCIX"
+    static const quint32 INDEX_VERSION = 4;     // 2: .peaks sidecars, 3: true peak and LRA, 4: FLAC measured
+};
+
+#endif // CLIPINDEX_H
@@ -0,0 +1,208 @@
+#include "ClipListModel.h"
+#include "ClipIndex.h"
+#include "ClipManager.h"
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    QString formatDuration(float seconds)
+    {
+        int mins = static_cast<int>(seconds) / 60;
+        int secs = static_cast<int>(seconds) % 60;
+        return QString("%1:%2").arg(mins, 2, 10, QChar('0')).arg(secs, 2, 10, QChar('0'));
+    }
+
+    float linearTodB(float linear)
+    {
+        if (linear < 0.00001f) return -100.0f;
+        return 20.0f * std::log10(linear);
+    }
+}
+
+ClipListModel::ClipListModel(ClipIndex* index, QObject* parent)
+    : QAbstractListModel(parent)
+    , index_(index)
+{
+    connect(index_, &ClipIndex::clipsChanged, this, &ClipListModel::refresh);
+    rows_ = buildRows();
+}
+
+int ClipListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : rows_.size();
+}
+
+QVariant ClipListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows_.size()) return QVariant();
+
+    const QString& name = rows_[index.row()];
+    switch (role) {
+        case Qt::DisplayRole:
+            return name;
+        case Qt::ToolTipRole:
+            return tooltip(name);
+        default:
+            return QVariant();
+    }
+}
+
+QString ClipListModel::clipName(int row) const
+{
+    return (row >= 0 && row < rows_.size()) ? rows_[row] : QString();
+}
+
+int ClipListModel::rowOf(const QString& clipName) const
+{
+    return rows_.indexOf(clipName);
+}
+
+void ClipListModel::setSortOrder(SortOrder order)
+{
+    if (order == sortOrder_) return;
+    sortOrder_ = order;
+    refresh();
+}
+
+void ClipListModel::setFilter(const QString& text)
+{
+    if (text == filter_) return;
+    filter_ = text;
+    refresh();
+}
+
+QString ClipListModel::tooltip(const QString& clipName) const
+{
+    // Straight from the index, no file access
+    ClipInfo info;
+    if (!index_->clipInfo(clipName, info) || info.sampleRate <= 0) return QString();
+
+    QString tip = QString("%1 | %2 kHz | %3 ch")
+        .arg(formatDuration(info.duration))
+        .arg(info.sampleRate / 1000.0, 0, 'g', 4)
+        .arg(info.numChannels);
+    if (info.peak > 0.0f) {
+        tip += QString(" | %1 LUFS | LRA %2 LU | peak %3 dBFS | true peak %4 dBTP")
+            .arg(std::isfinite(info.loudness) ? QString::number(info.loudness, 'f', 1) : QString("-inf"))
+            .arg(info.loudnessRange, 0, 'f', 1)
+            .arg(linearTodB(info.peak), 0, 'f', 1)
+            .arg(linearTodB(info.truePeak), 0, 'f', 1);
+    }
+    return tip;
+}
+
+QStringList ClipListModel::buildRows() const
+{
+    // Newest first from the index; other orders need one metadata lookup per clip
+    QStringList names = index_->clipNames();
+    if (!filter_.isEmpty()) {
+        names = names.filter(filter_, Qt::CaseInsensitive);
+    }
+
+    switch (sortOrder_) {
+        case SortNewest:
+            break;
+        case SortOldest:
+            std::reverse(names.begin(), names.end());
+            break;
+        case SortName:
+            std::stable_sort(names.begin(), names.end(), [](const QString& a, const QString& b) {
+                return QString::compare(a, b, Qt::CaseInsensitive) < 0;
+            });
+            break;
+        case SortLongest:
+        case SortLoudest: {
+            QHash<QString, double> keys;
+            keys.reserve(names.size());
+            for (const QString& name : names) {
+                ClipInfo info;
+                double key = -std::numeric_limits<double>::infinity();
+                if (index_->clipInfo(name, info)) {
+                    if (sortOrder_ == SortLongest) key = info.duration;
+                    else if (info.peak >= 0.0f && std::isfinite(info.loudness)) key = info.loudness;
+                }
+                keys.insert(name, key);
+            }
+            std::stable_sort(names.begin(), names.end(), [&keys](const QString& a, const QString& b) {
+                return keys.value(a) > keys.value(b);
+            });
+            break;
+        }
+    }
+    return names;
+}
+
+void ClipListModel::refresh()
+{
+    const QStringList target = buildRows();
+
+    // 1. Remove rows that are gone, as contiguous ranges from the end
+    const QSet<QString> targetSet(target.begin(), target.end());
+    for (int row = rows_.size() - 1; row >= 0; ) {
+        if (targetSet.contains(rows_[row])) {
+            --row;
+            continue;
+        }
+        int first = row;
+        while (first > 0 && !targetSet.contains(rows_[first - 1])) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, row);
+        rows_.erase(rows_.begin() + first, rows_.begin() + row + 1);
+        endRemoveRows();
+        row = first - 1;
+    }
+
+    // 2. Rows present before and after must keep their relative order for
+    //    plain insertion; otherwise reorder them as one layout change
+    const QSet<QString> currentSet(rows_.begin(), rows_.end());
+    QStringList kept;
+    kept.reserve(rows_.size());
+    for (const QString& name : target) {
+        if (currentSet.contains(name)) {
+            kept.append(name);
+        }
+    }
+    if (kept != rows_) {
+        emit layoutAboutToBeChanged();
+        QHash<QString, int> newRows;
+        for (int row = 0; row < kept.size(); ++row) {
+            newRows.insert(kept[row], row);
+        }
+        const QModelIndexList from = persistentIndexList();
+        QModelIndexList to;
+        to.reserve(from.size());
+        for (const QModelIndex& index : from) {
+            to.append(this->index(newRows.value(rows_[index.row()])));
+        }
+        rows_ = kept;
+        changePersistentIndexList(from, to);
+        emit layoutChanged();
+    }
+
+    // 3. Insert new rows, as contiguous ranges in target order
+    for (int row = 0; row < target.size(); ) {
+        if (row < rows_.size() && rows_[row] == target[row]) {
+            ++row;
+            continue;
+        }
+        int last = row;
+        while (last + 1 < target.size() && !currentSet.contains(target[last + 1])) {
+            ++last;
+        }
+        beginInsertRows(QModelIndex(), row, last);
+        for (int i = row; i <= last; ++i) {
+            rows_.insert(i, target[i]);
+        }
+        endInsertRows();
+        row = last + 1;
+    }
+
+    // Metadata of existing rows may have changed; the view repaints only visible rows
+    if (!rows_.isEmpty()) {
+        emit dataChanged(index(0), index(rows_.size() - 1), { Qt::ToolTipRole });
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef CLIPLISTMODEL_H
+#define CLIPLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QStringList>
+#include <QVector>
+
+class ClipIndex;
+
+// Clip names from the clip index for a QListView. Metadata is only looked up
+// when the view asks for a row (tooltips of visible rows), and sorting and
+// filtering work on the in-memory index. On every index change the new row
+// list is diffed against the current one and applied as row removals,
+// insertions or a layout change, so selection and scroll position survive
+// and a large library is never rebuilt wholesale.
+class ClipListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum SortOrder {
+        SortNewest,
+        SortOldest,
+        SortName,
+        SortLongest,
+        SortLoudest
+    };
+
+    explicit ClipListModel(ClipIndex* index, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    QString clipName(int row) const;
+    int rowOf(const QString& clipName) const;
+
+    void setSortOrder(SortOrder order);
+    SortOrder getSortOrder() const { return sortOrder_; }
+
+    // Case-insensitive substring match on the clip name
+    void setFilter(const QString& text);
+
+public slots:
+    // Re-reads the index and applies the difference
+    void refresh();
+
+private:
+    QStringList buildRows() const;
+    QString tooltip(const QString& clipName) const;
+
+    ClipIndex* index_;
+    QStringList rows_;
+    SortOrder sortOrder_{SortNewest};
+    QString filter_;
+};
+
+#endif // CLIPLISTMODEL_H
@@ -1,10 +1,22 @@
 #include "ClipManager.h"
+#include "ClipIndex.h"
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QDesktopServices>
 #include <QUrl>
 #include <QProcess>
+#include <thread>
+#include "FlacEncoder.h"
+#include "PeakFile.h"
+#include "AudioFileReader.h"
+#include "WavWriter.h"
+#include "LoudnessMeter.h"
+#include <cmath>
+
+namespace {
+    constexpr int EXPORT_BLOCK_FRAMES = 16384;
+}
 
 ClipManager::ClipManager()
 {
@@ -17,12 +29,22 @@ ClipManager::ClipManager()
 #endif
     
     ensureDirectoryExists();
+    index_ = std::make_unique<ClipIndex>();
+    index_->setDirectory(clipsDirectory_);
+}
+
+ClipManager::~ClipManager()
+{
+    if (jobThread_.joinable()) {
+        jobThread_.join();
+    }
 }
 
 void ClipManager::setClipsDirectory(const QString& directory)
 {
     clipsDirectory_ = directory;
     ensureDirectoryExists();
+    index_->setDirectory(clipsDirectory_);
 }
 
 void ClipManager::ensureDirectoryExists()
@@ -35,69 +57,71 @@ void ClipManager::ensureDirectoryExists()
 
 QStringList ClipManager::getClipList()
 {
-    QDir dir(clipsDirectory_);
-    QStringList filters;
-    filters << "*.wav";
-    
-    QFileInfoList files = dir.entryInfoList(filters, QDir::Files, QDir::Time);
-    QStringList clipNames;
-    
-    for (const QFileInfo& file : files) {
-        clipNames.append(file.baseName());
+    return index_->clipNames();
+}
+
+QString ClipManager::getClipPath(const QString& clipName) const
+{
+    // WAV wins if both exist (e.g. while a conversion is in progress)
+    QString wavPath = clipsDirectory_ + "/" + clipName + ".wav";
+    if (QFile::exists(wavPath)) {
+        return wavPath;
     }
-    
-    return clipNames;
+    QString flacPath = clipsDirectory_ + "/" + clipName + ".flac";
+    if (QFile::exists(flacPath)) {
+        return flacPath;
+    }
+    return wavPath;
+}
+
+QString ClipManager::getPeaksPath(const QString& clipName) const
+{
+    return index_->peaksPath(clipName);
 }
 
 ClipInfo ClipManager::getClipInfo(const QString& clipName)
 {
     ClipInfo info;
-    QString filepath = clipsDirectory_ + "/" + clipName + ".wav";
-    QFileInfo fileInfo(filepath);
-    
-    if (fileInfo.exists()) {
-        info.name = clipName;
-        info.filepath = filepath;
-        info.timestamp = fileInfo.lastModified();
-        info.fileSize = fileInfo.size();
-        
-        // Read WAV file to get duration
-        QFile file(filepath);
-        if (file.open(QIODevice::ReadOnly)) {
-            file.seek(24); // Skip to sample rate position
-            char buffer[4];
-            file.read(buffer, 4);
-            int sampleRate = *reinterpret_cast<int*>(buffer);
-            
-            file.seek(40); // Data chunk size
-            file.read(buffer, 4);
-            int dataSize = *reinterpret_cast<int*>(buffer);
-            
-            int bytesPerSample = 6; // 2 channels * 24 bits / 8
-            int numSamples = dataSize / bytesPerSample;
-            info.duration = static_cast<float>(numSamples) / sampleRate;
-            
-            file.close();
-        }
-    }
+    info.duration = 0.0f;
+    info.fileSize = 0;
     
+    index_->refreshFile(QFileInfo(getClipPath(clipName)).fileName());
+    index_->clipInfo(clipName, info);
     return info;
 }
 
 bool ClipManager::renameClip(const QString& oldName, const QString& newName)
 {
-    QString oldPath = clipsDirectory_ + "/" + oldName + ".wav";
-    QString newPath = clipsDirectory_ + "/" + newName + ".wav";
+    if (isJobClip(oldName)) {
+        return false;
+    }
+    QString oldPath = getClipPath(oldName);
+    QString newPath = clipsDirectory_ + "/" + newName + "." + QFileInfo(oldPath).suffix();
     
     QFile file(oldPath);
-    return file.rename(newPath);
+    bool ok = file.rename(newPath);
+    if (ok) {
+        QFile::rename(getPeaksPath(oldName), getPeaksPath(newName));
+    }
+    // Only these two entries can have changed, so no directory listing
+    index_->refreshFile(QFileInfo(oldPath).fileName());
+    index_->refreshFile(QFileInfo(newPath).fileName());
+    return ok;
 }
 
 bool ClipManager::deleteClip(const QString& clipName)
 {
-    QString filepath = clipsDirectory_ + "/" + clipName + ".wav";
+    if (isJobClip(clipName)) {
+        return false;
+    }
+    QString filepath = getClipPath(clipName);
     QFile file(filepath);
-    return file.remove();
+    bool ok = file.remove();
+    if (ok) {
+        QFile::remove(getPeaksPath(clipName));
+    }
+    index_->refreshFile(QFileInfo(filepath).fileName());
+    return ok;
 }
 
 QString ClipManager::generateClipName()
@@ -105,21 +129,186 @@ QString ClipManager::generateClipName()
     QDateTime now = QDateTime::currentDateTime();
     QString baseName = "Clip_" + now.toString("yyyyMMdd_HHmmss");
     
-    QString filepath = clipsDirectory_ + "/" + baseName + ".wav";
     int counter = 1;
     
-    while (QFile::exists(filepath)) {
+    while (QFile::exists(clipsDirectory_ + "/" + baseName + ".wav")
+           || QFile::exists(clipsDirectory_ + "/" + baseName + ".flac")) {
         baseName = "Clip_" + now.toString("yyyyMMdd_HHmmss") + "_" + QString::number(counter);
-        filepath = clipsDirectory_ + "/" + baseName + ".wav";
         counter++;
     }
     
     return baseName;
 }
 
+bool ClipManager::startConvertToFlac(const QString& clipName)
+{
+    QString wavPath = clipsDirectory_ + "/" + clipName + ".wav";
+    QString flacPath = clipsDirectory_ + "/" + clipName + ".flac";
+    if (busy_.load() || !QFile::exists(wavPath)) {
+        return false;
+    }
+    if (jobThread_.joinable()) {
+        jobThread_.join();
+    }
+    
+    jobClip_ = clipName;
+    jobFiles_ = QStringList() << clipName + ".wav" << clipName + ".flac";
+    QString peaksPath = getPeaksPath(clipName);
+    busy_.store(true);
+    jobThread_ = std::thread([this, wavPath, flacPath, peaksPath]() {
+        // Frames are encoded in parallel; the WAV is only removed once the FLAC is complete
+        int threads = static_cast<int>(std::thread::hardware_concurrency());
+        bool ok = FlacEncoder::encodeWavFile(wavPath.toStdString(), flacPath.toStdString(), threads);
+        if (ok) {
+            // Same audio, so the waveform sidecar only needs the new file's stamp
+            QFileInfo flacInfo(flacPath);
+            PeakFile::restamp(peaksPath.toStdString(), static_cast<uint64_t>(flacInfo.size()),
+                              flacInfo.lastModified().toMSecsSinceEpoch());
+            ok = QFile::remove(wavPath);
+        }
+        jobOk_.store(ok);
+        busy_.store(false);
+    });
+    return true;
+}
+
+bool ClipManager::finishJob()
+{
+    if (jobThread_.joinable()) {
+        jobThread_.join();
+    }
+    for (const QString& file : jobFiles_) {
+        index_->refreshFile(file);
+    }
+    jobFiles_.clear();
+    jobClip_.clear();
+    return jobOk_.load();
+}
+
+bool ClipManager::startExport(const QString& clipName, const QString& destPath, SampleFormat format,
+                              bool normalize, double targetLufs)
+{
+    QString sourcePath = getClipPath(clipName);
+    if (busy_.load() || !QFile::exists(sourcePath)) {
+        return false;
+    }
+    if (jobThread_.joinable()) {
+        jobThread_.join();
+    }
+    
+    // A current index entry saves the analysis pass; a stale or pending one
+    // is measured on the worker instead
+    bool measured = false;
+    double loudness = 0.0;
+    float truePeak = 0.0f;
+    if (normalize) {
+        ClipInfo info;
+        index_->refreshFile(QFileInfo(sourcePath).fileName());
+        if (index_->clipInfo(clipName, info) && info.peak >= 0.0f) {
+            measured = true;
+            loudness = info.loudness;
+            truePeak = info.truePeak;
+        }
+    }
+    
+    jobClip_ = clipName;
+    jobFiles_.clear();
+    jobGainDb_.store(0.0);
+    busy_.store(true);
+    jobThread_ = std::thread([this, sourcePath, destPath, format, normalize, targetLufs,
+                              measured, loudness, truePeak]() mutable {
+        bool ok = true;
+        double gainDb = 0.0;
+        if (normalize) {
+            if (!measured) {
+                ok = measureLoudness(sourcePath, loudness, truePeak);
+            }
+            ok = ok && std::isfinite(loudness);
+            if (ok) {
+                gainDb = targetLufs - loudness;
+                if (truePeak > 0.0f) {
+                    gainDb = std::min(gainDb, EXPORT_TRUE_PEAK_LIMIT_DB - 20.0 * std::log10(truePeak));
+                }
+            }
+        }
+        ok = ok && writeCopy(sourcePath, destPath, format, gainDb);
+        jobGainDb_.store(gainDb);
+        jobOk_.store(ok);
+        busy_.store(false);
+    });
+    return true;
+}
+
+bool ClipManager::measureLoudness(const QString& path, double& loudness, float& truePeak)
+{
+    AudioFileReader reader;
+    if (!reader.open(path.toStdString())) {
+        return false;
+    }
+    
+    const int numChannels = reader.getNumChannels();
+    std::vector<std::vector<float>> buffers(numChannels, std::vector<float>(EXPORT_BLOCK_FRAMES));
+    std::vector<float*> channels(numChannels);
+    for (int ch = 0; ch < numChannels; ++ch) {
+        channels[ch] = buffers[ch].data();
+    }
+    LoudnessMeter meter;
+    meter.reset(reader.getSampleRate(), numChannels);
+    for (uint64_t pos = 0; pos < reader.getNumFrames(); pos += EXPORT_BLOCK_FRAMES) {
+        int frames = reader.read(pos, channels.data(), numChannels, EXPORT_BLOCK_FRAMES);
+        if (frames <= 0) break;
+        meter.process(channels.data(), frames);
+    }
+    loudness = meter.getIntegratedLoudness();
+    truePeak = meter.getTruePeak();
+    return true;
+}
+
+bool ClipManager::writeCopy(const QString& sourcePath, const QString& destPath, SampleFormat format, double gainDb)
+{
+    AudioFileReader reader;
+    if (!reader.open(sourcePath.toStdString())) {
+        return false;
+    }
+    const float gain = static_cast<float>(std::pow(10.0, gainDb / 20.0));
+    
+    const int numChannels = reader.getNumChannels();
+    const bool flac = QFileInfo(destPath).suffix().compare("flac", Qt::CaseInsensitive) == 0;
+    WavWriter wavWriter;
+    FlacEncoder flacEncoder;
+    bool ok;
+    if (flac) {
+        flacEncoder.setFormat(format);
+        flacEncoder.setGain(gain);
+        flacEncoder.setNumThreads(static_cast<int>(std::thread::hardware_concurrency()));
+        ok = flacEncoder.open(destPath.toStdString(), reader.getSampleRate(), numChannels);
+    } else {
+        wavWriter.setFormat(format);
+        wavWriter.setGain(gain);
+        ok = wavWriter.open(destPath.toStdString(), reader.getSampleRate(), numChannels);
+    }
+    
+    std::vector<std::vector<float>> buffers(numChannels, std::vector<float>(EXPORT_BLOCK_FRAMES));
+    std::vector<float*> channels(numChannels);
+    for (int ch = 0; ch < numChannels; ++ch) {
+        channels[ch] = buffers[ch].data();
+    }
+    for (uint64_t pos = 0; ok && pos < reader.getNumFrames(); pos += EXPORT_BLOCK_FRAMES) {
+        int frames = reader.read(pos, channels.data(), numChannels, EXPORT_BLOCK_FRAMES);
+        if (frames <= 0) break;
+        ok = flac ? flacEncoder.write(channels.data(), frames) : wavWriter.write(channels.data(), frames);
+    }
+    ok = (flac ? flacEncoder.close() : wavWriter.close()) && ok;
+    
+    if (!ok) {
+        QFile::remove(destPath);
+    }
+    return ok;
+}
+
 void ClipManager::revealInExplorer(const QString& clipName)
 {
-    QString filepath = clipsDirectory_ + "/" + clipName + ".wav";
+    QString filepath = getClipPath(clipName);
     
 #ifdef Q_OS_WIN
     QProcess::startDetached("explorer", QStringList() << "/select," << QDir::toNativeSeparators(filepath));
@@ -5,6 +5,12 @@
 #include <QStringList>
 #include <QDateTime>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include "PcmConverter.h"
+
+class ClipIndex;
 
 struct ClipInfo {
     QString name;
@@ -12,28 +18,72 @@ struct ClipInfo {
     QDateTime timestamp;
     float duration;
     qint64 fileSize;
+    int sampleRate{0};
+    int numChannels{0};
+    float peak{-1.0f};      // linear sample peak, negative until analysed
+    float truePeak{-1.0f};  // linear, 4x oversampled
+    double loudness{0.0};   // integrated LUFS, valid when peak >= 0
+    double loudnessRange{0.0}; // LU
 };
 
 class ClipManager {
 public:
     ClipManager();
+    ~ClipManager();
     
     void setClipsDirectory(const QString& directory);
     QString getClipsDirectory() const { return clipsDirectory_; }
     
-    // Clip management
+    // Clip management. Clips are .wav or .flac files named after the clip.
+    // The list and metadata come from the directory's clip index.
     QStringList getClipList();
+    QString getClipPath(const QString& clipName) const;
+    QString getPeaksPath(const QString& clipName) const;
     ClipInfo getClipInfo(const QString& clipName);
     bool renameClip(const QString& oldName, const QString& newName);
     bool deleteClip(const QString& clipName);
     QString generateClipName();
     
+    // Background jobs run one at a time on a worker thread. Poll isBusy(),
+    // then call finishJob() on the UI thread: it refreshes the index entries
+    // the job touched and returns whether the job succeeded. The clip a job
+    // works on can't be renamed or deleted until it is done.
+    bool startConvertToFlac(const QString& clipName);
+    bool isBusy() const { return busy_.load(); }
+    bool finishJob();
+    
+    // Writes a copy of a WAV or FLAC clip as WAV or FLAC (by the extension of
+    // destPath) as a background job. With normalisation the gain brings the
+    // clip's loudness to targetLufs, limited so the true peak stays at or
+    // below -1 dBTP; the index's measurement is used when it is current,
+    // otherwise the job measures the clip before writing. The gain is applied
+    // while the samples are converted and read back with getJobGainDb().
+    bool startExport(const QString& clipName, const QString& destPath, SampleFormat format,
+                     bool normalize, double targetLufs);
+    double getJobGainDb() const { return jobGainDb_.load(); }
+    
+    static constexpr double EXPORT_TRUE_PEAK_LIMIT_DB = -1.0;
+    
     // File operations
     void revealInExplorer(const QString& clipName);
     
+    // Emits clipsChanged() when files are added, removed or re-analysed
+    ClipIndex* getIndex() { return index_.get(); }
+    
 private:
     QString clipsDirectory_;
+    std::unique_ptr<ClipIndex> index_;
     void ensureDirectoryExists();
+    bool isJobClip(const QString& clipName) const { return busy_.load() && clipName == jobClip_; }
+    static bool measureLoudness(const QString& path, double& loudness, float& truePeak);
+    static bool writeCopy(const QString& sourcePath, const QString& destPath, SampleFormat format, double gainDb);
+    
+    std::thread jobThread_;
+    std::atomic<bool> busy_{false};
+    std::atomic<bool> jobOk_{true};
+    std::atomic<double> jobGainDb_{0.0};
+    QString jobClip_;
+    QStringList jobFiles_; // index entries to refresh once the job is done
 };
 
 #endif // CLIPMANAGER_H
\ No newline at end of file
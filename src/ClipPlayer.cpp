@@ -0,0 +1,215 @@
+#include "ClipPlayer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+ClipPlayer::ClipPlayer()
+    : left_(RENDER_BLOCK), right_(RENDER_BLOCK), decodedLeft_(RENDER_BLOCK), decodedRight_(RENDER_BLOCK)
+{
+    prefetchThread_ = std::thread(&ClipPlayer::prefetchLoop, this);
+}
+
+ClipPlayer::~ClipPlayer()
+{
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex_);
+        stopPrefetch_ = true;
+    }
+    prefetchCV_.notify_one();
+    if (prefetchThread_.joinable()) {
+        prefetchThread_.join();
+    }
+    unload();
+}
+
+bool ClipPlayer::load(const std::string& path, int engineSampleRate)
+{
+    auto reader = std::make_shared<AudioFileReader>();
+    if (!reader->open(path) || reader->getSampleRate() <= 0 || engineSampleRate <= 0) {
+        return false;
+    }
+
+    unload();
+    path_ = path;
+    numFrames_ = reader->getNumFrames();
+    sampleRate_ = reader->getSampleRate();
+
+    // Never more than one decode block beyond what a render needs is pending
+    resampling_ = sampleRate_ != engineSampleRate;
+    resampler_.reset(2, sampleRate_, engineSampleRate);
+    resampler_.reserve(RENDER_BLOCK * (static_cast<int>(std::ceil(resampler_.getRatio())) + 2));
+    flushed_ = false;
+    position_.store(0);
+    seekTarget_.store(0);
+
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex_);
+        prefetchReader_ = reader;
+        prefetchedFrom_ = 0;
+        prefetchedTo_ = 0;
+    }
+    prefetchCV_.notify_one();
+
+    readerHold_ = std::move(reader);
+    reader_.store(readerHold_.get());
+    return true;
+}
+
+void ClipPlayer::unload()
+{
+    playing_.store(false);
+    reader_.store(nullptr);
+
+    // A callback that loaded the old reader may still be decoding from it
+    while (processing_.load()) {
+        std::this_thread::yield();
+    }
+    readerHold_.reset();
+
+    std::lock_guard<std::mutex> lock(prefetchMutex_);
+    prefetchReader_.reset();
+    path_.clear();
+    numFrames_ = 0;
+    position_.store(0);
+}
+
+void ClipPlayer::play()
+{
+    if (!isLoaded()) return;
+    if (position_.load() >= numFrames_) {
+        seek(0);
+    }
+    playing_.store(true);
+}
+
+void ClipPlayer::pause()
+{
+    playing_.store(false);
+}
+
+void ClipPlayer::stop()
+{
+    playing_.store(false);
+    seek(0);
+}
+
+void ClipPlayer::seek(uint64_t frame)
+{
+    frame = std::min(frame, numFrames_);
+    seekTarget_.store(static_cast<int64_t>(frame));
+    position_.store(frame);
+    prefetchCV_.notify_one();
+}
+
+int ClipPlayer::render(int numSamples)
+{
+    const AudioFileReader* reader = reader_.load();
+    if (!reader) return 0;
+
+    const int64_t target = seekTarget_.exchange(-1);
+    if (target >= 0) {
+        playPos_ = static_cast<uint64_t>(target);
+        if (resampling_) {
+            resampler_.clear();
+            flushed_ = false;
+        }
+    }
+    if (!playing_.load()) return 0;
+
+    const int wanted = std::min(numSamples, RENDER_BLOCK);
+    float* channels[2] = { left_.data(), right_.data() };
+    int frames;
+    if (resampling_) {
+        frames = renderResampled(*reader, channels, wanted);
+    } else {
+        frames = reader->read(playPos_, channels, 2, wanted);
+        playPos_ += frames;
+    }
+    position_.store(playPos_);
+    if (frames < wanted) {
+        playing_.store(false);
+    }
+    return frames;
+}
+
+int ClipPlayer::renderResampled(const AudioFileReader& reader, float* const* channels, int numFrames)
+{
+    // Decode until the converter can deliver the block; the clip's tail is
+    // flushed through so it isn't cut short
+    float* decoded[2] = { decodedLeft_.data(), decodedRight_.data() };
+    while (resampler_.getAvailable() < numFrames && !flushed_) {
+        const int frames = reader.read(playPos_, decoded, 2, RENDER_BLOCK);
+        if (frames > 0) {
+            resampler_.push(decoded, frames);
+            playPos_ += frames;
+        } else {
+            resampler_.flush();
+            flushed_ = true;
+        }
+    }
+    return resampler_.pull(channels, numFrames);
+}
+
+void ClipPlayer::mixIntoInput(float* input, int numSamples)
+{
+    if (route_.load() != Route::Chain) return;
+
+    processing_.store(true);
+    const float gain = volume_.load() * 0.5f;
+    for (int offset = 0; offset < numSamples; ) {
+        const int frames = render(numSamples - offset);
+        if (frames <= 0) break;
+        for (int i = 0; i < frames; ++i) {
+            input[offset + i] += (left_[i] + right_[i]) * gain;
+        }
+        offset += frames;
+    }
+    processing_.store(false);
+}
+
+void ClipPlayer::mixInto(float* left, float* right, int numSamples)
+{
+    if (route_.load() != Route::Output) return;
+
+    processing_.store(true);
+    const float gain = volume_.load();
+    for (int offset = 0; offset < numSamples; ) {
+        const int frames = render(numSamples - offset);
+        if (frames <= 0) break;
+        for (int i = 0; i < frames; ++i) {
+            left[offset + i] += left_[i] * gain;
+            right[offset + i] += right_[i] * gain;
+        }
+        offset += frames;
+    }
+    processing_.store(false);
+}
+
+void ClipPlayer::prefetchLoop()
+{
+    std::unique_lock<std::mutex> lock(prefetchMutex_);
+    while (!stopPrefetch_) {
+        std::shared_ptr<AudioFileReader> reader = prefetchReader_;
+        if (reader) {
+            // Restart the window when the play head jumped outside it
+            const uint64_t pos = position_.load();
+            if (pos < prefetchedFrom_ || pos > prefetchedTo_) {
+                prefetchedFrom_ = pos;
+                prefetchedTo_ = pos;
+            }
+            const uint64_t target = std::min<uint64_t>(pos + static_cast<uint64_t>(PREFETCH_SECONDS) * reader->getSampleRate(),
+                                                       reader->getNumFrames());
+            if (target > prefetchedTo_) {
+                const uint64_t from = prefetchedTo_;
+                lock.unlock();
+                reader->prefetch(from, target - from);
+                lock.lock();
+                if (prefetchReader_ == reader && prefetchedTo_ == from) {
+                    prefetchedTo_ = target;
+                }
+                continue;
+            }
+        }
+        prefetchCV_.wait_for(lock, std::chrono::milliseconds(PREFETCH_POLL_MS));
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef CLIPPLAYER_H
+#define CLIPPLAYER_H
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <string>
+#include <cstdint>
+#include "AudioFileReader.h"
+#include "Resampler.h"
+
+// Clip playback voice inside the engine. A WAV is memory-mapped and each
+// block is decoded straight from the mapping on the audio thread; a
+// prefetch thread keeps the pages a few seconds ahead of the play head
+// resident, so the callback never waits on the disk. For a FLAC clip the
+// same thread decodes the frames ahead into the reader's cache. A clip at another
+// sample rate is converted to the engine rate as it plays. The clip is either
+// mixed into the output next to live playing or fed into the effects chain
+// in place of a DI.
+class ClipPlayer {
+public:
+    enum class Route {
+        Output,     // mixed with the processed signal
+        Chain       // summed to mono and added to the chain input
+    };
+
+    ClipPlayer();
+    ~ClipPlayer();
+
+    // UI thread
+    bool load(const std::string& path, int engineSampleRate);
+    void unload();
+    bool isLoaded() const { return reader_.load() != nullptr; }
+    const std::string& getPath() const { return path_; }
+
+    void play();
+    void pause();
+    void stop();
+    bool isPlaying() const { return playing_.load(); }
+
+    // Frames and rate are the clip's own, whatever the engine runs at.
+    // Takes effect at the start of the next engine block.
+    void seek(uint64_t frame);
+    uint64_t getPosition() const { return position_.load(); }
+    uint64_t getNumFrames() const { return numFrames_; }
+    int getSampleRate() const { return sampleRate_; }
+
+    void setVolume(float volume) { volume_.store(volume); }
+    void setRoute(Route route) { route_.store(route); }
+    Route getRoute() const { return route_.load(); }
+
+    // Audio thread. Each call only acts when the player is on that route.
+    void mixIntoInput(float* input, int numSamples);
+    void mixInto(float* left, float* right, int numSamples);
+
+private:
+    int render(int numSamples);
+    int renderResampled(const AudioFileReader& reader, float* const* channels, int numFrames);
+    void prefetchLoop();
+
+    std::string path_;
+    uint64_t numFrames_{0};
+    int sampleRate_{0};
+
+    // The UI keeps the reader alive, the audio thread reads through it
+    std::shared_ptr<AudioFileReader> readerHold_;
+    std::atomic<const AudioFileReader*> reader_{nullptr};
+    std::atomic<bool> processing_{false};
+
+    std::atomic<bool> playing_{false};
+    std::atomic<uint64_t> position_{0};
+    std::atomic<int64_t> seekTarget_{-1};
+    std::atomic<float> volume_{1.0f};
+    std::atomic<Route> route_{Route::Output};
+
+    // Audio thread only
+    uint64_t playPos_{0}; // next clip frame to decode
+    std::vector<float> left_;
+    std::vector<float> right_;
+
+    // A clip at another rate is decoded here and converted to the engine
+    // rate. Set up by load() before the audio thread sees the reader.
+    bool resampling_{false};
+    bool flushed_{false};
+    Resampler resampler_;
+    std::vector<float> decodedLeft_;
+    std::vector<float> decodedRight_;
+
+    // Prefetch: pages from the play head up to PREFETCH_SECONDS ahead
+    std::thread prefetchThread_;
+    std::mutex prefetchMutex_;
+    std::condition_variable prefetchCV_;
+    std::shared_ptr<AudioFileReader> prefetchReader_;
+    uint64_t prefetchedFrom_{0};
+    uint64_t prefetchedTo_{0};
+    bool stopPrefetch_{false};
+
+    static const int PREFETCH_SECONDS = 4;
+    static const int PREFETCH_POLL_MS = 50;
+    static const int RENDER_BLOCK = 1024;
+};
+
+#endif // CLIPPLAYER_H
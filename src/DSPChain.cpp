@@ -2,33 +2,764 @@
 #include <algorithm>
 #include <cstring>
 #include <cmath>
+#include <thread>
 
 namespace {
     constexpr float PI = 3.14159265358979323846f;
 }
 
+const char* DSPParams::name(ParamId id)
+{
+    static const char* const names[] = {
+        "gateBypass", "gateThreshold", "gateAttack", "gateRelease",
+        "driveBypass", "driveAmount", "driveType", "preGain",
+        "eqBypass", "lowGain", "lowFreq", "midGain", "midFreq", "midQ", "highGain", "highFreq",
+        "presenceGain", "presenceFreq",
+        "compBypass", "compThreshold", "compRatio", "compAttack", "compRelease",
+        "pitchBypass", "pitchMode",
+        "delayBypass", "delayTime", "delayFeedback", "delayMix", "delayHighCut",
+        "reverbBypass", "reverbSize", "reverbDamping", "reverbMix"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(ParamId::Count),
+                  "parameter name table out of sync with ParamId");
+    return names[static_cast<int>(id)];
+}
+
+bool DSPParams::findByName(const std::string& name, ParamId& id)
+{
+    for (int i = 0; i < count(); ++i) {
+        if (name == DSPParams::name(static_cast<ParamId>(i))) {
+            id = static_cast<ParamId>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+ParamKind DSPParams::kind(ParamId id)
+{
+    switch (id) {
+        case ParamId::GateBypass: case ParamId::DriveBypass: case ParamId::EqBypass:
+        case ParamId::CompBypass: case ParamId::PitchBypass: case ParamId::DelayBypass:
+        case ParamId::ReverbBypass:
+            return ParamKind::Switch;
+        case ParamId::DriveType: case ParamId::PitchMode:
+            return ParamKind::Mode;
+        case ParamId::GateAttack: case ParamId::GateRelease:
+        case ParamId::LowFreq: case ParamId::MidFreq: case ParamId::MidQ: case ParamId::HighFreq:
+        case ParamId::PresenceFreq: case ParamId::CompRatio: case ParamId::CompAttack:
+        case ParamId::CompRelease: case ParamId::DelayTime: case ParamId::DelayHighCut:
+            return ParamKind::Logarithmic;
+        default:
+            return ParamKind::Linear;
+    }
+}
+
+ParamValues DSPParams::morph(const ParamValues& a, const ParamValues& b, float t)
+{
+    ParamValues values;
+    for (int i = 0; i < count(); ++i) {
+        switch (kind(static_cast<ParamId>(i))) {
+            case ParamKind::Switch:
+            case ParamKind::Mode:
+                values[i] = (t < 0.5f) ? a[i] : b[i];
+                break;
+            case ParamKind::Logarithmic:
+                if (a[i] > 0.0f && b[i] > 0.0f) {
+                    values[i] = a[i] * std::pow(b[i] / a[i], t);
+                    break;
+                }
+                values[i] = a[i] + (b[i] - a[i]) * t;
+                break;
+            case ParamKind::Linear:
+                values[i] = a[i] + (b[i] - a[i]) * t;
+                break;
+        }
+    }
+    return values;
+}
+
+float DSPParams::get(ParamId id) const
+{
+    switch (id) {
+        case ParamId::GateBypass: return gateBypass.load() ? 1.0f : 0.0f;
+        case ParamId::GateThreshold: return gateThreshold.load();
+        case ParamId::GateAttack: return gateAttack.load();
+        case ParamId::GateRelease: return gateRelease.load();
+        case ParamId::DriveBypass: return driveBypass.load() ? 1.0f : 0.0f;
+        case ParamId::DriveAmount: return driveAmount.load();
+        case ParamId::DriveType: return static_cast<float>(driveType.load());
+        case ParamId::PreGain: return preGain.load();
+        case ParamId::EqBypass: return eqBypass.load() ? 1.0f : 0.0f;
+        case ParamId::LowGain: return lowGain.load();
+        case ParamId::LowFreq: return lowFreq.load();
+        case ParamId::MidGain: return midGain.load();
+        case ParamId::MidFreq: return midFreq.load();
+        case ParamId::MidQ: return midQ.load();
+        case ParamId::HighGain: return highGain.load();
+        case ParamId::HighFreq: return highFreq.load();
+        case ParamId::PresenceGain: return presenceGain.load();
+        case ParamId::PresenceFreq: return presenceFreq.load();
+        case ParamId::CompBypass: return compBypass.load() ? 1.0f : 0.0f;
+        case ParamId::CompThreshold: return compThreshold.load();
+        case ParamId::CompRatio: return compRatio.load();
+        case ParamId::CompAttack: return compAttack.load();
+        case ParamId::CompRelease: return compRelease.load();
+        case ParamId::PitchBypass: return pitchBypass.load() ? 1.0f : 0.0f;
+        case ParamId::PitchMode: return static_cast<float>(pitchMode.load());
+        case ParamId::DelayBypass: return delayBypass.load() ? 1.0f : 0.0f;
+        case ParamId::DelayTime: return delayTime.load();
+        case ParamId::DelayFeedback: return delayFeedback.load();
+        case ParamId::DelayMix: return delayMix.load();
+        case ParamId::DelayHighCut: return delayHighCut.load();
+        case ParamId::ReverbBypass: return reverbBypass.load() ? 1.0f : 0.0f;
+        case ParamId::ReverbSize: return reverbSize.load();
+        case ParamId::ReverbDamping: return reverbDamping.load();
+        case ParamId::ReverbMix: return reverbMix.load();
+        case ParamId::Count: break;
+    }
+    return 0.0f;
+}
+
+void DSPParams::set(ParamId id, float value)
+{
+    const bool on = value >= 0.5f;
+    const int whole = static_cast<int>(std::lround(value));
+    switch (id) {
+        case ParamId::GateBypass: gateBypass.store(on); break;
+        case ParamId::GateThreshold: gateThreshold.store(value); break;
+        case ParamId::GateAttack: gateAttack.store(value); break;
+        case ParamId::GateRelease: gateRelease.store(value); break;
+        case ParamId::DriveBypass: driveBypass.store(on); break;
+        case ParamId::DriveAmount: driveAmount.store(value); break;
+        case ParamId::DriveType: driveType.store(whole); break;
+        case ParamId::PreGain: preGain.store(value); break;
+        case ParamId::EqBypass: eqBypass.store(on); break;
+        case ParamId::LowGain: lowGain.store(value); break;
+        case ParamId::LowFreq: lowFreq.store(value); break;
+        case ParamId::MidGain: midGain.store(value); break;
+        case ParamId::MidFreq: midFreq.store(value); break;
+        case ParamId::MidQ: midQ.store(value); break;
+        case ParamId::HighGain: highGain.store(value); break;
+        case ParamId::HighFreq: highFreq.store(value); break;
+        case ParamId::PresenceGain: presenceGain.store(value); break;
+        case ParamId::PresenceFreq: presenceFreq.store(value); break;
+        case ParamId::CompBypass: compBypass.store(on); break;
+        case ParamId::CompThreshold: compThreshold.store(value); break;
+        case ParamId::CompRatio: compRatio.store(value); break;
+        case ParamId::CompAttack: compAttack.store(value); break;
+        case ParamId::CompRelease: compRelease.store(value); break;
+        case ParamId::PitchBypass: pitchBypass.store(on); break;
+        case ParamId::PitchMode: pitchMode.store(whole); break;
+        case ParamId::DelayBypass: delayBypass.store(on); break;
+        case ParamId::DelayTime: delayTime.store(value); break;
+        case ParamId::DelayFeedback: delayFeedback.store(value); break;
+        case ParamId::DelayMix: delayMix.store(value); break;
+        case ParamId::DelayHighCut: delayHighCut.store(value); break;
+        case ParamId::ReverbBypass: reverbBypass.store(on); break;
+        case ParamId::ReverbSize: reverbSize.store(value); break;
+        case ParamId::ReverbDamping: reverbDamping.store(value); break;
+        case ParamId::ReverbMix: reverbMix.store(value); break;
+        case ParamId::Count: break;
+    }
+}
+
+void DSPParams::copyFrom(const DSPParams& other)
+{
+    apply(other.snapshot());
+}
+
+ParamValues DSPParams::snapshot() const
+{
+    ParamValues values;
+    for (int i = 0; i < count(); ++i) {
+        values[i] = get(static_cast<ParamId>(i));
+    }
+    return values;
+}
+
+void DSPParams::apply(const ParamValues& values)
+{
+    for (int i = 0; i < count(); ++i) {
+        set(static_cast<ParamId>(i), values[i]);
+    }
+}
+
+namespace {
+    SvfCoeffs<float> coeffStep(const SvfCoeffs<float>& from, const SvfCoeffs<float>& to, int steps)
+    {
+        const float scale = 1.0f / steps;
+        SvfCoeffs<float> step;
+        step.a1 = (to.a1 - from.a1) * scale;
+        step.a2 = (to.a2 - from.a2) * scale;
+        step.a3 = (to.a3 - from.a3) * scale;
+        step.m0 = (to.m0 - from.m0) * scale;
+        step.m1 = (to.m1 - from.m1) * scale;
+        step.m2 = (to.m2 - from.m2) * scale;
+        return step;
+    }
+
+    void addStep(SvfCoeffs<float>& c, const SvfCoeffs<float>& step)
+    {
+        c.a1 += step.a1;
+        c.a2 += step.a2;
+        c.a3 += step.a3;
+        c.m0 += step.m0;
+        c.m1 += step.m1;
+        c.m2 += step.m2;
+    }
+
+    float envelopeCoeff(float seconds, int sampleRate)
+    {
+        return 1.0f - std::exp(-1.0f / (seconds * sampleRate));
+    }
+}
+
+void ChainSettings::compile(const ParamValues& params, int rate)
+{
+    auto value = [&params](ParamId id) { return params[static_cast<size_t>(id)]; };
+    auto wet = [&value](ParamId bypass) { return 1.0f - std::max(0.0f, std::min(1.0f, value(bypass))); };
+
+    values = params;
+    sampleRate = rate;
+
+    gateWet = wet(ParamId::GateBypass);
+    gateOn = gateWet > 0.0f;
+    gateThreshold = std::pow(10.0f, value(ParamId::GateThreshold) / 20.0f);
+    gateAttack = envelopeCoeff(value(ParamId::GateAttack), rate);
+    gateRelease = envelopeCoeff(value(ParamId::GateRelease), rate);
+
+    // Pre-gain (1..8x) ahead of the drive amount, then make-up compensation
+    const float amount = value(ParamId::DriveAmount);
+    driveWet = wet(ParamId::DriveBypass);
+    driveOn = driveWet > 0.0f;
+    driveType = static_cast<int>(std::lround(value(ParamId::DriveType)));
+    driveTypeB = driveType;
+    driveMorph = 0.0f;
+    driveGain = (1.0f + value(ParamId::PreGain) * 7.0f) * (1.0f + amount * 20.0f);
+    driveMakeup = 1.0f / (1.0f + amount * 0.5f);
+
+    eqWet = wet(ParamId::EqBypass);
+    eqOn = eqWet > 0.0f;
+    eq[0] = SvfCoeffs<float>::lowShelf(value(ParamId::LowFreq), 0.707f, value(ParamId::LowGain), rate);
+    eq[1] = SvfCoeffs<float>::peak(value(ParamId::MidFreq), value(ParamId::MidQ), value(ParamId::MidGain), rate);
+    eq[2] = SvfCoeffs<float>::highShelf(value(ParamId::HighFreq), 0.707f, value(ParamId::HighGain), rate);
+    // Presence additional high shelf (independent gain)
+    eq[3] = SvfCoeffs<float>::highShelf(value(ParamId::PresenceFreq), 0.707f, value(ParamId::PresenceGain), rate);
+
+    compWet = wet(ParamId::CompBypass);
+    compOn = compWet > 0.0f;
+    compThreshold = std::pow(10.0f, value(ParamId::CompThreshold) / 20.0f);
+    compExponent = 1.0f / value(ParamId::CompRatio) - 1.0f;
+    compAttack = envelopeCoeff(value(ParamId::CompAttack), rate);
+    compRelease = envelopeCoeff(value(ParamId::CompRelease), rate);
+
+    const int mode = static_cast<int>(std::lround(value(ParamId::PitchMode)));
+    pitchWet = wet(ParamId::PitchBypass);
+    pitchOn = pitchWet > 0.0f && mode != 0;
+    pitchSemitones = (mode == 1) ? -1.0f : 1.0f;
+
+    // The delay lines hold 2 seconds
+    delayWet = wet(ParamId::DelayBypass);
+    delayOn = delayWet > 0.0f;
+    delaySamples = static_cast<int>(value(ParamId::DelayTime) * rate);
+    delaySamples = std::max(1, std::min(delaySamples, rate * 2 - 1));
+    delayFeedback = value(ParamId::DelayFeedback);
+    delayMix = value(ParamId::DelayMix);
+    delayHighCut = SvfCoeffs<float>::lowPass(value(ParamId::DelayHighCut), 0.707f, rate);
+
+    reverbWet = wet(ParamId::ReverbBypass);
+    reverbOn = reverbWet > 0.0f;
+    reverbDamping = value(ParamId::ReverbDamping);
+    reverbMix = value(ParamId::ReverbMix);
+}
+
+void ChainSettings::compileMorph(const ParamValues& a, const ParamValues& b, float t, int rate)
+{
+    compile(DSPParams::morph(a, b, t), rate);
+
+    auto onIn = [](const ParamValues& set, ParamId bypass) { return set[static_cast<size_t>(bypass)] < 0.5f; };
+    auto wet = [&](ParamId bypass) {
+        return (onIn(a, bypass) ? 1.0f - t : 0.0f) + (onIn(b, bypass) ? t : 0.0f);
+    };
+
+    gateWet = wet(ParamId::GateBypass);
+    eqWet = wet(ParamId::EqBypass);
+    compWet = wet(ParamId::CompBypass);
+    delayWet = wet(ParamId::DelayBypass);
+    reverbWet = wet(ParamId::ReverbBypass);
+    gateOn = gateWet > 0.0f;
+    eqOn = eqWet > 0.0f;
+    compOn = compWet > 0.0f;
+    delayOn = delayWet > 0.0f;
+    reverbOn = reverbWet > 0.0f;
+
+    // Curves of both ends mixed when both drive with different types
+    const bool driveA = onIn(a, ParamId::DriveBypass);
+    const bool driveB = onIn(b, ParamId::DriveBypass);
+    const int typeA = static_cast<int>(std::lround(a[static_cast<size_t>(ParamId::DriveType)]));
+    const int typeB = static_cast<int>(std::lround(b[static_cast<size_t>(ParamId::DriveType)]));
+    driveWet = wet(ParamId::DriveBypass);
+    driveOn = driveWet > 0.0f;
+    driveType = driveA ? typeA : typeB;
+    driveTypeB = driveB ? typeB : typeA;
+    driveMorph = (driveA && driveB) ? t : 0.0f;
+
+    // Opposite pitch modes pass through dry in the middle, so the shift
+    // direction only changes while the stage is silent
+    const int modeA = static_cast<int>(std::lround(a[static_cast<size_t>(ParamId::PitchMode)]));
+    const int modeB = static_cast<int>(std::lround(b[static_cast<size_t>(ParamId::PitchMode)]));
+    const bool pitchA = onIn(a, ParamId::PitchBypass) && modeA != 0;
+    const bool pitchB = onIn(b, ParamId::PitchBypass) && modeB != 0;
+    if (pitchA && pitchB && modeA != modeB) {
+        pitchWet = std::abs(1.0f - 2.0f * t);
+        pitchSemitones = ((t < 0.5f ? modeA : modeB) == 1) ? -1.0f : 1.0f;
+    } else {
+        pitchWet = (pitchA ? 1.0f - t : 0.0f) + (pitchB ? t : 0.0f);
+        pitchSemitones = ((pitchA ? modeA : modeB) == 1) ? -1.0f : 1.0f;
+    }
+    pitchOn = pitchWet > 0.0f;
+}
+
+bool ChainSettings::isOn(EffectId id) const
+{
+    switch (id) {
+        case EffectId::Gate: return gateOn;
+        case EffectId::Drive: return driveOn;
+        case EffectId::EQ: return eqOn;
+        case EffectId::Compressor: return compOn;
+        case EffectId::Pitch: return pitchOn;
+        case EffectId::Delay: return delayOn;
+        case EffectId::Reverb: return reverbOn;
+        default: return false;
+    }
+}
+
+float ChainSettings::wetLevel(EffectId id) const
+{
+    switch (id) {
+        case EffectId::Gate: return gateWet;
+        case EffectId::Drive: return driveWet;
+        case EffectId::EQ: return eqWet;
+        case EffectId::Compressor: return compWet;
+        case EffectId::Pitch: return pitchWet;
+        case EffectId::Delay: return delayWet;
+        case EffectId::Reverb: return reverbWet;
+        default: return 0.0f;
+    }
+}
+
+ParamEventQueue::ParamEventQueue()
+    : events_(CAPACITY)
+{
+}
+
+bool ParamEventQueue::push(const ParamEvent& event)
+{
+    const size_t write = writePos_.value.load(std::memory_order_relaxed);
+    const size_t read = readPos_.value.load(std::memory_order_acquire);
+    if (write - read == static_cast<size_t>(CAPACITY)) {
+        return false;
+    }
+    events_[write % CAPACITY] = event;
+    writePos_.value.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+bool ParamEventQueue::peek(ParamEvent& event) const
+{
+    const size_t read = readPos_.value.load(std::memory_order_relaxed);
+    const size_t write = writePos_.value.load(std::memory_order_acquire);
+    if (read == write) {
+        return false;
+    }
+    event = events_[read % CAPACITY];
+    return true;
+}
+
+void ParamEventQueue::pop()
+{
+    const size_t read = readPos_.value.load(std::memory_order_relaxed);
+    readPos_.value.store(read + 1, std::memory_order_release);
+}
+
+void ParamEventQueue::clear()
+{
+    readPos_.value.store(writePos_.value.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void DSPChain::Voice::clear()
+{
+    gateEnvelope = 0.0f;
+    compEnvelope = 0.0f;
+    for (SvfFilter<float, 2>& band : eqBands) {
+        band.reset();
+    }
+    eqRamp = 0;
+    eqPrimed = false;
+    pitchShifter->reset();
+
+    delayWritePos = 0;
+    delayWritten = 0;
+    delayFilter.reset();
+
+    for (int i = 0; i < NUM_COMBS; ++i) {
+        combPositions[i] = 0;
+    }
+    reverbWritten = 0;
+}
+
 DSPChain::DSPChain()
+    : graph_(EffectGraph::standard())
 {
-    pitchShifter_ = std::make_unique<PitchShifter>();
-    
     // Initialize comb filter lengths (prime numbers for better diffusion)
     const int combLengths[NUM_COMBS] = {1557, 1617, 1491, 1422, 1277, 1356, 1188, 1116};
     for (int i = 0; i < NUM_COMBS; ++i) {
-        combBuffersL_[i].resize(combLengths[i], 0.0f);
-        combBuffersR_[i].resize(combLengths[i], 0.0f);
         combFeedback_[i] = 0.84f + (i * 0.01f);
     }
+    for (Voice& voice : voices_) {
+        voice.pitchShifter = std::make_unique<PitchShifter>();
+        for (int i = 0; i < NUM_COMBS; ++i) {
+            voice.combBuffersL[i].resize(combLengths[i], 0.0f);
+            voice.combBuffersR[i].resize(combLengths[i], 0.0f);
+        }
+        voice.settings.compile(params_.snapshot(), sampleRate_);
+        compilePlan(graph_, voice.plan);
+    }
 }
 
 void DSPChain::setSampleRate(int sampleRate)
 {
     sampleRate_ = sampleRate;
-    pitchShifter_->setSampleRate(sampleRate);
-    
-    // Resize delay buffers (max 2 seconds)
-    delayBufferL_.resize(sampleRate * 2, 0.0f);
-    delayBufferR_.resize(sampleRate * 2, 0.0f);
-    delayWritePos_ = 0;
+    const ParamValues values = params_.snapshot();
+    for (Voice& voice : voices_) {
+        voice.pitchShifter->setSampleRate(sampleRate);
+        
+        // Resize delay buffers (max 2 seconds)
+        voice.delayBufferL.resize(sampleRate * 2, 0.0f);
+        voice.delayBufferR.resize(sampleRate * 2, 0.0f);
+        voice.delayWritePos = 0;
+        voice.delayWritten = 0;
+        voice.settings.compile(values, sampleRate);
+    }
+    snapParams_ = true;
+}
+
+void DSPChain::reset()
+{
+    for (Voice& voice : voices_) {
+        voice.clear();
+    }
+    fadeRemaining_ = 0;
+
+    events_.clear();
+    samplePosition_ = 0;
+    lastTick_ = -1;
+    renderedPosition_.store(0);
+    snapParams_ = true;
+}
+
+bool DSPChain::scheduleParam(ParamId id, float value, int64_t samplePosition)
+{
+    if (id == ParamId::Count) return false;
+    ParamEvent event;
+    event.time = samplePosition;
+    event.id = id;
+    event.value = value;
+    return events_.push(event);
+}
+
+void DSPChain::loadPreset(const ParamValues& values)
+{
+    auto settings = std::make_shared<ChainSettings>();
+    settings->compile(values, sampleRate_);
+    loadPreset(std::move(settings));
+}
+
+void DSPChain::loadPreset(std::shared_ptr<const ChainSettings> settings)
+{
+    if (settings->sampleRate != sampleRate_) {
+        auto compiled = std::make_shared<ChainSettings>();
+        compiled->compile(settings->values, sampleRate_);
+        settings = std::move(compiled);
+    }
+    const ParamValues& values = settings->values;
+
+    writeSequence_.fetch_add(1);
+    params_.apply(values);
+    published_.store(settings.get());
+    morphPublished_.store(nullptr);
+    writeSequence_.fetch_add(1);
+
+    // The blocks replaced here may still be being copied
+    while (adopting_.load()) {
+        std::this_thread::yield();
+    }
+    publishedHold_ = std::move(settings);
+    morphHold_.reset();
+}
+
+bool DSPChain::setEffectGraph(const EffectGraph& graph)
+{
+    auto plan = std::make_shared<ExecutionPlan>();
+    if (!compilePlan(graph, *plan)) return false;
+
+    planPublished_.store(plan.get());
+    while (adopting_.load()) {
+        std::this_thread::yield();
+    }
+    planHold_ = std::move(plan);
+    graph_ = graph;
+    return true;
+}
+
+void DSPChain::startMorph(const ParamValues& a, const ParamValues& b)
+{
+    auto sets = std::make_shared<MorphSets>();
+    sets->a = a;
+    sets->b = b;
+
+    morphPublished_.store(sets.get());
+    published_.store(nullptr);
+    while (adopting_.load()) {
+        std::this_thread::yield();
+    }
+    morphHold_ = std::move(sets);
+    publishedHold_.reset();
+}
+
+void DSPChain::stopMorph()
+{
+    if (!morphHold_) return;
+    loadPreset(DSPParams::morph(morphHold_->a, morphHold_->b, morphTarget_.load()));
+}
+
+DSPChain::Voice& DSPChain::beginFade()
+{
+    // A switch during a fade retargets the voice fading in; otherwise the
+    // idle voice starts from silence and fades in over the active one, in
+    // the same effect order
+    Voice& incoming = voices_[1 - activeVoice_];
+    if (fadeRemaining_ == 0) {
+        incoming.clear();
+        incoming.plan = voices_[activeVoice_].plan;
+        fadeRemaining_ = std::max(1, sampleRate_ * CROSSFADE_MS / 1000);
+        const double step = (PI / 2.0) / fadeRemaining_;
+        fadeCos_ = 1.0;
+        fadeSin_ = 0.0;
+        fadeStepCos_ = std::cos(step);
+        fadeStepSin_ = std::sin(step);
+    }
+    return incoming;
+}
+
+void DSPChain::adoptPublished()
+{
+    adopting_.store(true);
+    const MorphSets* sets = morphPublished_.exchange(nullptr);
+    if (sets) {
+        morphA_ = sets->a;
+        morphB_ = sets->b;
+    }
+    const ChainSettings* next = published_.exchange(nullptr);
+    if (next) {
+        beginFade().settings = *next;
+    }
+
+    // A new effect order fades in on the current settings, unless nothing
+    // has been rendered yet to fade from
+    const ExecutionPlan* plan = planPublished_.exchange(nullptr);
+    if (plan && samplePosition_ == 0) {
+        for (Voice& voice : voices_) {
+            voice.plan = *plan;
+        }
+    } else if (plan) {
+        const Voice& current = targetVoice();
+        Voice& incoming = beginFade();
+        if (&incoming != &current) {
+            incoming.settings = current.settings;
+        }
+        incoming.plan = *plan;
+    }
+    adopting_.store(false);
+
+    // A preset lands whole: nothing glides towards the previous values
+    if (next) {
+        const ParamValues& values = voices_[1 - activeVoice_].settings.values;
+        knobValues_ = values;
+        resetSmoothing(values);
+        snapParams_ = false;
+    }
+
+    // A preset published after the morph ends it
+    if (sets && !next) {
+        morphing_ = true;
+        morphPosition_ = std::max(0.0f, std::min(1.0f, morphTarget_.load()));
+        beginFade().settings.compileMorph(morphA_, morphB_, morphPosition_, sampleRate_);
+    } else if (next) {
+        morphing_ = false;
+    }
+
+    // Compiled for another rate before the engine restarted
+    if (next && voices_[1 - activeVoice_].settings.sampleRate != sampleRate_) {
+        ChainSettings& settings = voices_[1 - activeVoice_].settings;
+        settings.compile(settings.values, sampleRate_);
+    }
+}
+
+bool DSPChain::glideMorph()
+{
+    // One-pole glide towards the slider, one step per control tick
+    const float target = std::max(0.0f, std::min(1.0f, morphTarget_.load()));
+    if (target == morphPosition_) return false;
+
+    const float coeff = 1.0f - std::exp(-1000.0f * CONTROL_INTERVAL / (MORPH_GLIDE_MS * static_cast<float>(sampleRate_)));
+    morphPosition_ += (target - morphPosition_) * coeff;
+    if (std::abs(target - morphPosition_) < 1e-4f) {
+        morphPosition_ = target;
+    }
+    targetVoice().settings.compileMorph(morphA_, morphB_, morphPosition_, sampleRate_);
+    return true;
+}
+
+void DSPChain::syncParams()
+{
+    // Seqlock read: skipped while a preset is being written, retried next block if torn
+    const uint32_t sequence = writeSequence_.load();
+    if (sequence & 1u) return;
+    const ParamValues values = params_.snapshot();
+    if (writeSequence_.load() != sequence) return;
+    if (morphing_) return;
+
+    // A preset written after adoptPublished() ran arrives next block as a
+    // crossfade; its values must not glide the current sound meanwhile
+    if (published_.load() != nullptr) return;
+
+    // First block after a reset or rate change: the values apply as they are
+    if (snapParams_) {
+        snapParams_ = false;
+        knobValues_ = values;
+        resetSmoothing(values);
+        targetVoice().settings.compile(values, sampleRate_);
+        return;
+    }
+
+    // Knob moves glide from where the sound is now, starting at this block
+    // (the UI thread has no sample clock); during a fade they go to the
+    // sound fading in
+    bool changed = false;
+    for (int i = 0; i < DSPParams::count(); ++i) {
+        if (values[i] != knobValues_[i]) {
+            setTarget(i, values[i]);
+            changed = true;
+        }
+    }
+    knobValues_ = values;
+    if (changed) {
+        controlTick();
+    }
+}
+
+void DSPChain::applyEvents()
+{
+    ParamEvent event;
+    bool changed = false;
+    while (events_.peek(event) && event.time <= samplePosition_) {
+        events_.pop();
+        setTarget(static_cast<int>(event.id), event.value);
+        changed = true;
+    }
+
+    // The glide starts on the event's own sample
+    if (changed) {
+        controlTick();
+    }
+}
+
+void DSPChain::setTarget(int index, float value)
+{
+    const ParamKind kind = DSPParams::kind(static_cast<ParamId>(index));
+    if (kind == ParamKind::Switch) {
+        value = (value >= 0.5f) ? 1.0f : 0.0f;
+    } else if (kind == ParamKind::Mode) {
+        value = static_cast<float>(std::lround(value));
+    }
+
+    targetValues_[index] = value;
+    if (kind == ParamKind::Mode) {
+        smoothedValues_[index] = value;
+        rampTicks_[index] = 0;
+        compilePending_ = true;
+        return;
+    }
+    if (value == smoothedValues_[index]) {
+        rampTicks_[index] = 0;
+        return;
+    }
+
+    const int ticks = std::max(1, static_cast<int>(std::lround(
+        SMOOTHING_MS * sampleRate_ / (1000.0 * CONTROL_INTERVAL))));
+    rampTicks_[index] = ticks;
+    rampStep_[index] = (value - smoothedValues_[index]) / ticks;
+    smoothing_ = true;
+}
+
+void DSPChain::resetSmoothing(const ParamValues& values)
+{
+    smoothedValues_ = values;
+    targetValues_ = values;
+    rampTicks_.fill(0);
+    smoothing_ = false;
+    compilePending_ = false;
+}
+
+bool DSPChain::isGliding() const
+{
+    if (morphing_) {
+        return std::max(0.0f, std::min(1.0f, morphTarget_.load())) != morphPosition_;
+    }
+    return smoothing_;
+}
+
+void DSPChain::controlTick()
+{
+    lastTick_ = samplePosition_;
+    if (morphing_) {
+        glideMorph();
+        return;
+    }
+
+    // Logarithmic values glide with a time constant of SMOOTHING_MS / 5,
+    // everything else ramps linearly over SMOOTHING_MS
+    const float coeff = 1.0f - std::exp(-5000.0f * CONTROL_INTERVAL / (SMOOTHING_MS * static_cast<float>(sampleRate_)));
+    bool moved = compilePending_;
+    bool active = false;
+    for (int i = 0; i < DSPParams::count(); ++i) {
+        if (rampTicks_[i] == 0) continue;
+
+        float& value = smoothedValues_[i];
+        const float target = targetValues_[i];
+        if (DSPParams::kind(static_cast<ParamId>(i)) == ParamKind::Logarithmic && value > 0.0f && target > 0.0f) {
+            value *= std::pow(target / value, coeff);
+            if (std::abs(value / target - 1.0f) < 1e-4f) {
+                value = target;
+                rampTicks_[i] = 0;
+            }
+        } else {
+            value += rampStep_[i];
+            if (--rampTicks_[i] == 0) {
+                value = target;
+            }
+        }
+        moved = true;
+        active = active || rampTicks_[i] != 0;
+    }
+
+    smoothing_ = active;
+    compilePending_ = false;
+    if (moved) {
+        targetVoice().settings.compile(smoothedValues_, sampleRate_);
+    }
 }
 
 void DSPChain::process(const float* input, float* outputL, float* outputR, int numSamples)
@@ -37,284 +768,527 @@ void DSPChain::process(const float* input, float* outputL, float* outputR, int n
     if ((int)workBuffer_.size() != numSamples) {
         workBuffer_.resize(numSamples);
         monoTemp_.resize(numSamples);
+        fadeLeft_.resize(numSamples);
+        fadeRight_.resize(numSamples);
+        dryLeft_.resize(numSamples);
+        dryRight_.resize(numSamples);
+        for (int bus = 0; bus < EffectGraph::MAX_BRANCHES - 1; ++bus) {
+            branchLeft_[bus].resize(numSamples);
+            branchRight_[bus].resize(numSamples);
+        }
     }
-    std::memcpy(workBuffer_.data(), input, numSamples * sizeof(float));
-    float* buffer = workBuffer_.data();
-    
-    // Gate
-    if (!params_.gateBypass.load()) {
-        processGate(buffer, numSamples);
+
+    // A published preset first, so its values reach the knob state before
+    // syncParams() could mistake them for knob moves
+    adoptPublished();
+    syncParams();
+
+    // Split at automation events and, while anything glides, at control
+    // ticks. Ticks sit on the timeline rather than in the block, so the
+    // output doesn't depend on the block size.
+    int done = 0;
+    while (done < numSamples) {
+        applyEvents();
+        int chunk = numSamples - done;
+        if (isGliding()) {
+            const int phase = static_cast<int>(samplePosition_ % CONTROL_INTERVAL);
+            if (phase == 0 && lastTick_ != samplePosition_) {
+                controlTick();
+            }
+            chunk = std::min(chunk, CONTROL_INTERVAL - phase);
+        }
+        ParamEvent event;
+        if (events_.peek(event)) {
+            chunk = static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(chunk, event.time - samplePosition_)));
+        }
+        processBlock(input + done, outputL + done, outputR + done, chunk);
+        done += chunk;
+        samplePosition_ += chunk;
     }
-    
-    // Drive
-    if (!params_.driveBypass.load()) {
-        processDrive(buffer, numSamples);
+    renderedPosition_.store(samplePosition_);
+}
+
+void DSPChain::processBlock(const float* input, float* outputL, float* outputR, int numSamples)
+{
+    processVoice(voices_[activeVoice_], input, outputL, outputR, numSamples);
+    if (fadeRemaining_ == 0) return;
+
+    // Equal-power crossfade: cos^2 + sin^2 = 1 at every step
+    processVoice(voices_[1 - activeVoice_], input, fadeLeft_.data(), fadeRight_.data(), numSamples);
+    const int fadeSamples = std::min(numSamples, fadeRemaining_);
+    for (int i = 0; i < fadeSamples; ++i) {
+        const double nextCos = fadeCos_ * fadeStepCos_ - fadeSin_ * fadeStepSin_;
+        fadeSin_ = fadeSin_ * fadeStepCos_ + fadeCos_ * fadeStepSin_;
+        fadeCos_ = nextCos;
+        const float oldGain = static_cast<float>(std::max(0.0, fadeCos_));
+        const float newGain = static_cast<float>(std::min(1.0, fadeSin_));
+        outputL[i] = outputL[i] * oldGain + fadeLeft_[i] * newGain;
+        outputR[i] = outputR[i] * oldGain + fadeRight_[i] * newGain;
     }
-    
-    // EQ (process to stereo from here)
-    std::memcpy(outputL, buffer, numSamples * sizeof(float));
-    std::memcpy(outputR, buffer, numSamples * sizeof(float));
-    
-    if (!params_.eqBypass.load()) {
-        processEQ(outputL, numSamples);
-        processEQ(outputR, numSamples);
+    std::memcpy(outputL + fadeSamples, fadeLeft_.data() + fadeSamples, (numSamples - fadeSamples) * sizeof(float));
+    std::memcpy(outputR + fadeSamples, fadeRight_.data() + fadeSamples, (numSamples - fadeSamples) * sizeof(float));
+
+    fadeRemaining_ -= fadeSamples;
+    if (fadeRemaining_ == 0) {
+        activeVoice_ = 1 - activeVoice_;
     }
-    
-    // Compressor
-    if (!params_.compBypass.load()) {
-        processCompressor(outputL, numSamples);
-        processCompressor(outputR, numSamples);
+}
+
+void DSPChain::processVoice(Voice& voice, const float* input, float* outputL, float* outputR, int numSamples)
+{
+    // The plan starts on the mono input and splits it to the output buses
+    std::memcpy(workBuffer_.data(), input, numSamples * sizeof(float));
+    busLeft_[0] = outputL;
+    busRight_[0] = outputR;
+    for (int bus = 1; bus < EffectGraph::MAX_BRANCHES; ++bus) {
+        busLeft_[bus] = branchLeft_[bus - 1].data();
+        busRight_[bus] = branchRight_[bus - 1].data();
     }
-    
-    // Pitch Shift
-    if (!lowLatencyMode_) {
-        if (!params_.pitchBypass.load() && params_.pitchMode.load() != 0) {
-            for (int i = 0; i < numSamples; ++i) {
-                monoTemp_[i] = (outputL[i] + outputR[i]) * 0.5f;
+
+    const ExecutionPlan& plan = voice.plan;
+    for (int i = 0; i < plan.numOps; ++i) {
+        const PlanOp& op = plan.ops[i];
+        (this->*op.run)(voice, op, numSamples);
+    }
+}
+
+bool DSPChain::compilePlan(const EffectGraph& graph, ExecutionPlan& plan)
+{
+    if (!graph.isValid()) return false;
+    plan = ExecutionPlan();
+
+    auto emit = [&plan](PlanFn run) -> PlanOp& {
+        PlanOp& op = plan.ops[plan.numOps++];
+        op.run = run;
+        return op;
+    };
+
+    // Gate, drive and compressor have one-channel forms for the mono section
+    bool mono = true;
+    auto endMono = [&]() {
+        if (!mono) return;
+        emit(&DSPChain::splitToStereo);
+        mono = false;
+    };
+    auto emitStage = [&](EffectId id, int bus) {
+        MonoFn monoFn = nullptr;
+        StereoFn stereoFn = nullptr;
+        switch (id) {
+            case EffectId::Gate: monoFn = &DSPChain::processGate; stereoFn = &DSPChain::processGateStereo; break;
+            case EffectId::Drive: monoFn = &DSPChain::processDrive; stereoFn = &DSPChain::processDriveStereo; break;
+            case EffectId::EQ: stereoFn = &DSPChain::processEQ; break;
+            case EffectId::Compressor: monoFn = &DSPChain::processCompressorMono; stereoFn = &DSPChain::processCompressor; break;
+            case EffectId::Pitch: stereoFn = &DSPChain::processPitchShift; break;
+            case EffectId::Delay: stereoFn = &DSPChain::processDelay; break;
+            case EffectId::Reverb: stereoFn = &DSPChain::processReverb; break;
+            default: return;
+        }
+        if (!monoFn) endMono();
+
+        PlanOp& op = emit(mono ? &DSPChain::runMonoStage : &DSPChain::runStereoStage);
+        op.mono = monoFn;
+        op.stereo = stereoFn;
+        op.effect = id;
+        op.bus = bus;
+        op.skipInLowLatency = id == EffectId::Pitch || id == EffectId::Delay || id == EffectId::Reverb;
+    };
+
+    for (const EffectGraph::Step& step : graph.steps) {
+        const int branches = static_cast<int>(step.size());
+        if (branches == 1) {
+            for (EffectId id : step[0]) {
+                emitStage(id, 0);
             }
-            processPitchShift(monoTemp_.data(), outputL, outputR, numSamples);
+            continue;
         }
-    }
-    
-    // Delay
-    if (!lowLatencyMode_) {
-        if (!params_.delayBypass.load()) {
-            processDelay(outputL, outputR, numSamples);
+
+        // Every branch starts from the step's input; the first runs on the
+        // output bus itself, the others on their own, and all are averaged
+        endMono();
+        PlanOp& copy = emit(&DSPChain::copyToBranches);
+        copy.bus = 1;
+        copy.count = branches - 1;
+        for (int b = 0; b < branches; ++b) {
+            for (EffectId id : step[b]) {
+                emitStage(id, b);
+            }
         }
+        PlanOp& mix = emit(&DSPChain::mixBranches);
+        mix.source = 1;
+        mix.count = branches - 1;
+        mix.gain = 1.0f / branches;
     }
-    
-    // Reverb
-    if (!lowLatencyMode_) {
-        if (!params_.reverbBypass.load()) {
-            processReverb(outputL, outputR, numSamples);
+    endMono();
+    return true;
+}
+
+void DSPChain::runMonoStage(Voice& voice, const PlanOp& op, int numSamples)
+{
+    const ChainSettings& settings = voice.settings;
+    if (!settings.isOn(op.effect) || (op.skipInLowLatency && lowLatencyMode_)) return;
+
+    const float wet = settings.wetLevel(op.effect);
+    float* buffer = workBuffer_.data();
+    saveDry(wet, buffer, nullptr, numSamples);
+    (this->*op.mono)(voice, buffer, numSamples);
+    mixDry(wet, buffer, nullptr, numSamples);
+}
+
+void DSPChain::runStereoStage(Voice& voice, const PlanOp& op, int numSamples)
+{
+    const ChainSettings& settings = voice.settings;
+    if (!settings.isOn(op.effect) || (op.skipInLowLatency && lowLatencyMode_)) return;
+
+    const float wet = settings.wetLevel(op.effect);
+    float* left = busLeft_[op.bus];
+    float* right = busRight_[op.bus];
+    saveDry(wet, left, right, numSamples);
+    (this->*op.stereo)(voice, left, right, numSamples);
+    mixDry(wet, left, right, numSamples);
+}
+
+void DSPChain::splitToStereo(Voice&, const PlanOp&, int numSamples)
+{
+    const size_t bytes = numSamples * sizeof(float);
+    std::memcpy(busLeft_[0], workBuffer_.data(), bytes);
+    std::memcpy(busRight_[0], workBuffer_.data(), bytes);
+}
+
+void DSPChain::copyToBranches(Voice&, const PlanOp& op, int numSamples)
+{
+    const size_t bytes = numSamples * sizeof(float);
+    for (int bus = op.bus; bus < op.bus + op.count; ++bus) {
+        std::memcpy(busLeft_[bus], busLeft_[op.source], bytes);
+        std::memcpy(busRight_[bus], busRight_[op.source], bytes);
+    }
+}
+
+void DSPChain::mixBranches(Voice&, const PlanOp& op, int numSamples)
+{
+    float* left = busLeft_[op.bus];
+    float* right = busRight_[op.bus];
+    for (int bus = op.source; bus < op.source + op.count; ++bus) {
+        const float* branchL = busLeft_[bus];
+        const float* branchR = busRight_[bus];
+        for (int i = 0; i < numSamples; ++i) {
+            left[i] += branchL[i];
+            right[i] += branchR[i];
         }
     }
+    for (int i = 0; i < numSamples; ++i) {
+        left[i] *= op.gain;
+        right[i] *= op.gain;
+    }
+}
+
+void DSPChain::blendStage(float wet, const float* dry, float* buffer, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i) {
+        buffer[i] = dry[i] + (buffer[i] - dry[i]) * wet;
+    }
+}
+
+void DSPChain::saveDry(float wet, const float* left, const float* right, int numSamples)
+{
+    if (wet >= 1.0f) return;
+    std::memcpy(dryLeft_.data(), left, numSamples * sizeof(float));
+    if (right) std::memcpy(dryRight_.data(), right, numSamples * sizeof(float));
 }
 
-void DSPChain::processGate(float* buffer, int numSamples)
+void DSPChain::mixDry(float wet, float* left, float* right, int numSamples)
 {
-    float threshold = std::pow(10.0f, params_.gateThreshold.load() / 20.0f);
-    float attack = 1.0f - std::exp(-1.0f / (params_.gateAttack.load() * sampleRate_));
-    float release = 1.0f - std::exp(-1.0f / (params_.gateRelease.load() * sampleRate_));
+    if (wet >= 1.0f) return;
+    blendStage(wet, dryLeft_.data(), left, numSamples);
+    if (right) blendStage(wet, dryRight_.data(), right, numSamples);
+}
+
+void DSPChain::processGate(Voice& voice, float* buffer, int numSamples)
+{
+    const ChainSettings& settings = voice.settings;
+    float threshold = settings.gateThreshold;
+    float attack = settings.gateAttack;
+    float release = settings.gateRelease;
+    float envelope = voice.gateEnvelope;
     
     for (int i = 0; i < numSamples; ++i) {
         float input = std::abs(buffer[i]);
         
         if (input > threshold) {
-            gateEnvelope_ += (1.0f - gateEnvelope_) * attack;
+            envelope += (1.0f - envelope) * attack;
         } else {
-            gateEnvelope_ += (0.0f - gateEnvelope_) * release;
+            envelope += (0.0f - envelope) * release;
         }
         
-        buffer[i] *= gateEnvelope_;
+        buffer[i] *= envelope;
     }
+    voice.gateEnvelope = envelope;
 }
 
-void DSPChain::processDrive(float* buffer, int numSamples)
+void DSPChain::processGateStereo(Voice& voice, float* bufferL, float* bufferR, int numSamples)
 {
-    float amount = params_.driveAmount.load();
-    int type = params_.driveType.load();
-    // Apply pre-gain scaling (1..8x) before distortion curve
-    float pre = 1.0f + params_.preGain.load() * 7.0f;
-    float gain = pre * (1.0f + amount * 20.0f);
+    const ChainSettings& settings = voice.settings;
+    float threshold = settings.gateThreshold;
+    float attack = settings.gateAttack;
+    float release = settings.gateRelease;
+    float envelope = voice.gateEnvelope;
     
     for (int i = 0; i < numSamples; ++i) {
-        float x = buffer[i] * gain;
+        // Linked detector, as in the compressor
+        float input = std::max(std::abs(bufferL[i]), std::abs(bufferR[i]));
         
-        switch (type) {
-            case 0: // Soft clip
-                buffer[i] = std::tanh(x);
-                break;
-            case 1: // Hard clip
-                buffer[i] = std::max(-1.0f, std::min(1.0f, x));
-                break;
-            case 2: // Asymmetric
-                if (x > 0) {
-                    buffer[i] = std::tanh(x * 1.5f) * 0.7f;
-                } else {
-                    buffer[i] = std::tanh(x * 0.7f) * 1.3f;
-                }
-                break;
+        if (input > threshold) {
+            envelope += (1.0f - envelope) * attack;
+        } else {
+            envelope += (0.0f - envelope) * release;
         }
         
-        buffer[i] *= (1.0f / (1.0f + amount * 0.5f)); // Compensate
+        bufferL[i] *= envelope;
+        bufferR[i] *= envelope;
     }
+    voice.gateEnvelope = envelope;
 }
 
-void DSPChain::processEQ(float* buffer, int numSamples)
+void DSPChain::processDrive(Voice& voice, float* buffer, int numSamples)
 {
-    // Determine if this is left or right channel based on buffer pointer
-    bool isLeft = (buffer == &buffer[0]); // Simplified check
-    int ch = isLeft ? 0 : 1;
-    
-    // Calculate coefficients
-    float b0_low, b1_low, b2_low, a1_low, a2_low;
-    float b0_mid, b1_mid, b2_mid, a1_mid, a2_mid;
-    float b0_high, b1_high, b2_high, a1_high, a2_high;
-    float b0_presence, b1_presence, b2_presence, a1_presence, a2_presence;
+    const ChainSettings& settings = voice.settings;
+    const int type = settings.driveType;
+    const float gain = settings.driveGain;
+    const float makeup = settings.driveMakeup;
     
-    calculateBiquadCoeffs(params_.lowFreq.load(), 0.707f, params_.lowGain.load(), 
-                         true, b0_low, b1_low, b2_low, a1_low, a2_low);
-    calculateBiquadCoeffs(params_.midFreq.load(), params_.midQ.load(), params_.midGain.load(), 
-                         false, b0_mid, b1_mid, b2_mid, a1_mid, a2_mid);
-    calculateBiquadCoeffs(params_.highFreq.load(), 0.707f, params_.highGain.load(), 
-                         true, b0_high, b1_high, b2_high, a1_high, a2_high);
-    // Presence additional high shelf (independent gain)
-    calculateBiquadCoeffs(params_.presenceFreq.load(), 0.707f, params_.presenceGain.load(),
-                          true, b0_presence, b1_presence, b2_presence, a1_presence, a2_presence);
+    if (settings.driveMorph > 0.0f && settings.driveTypeB != type) {
+        // Morphing between two curves
+        const int typeB = settings.driveTypeB;
+        const float morph = settings.driveMorph;
+        for (int i = 0; i < numSamples; ++i) {
+            float x = buffer[i] * gain;
+            float a = shapeDrive(type, x);
+            buffer[i] = (a + (shapeDrive(typeB, x) - a) * morph) * makeup;
+        }
+        return;
+    }
     
     for (int i = 0; i < numSamples; ++i) {
-        float sample = buffer[i];
-        
-        // Low shelf
-        sample = processBiquad(sample, &lowZ1_[ch], &lowZ2_[ch], 
-                              b0_low, b1_low, b2_low, a1_low, a2_low);
-        
-        // Mid peak
-        sample = processBiquad(sample, &midZ1_[ch], &midZ2_[ch], 
-                              b0_mid, b1_mid, b2_mid, a1_mid, a2_mid);
-        
-        // High shelf
-        sample = processBiquad(sample, &highZ1_[ch], &highZ2_[ch], 
-                              b0_high, b1_high, b2_high, a1_high, a2_high);
-        // Presence shelf
-        sample = processBiquad(sample, &presenceZ1_[ch], &presenceZ2_[ch],
-                       b0_presence, b1_presence, b2_presence, a1_presence, a2_presence);
-        
-        buffer[i] = sample;
+        buffer[i] = shapeDrive(type, buffer[i] * gain) * makeup; // Compensate
     }
 }
 
-float DSPChain::processBiquad(float input, float* z1, float* z2,
-                              float b0, float b1, float b2, float a1, float a2)
+void DSPChain::processDriveStereo(Voice& voice, float* bufferL, float* bufferR, int numSamples)
+{
+    processDrive(voice, bufferL, numSamples);
+    processDrive(voice, bufferR, numSamples);
+}
+
+float DSPChain::shapeDrive(int type, float x)
 {
-    float output = b0 * input + *z1;
-    *z1 = b1 * input - a1 * output + *z2;
-    *z2 = b2 * input - a2 * output;
-    return output;
+    switch (type) {
+        case 0: // Soft clip
+            return std::tanh(x);
+        case 1: // Hard clip
+            return std::max(-1.0f, std::min(1.0f, x));
+        case 2: // Asymmetric
+            if (x > 0) {
+                return std::tanh(x * 1.5f) * 0.7f;
+            }
+            return std::tanh(x * 0.7f) * 1.3f;
+    }
+    return x;
 }
 
-void DSPChain::calculateBiquadCoeffs(float freq, float q, float gain, bool isShelf,
-                                     float& b0, float& b1, float& b2, float& a1, float& a2)
+void DSPChain::processEQ(Voice& voice, float* bufferL, float* bufferR, int numSamples)
 {
-    float w0 = 2.0f * PI * freq / sampleRate_;
-    float cosw0 = std::cos(w0);
-    float sinw0 = std::sin(w0);
-    float A = std::pow(10.0f, gain / 40.0f);
-    float alpha = sinw0 / (2.0f * q);
+    using Filter = SvfFilter<float, 2>;
+    const int bands = ChainSettings::EQ_BANDS;
+    const SvfCoeffs<float>* target = voice.settings.eq;
     
-    if (isShelf) {
-        float beta = std::sqrt(A) / q;
-        b0 = A * ((A + 1) + (A - 1) * cosw0 + beta * sinw0);
-        b1 = -2 * A * ((A - 1) + (A + 1) * cosw0);
-        b2 = A * ((A + 1) + (A - 1) * cosw0 - beta * sinw0);
-        float a0 = (A + 1) - (A - 1) * cosw0 + beta * sinw0;
-        a1 = 2 * ((A - 1) - (A + 1) * cosw0);
-        a2 = (A + 1) - (A - 1) * cosw0 - beta * sinw0;
-        
-        b0 /= a0;
-        b1 /= a0;
-        b2 /= a0;
-        a1 /= a0;
-        a2 /= a0;
-    } else {
-        // Peak
-        b0 = 1 + alpha * A;
-        b1 = -2 * cosw0;
-        b2 = 1 - alpha * A;
-        float a0 = 1 + alpha / A;
-        a1 = -2 * cosw0;
-        a2 = 1 - alpha / A;
+    // New settings (a knob glide, automation or a morph tick) are reached
+    // over one control interval, by which time the next ones are due; the
+    // filter's state absorbs the small steps without clicks
+    if (!voice.eqPrimed) {
+        std::copy(target, target + bands, voice.eqCoeffs);
+        std::copy(target, target + bands, voice.eqTarget);
+        voice.eqRamp = 0;
+        voice.eqPrimed = true;
+    } else if (std::memcmp(target, voice.eqTarget, sizeof(voice.eqTarget)) != 0) {
+        for (int band = 0; band < bands; ++band) {
+            voice.eqStep[band] = coeffStep(voice.eqCoeffs[band], target[band], CONTROL_INTERVAL / EQ_RAMP_STEP);
+        }
+        std::copy(target, target + bands, voice.eqTarget);
+        voice.eqRamp = CONTROL_INTERVAL;
+    }
+    
+    // Work on local copies so the bands stay in registers
+    SvfCoeffs<float> c[bands];
+    Filter filters[bands];
+    Filter::Prepared prepared[bands];
+    std::copy(voice.eqCoeffs, voice.eqCoeffs + bands, c);
+    std::copy(voice.eqBands, voice.eqBands + bands, filters);
+    for (int band = 0; band < bands; ++band) {
+        prepared[band] = Filter::Prepared(c[band]);
+    }
+    
+    float* const channels[2] = { bufferL, bufferR };
+    int i = 0;
+    while (i < numSamples) {
+        int run = numSamples - i;
+        if (voice.eqRamp > 0) {
+            // Ramps move in EQ_RAMP_STEP sub-blocks, landing exactly on the target
+            if (voice.eqRamp % EQ_RAMP_STEP == 0) {
+                for (int band = 0; band < bands; ++band) {
+                    if (voice.eqRamp == EQ_RAMP_STEP) {
+                        c[band] = target[band];
+                    } else {
+                        addStep(c[band], voice.eqStep[band]);
+                    }
+                    prepared[band] = Filter::Prepared(c[band]);
+                }
+            }
+            run = std::min(run, (voice.eqRamp - 1) % EQ_RAMP_STEP + 1);
+            voice.eqRamp -= run;
+        }
         
-        b0 /= a0;
-        b1 /= a0;
-        b2 /= a0;
-        a1 /= a0;
-        a2 /= a0;
+        // Both channels of a sample go through the bands together
+        for (const int end = i + run; i < end; ++i) {
+            Filter::Frame frame = Filter::Frame::load(channels, i);
+            for (int band = 0; band < bands; ++band) {
+                frame = filters[band].process(frame, prepared[band]);
+            }
+            frame.store(channels, i);
+        }
     }
+    
+    std::copy(c, c + bands, voice.eqCoeffs);
+    std::copy(filters, filters + bands, voice.eqBands);
 }
 
-void DSPChain::processCompressor(float* buffer, int numSamples)
+void DSPChain::processCompressorMono(Voice& voice, float* buffer, int numSamples)
 {
-    float threshold = std::pow(10.0f, params_.compThreshold.load() / 20.0f);
-    float ratio = params_.compRatio.load();
-    float attack = 1.0f - std::exp(-1.0f / (params_.compAttack.load() * sampleRate_));
-    float release = 1.0f - std::exp(-1.0f / (params_.compRelease.load() * sampleRate_));
+    const ChainSettings& settings = voice.settings;
+    float threshold = settings.compThreshold;
+    float attack = settings.compAttack;
+    float release = settings.compRelease;
+    float envelope = voice.compEnvelope;
     
     for (int i = 0; i < numSamples; ++i) {
         float input = std::abs(buffer[i]);
         
+        if (input > envelope) {
+            envelope += (input - envelope) * attack;
+        } else {
+            envelope += (input - envelope) * release;
+        }
+        
+        if (envelope > threshold) {
+            buffer[i] *= std::pow(envelope / threshold, settings.compExponent);
+        }
+    }
+    voice.compEnvelope = envelope;
+}
+
+void DSPChain::processCompressor(Voice& voice, float* bufferL, float* bufferR, int numSamples)
+{
+    const ChainSettings& settings = voice.settings;
+    float threshold = settings.compThreshold;
+    float attack = settings.compAttack;
+    float release = settings.compRelease;
+    float envelope = voice.compEnvelope;
+    
+    for (int i = 0; i < numSamples; ++i) {
+        // Linked stereo detector, so both channels get the same gain
+        float input = std::max(std::abs(bufferL[i]), std::abs(bufferR[i]));
+        
         // Envelope follower
-        if (input > compEnvelope_) {
-            compEnvelope_ += (input - compEnvelope_) * attack;
+        if (input > envelope) {
+            envelope += (input - envelope) * attack;
         } else {
-            compEnvelope_ += (input - compEnvelope_) * release;
+            envelope += (input - envelope) * release;
         }
         
         // Compute gain reduction
         float gain = 1.0f;
-        if (compEnvelope_ > threshold) {
-            float excess = compEnvelope_ / threshold;
-            gain = std::pow(excess, (1.0f / ratio) - 1.0f);
+        if (envelope > threshold) {
+            float excess = envelope / threshold;
+            gain = std::pow(excess, settings.compExponent);
         }
         
-        buffer[i] *= gain;
+        bufferL[i] *= gain;
+        bufferR[i] *= gain;
     }
+    voice.compEnvelope = envelope;
 }
 
-void DSPChain::processPitchShift(const float* input, float* outputL, float* outputR, int numSamples)
+void DSPChain::processPitchShift(Voice& voice, float* bufferL, float* bufferR, int numSamples)
 {
-    int mode = params_.pitchMode.load();
-    float semitones = (mode == 1) ? -1.0f : 1.0f;
-    pitchShifter_->process(input, outputL, outputR, numSamples, semitones);
+    // The shifter takes one channel and returns two
+    for (int i = 0; i < numSamples; ++i) {
+        monoTemp_[i] = (bufferL[i] + bufferR[i]) * 0.5f;
+    }
+    voice.pitchShifter->process(monoTemp_.data(), bufferL, bufferR, numSamples, voice.settings.pitchSemitones);
 }
 
-void DSPChain::processDelay(float* bufferL, float* bufferR, int numSamples)
+void DSPChain::processDelay(Voice& voice, float* bufferL, float* bufferR, int numSamples)
 {
-    float time = params_.delayTime.load();
-    float feedback = params_.delayFeedback.load();
-    float mix = params_.delayMix.load();
+    const ChainSettings& settings = voice.settings;
+    float feedback = settings.delayFeedback;
+    float mix = settings.delayMix;
+    float* lineL = voice.delayBufferL.data();
+    float* lineR = voice.delayBufferR.data();
+    const int size = static_cast<int>(voice.delayBufferL.size());
+    const int delaySamples = std::min(settings.delaySamples, size - 1);
+    int writePos = voice.delayWritePos;
     
-    int delaySamples = static_cast<int>(time * sampleRate_);
-    delaySamples = std::max(1, std::min(delaySamples, static_cast<int>(delayBufferL_.size()) - 1));
+    // High-cut on the taps, so every repeat is darker than the last
+    using Filter = SvfFilter<float, 2>;
+    Filter highCut = voice.delayFilter;
+    const Filter::Prepared highCutCoeffs(settings.delayHighCut);
+    float tap[2];
+    float* const taps[2] = { &tap[0], &tap[1] };
     
     for (int i = 0; i < numSamples; ++i) {
-        int readPos = (delayWritePos_ - delaySamples + delayBufferL_.size()) % delayBufferL_.size();
+        int readPos = writePos - delaySamples;
+        if (readPos < 0) readPos += size;
         
-        float delayOutL = delayBufferL_[readPos];
-        float delayOutR = delayBufferR_[readPos];
+        // Taps from before the last reset are silence
+        const bool written = voice.delayWritten >= delaySamples;
+        tap[0] = written ? lineL[readPos] : 0.0f;
+        tap[1] = written ? lineR[readPos] : 0.0f;
+        highCut.process(Filter::Frame::load(taps, 0), highCutCoeffs).store(taps, 0);
+        const float delayOutL = tap[0];
+        const float delayOutR = tap[1];
         
-        // Apply feedback with high-cut
-        delayFeedbackL_ = delayOutL * feedback;
-        delayFeedbackR_ = delayOutR * feedback;
-        
-        delayBufferL_[delayWritePos_] = bufferL[i] + delayFeedbackL_;
-        delayBufferR_[delayWritePos_] = bufferR[i] + delayFeedbackR_;
+        lineL[writePos] = bufferL[i] + delayOutL * feedback;
+        lineR[writePos] = bufferR[i] + delayOutR * feedback;
         
         bufferL[i] = bufferL[i] * (1.0f - mix) + delayOutL * mix;
         bufferR[i] = bufferR[i] * (1.0f - mix) + delayOutR * mix;
         
-        delayWritePos_ = (delayWritePos_ + 1) % delayBufferL_.size();
+        if (++writePos == size) writePos = 0;
+        ++voice.delayWritten;
     }
+    voice.delayWritePos = writePos;
+    voice.delayFilter = highCut;
 }
 
-void DSPChain::processReverb(float* bufferL, float* bufferR, int numSamples)
+void DSPChain::processReverb(Voice& voice, float* bufferL, float* bufferR, int numSamples)
 {
-    float mix = params_.reverbMix.load();
-    float damping = params_.reverbDamping.load();
+    const ChainSettings& settings = voice.settings;
+    float mix = settings.reverbMix;
+    float damping = settings.reverbDamping;
     
     for (int i = 0; i < numSamples; ++i) {
         float reverbL = 0.0f;
         float reverbR = 0.0f;
         
+        // Each comb's first pass after a reset reads slots not yet written
+        const int64_t written = voice.reverbWritten + i;
         for (int c = 0; c < NUM_COMBS; ++c) {
-            int pos = combPositions_[c];
-            float* combBufL = combBuffersL_[c].data();
-            float* combBufR = combBuffersR_[c].data();
-            int len = combBuffersL_[c].size();
+            int pos = voice.combPositions[c];
+            float* combBufL = voice.combBuffersL[c].data();
+            float* combBufR = voice.combBuffersR[c].data();
+            int len = voice.combBuffersL[c].size();
             
-            float outL = combBufL[pos];
-            float outR = combBufR[pos];
+            const bool primed = written >= len;
+            float outL = primed ? combBufL[pos] : 0.0f;
+            float outR = primed ? combBufR[pos] : 0.0f;
             
             combBufL[pos] = bufferL[i] + outL * combFeedback_[c] * (1.0f - damping);
             combBufR[pos] = bufferR[i] + outR * combFeedback_[c] * (1.0f - damping);
@@ -322,7 +1296,7 @@ void DSPChain::processReverb(float* bufferL, float* bufferR, int numSamples)
             reverbL += outL;
             reverbR += outR;
             
-            combPositions_[c] = (pos + 1) % len;
+            voice.combPositions[c] = (pos + 1) % len;
         }
         
         reverbL /= NUM_COMBS;
@@ -331,4 +1305,5 @@ void DSPChain::processReverb(float* bufferL, float* bufferR, int numSamples)
         bufferL[i] = bufferL[i] * (1.0f - mix) + reverbL * mix;
         bufferR[i] = bufferR[i] * (1.0f - mix) + reverbR * mix;
     }
-}
\ No newline at end of file
+    voice.reverbWritten += numSamples;
+}
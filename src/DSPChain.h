@@ -2,11 +2,59 @@
 #define DSPCHAIN_H
 
 #include <atomic>
+#include <array>
 #include <vector>
+#include <memory>
+#include <string>
 #include <cmath>
+#include <cstdint>
+#include "EffectGraph.h"
 #include "PitchShifter.h"
+#include "SvfFilter.h"
+
+// Every DSPParams field, for generic access (copying, presets, automation).
+// Switches and modes are carried as 0/1 and whole-number floats.
+enum class ParamId {
+    GateBypass, GateThreshold, GateAttack, GateRelease,
+    DriveBypass, DriveAmount, DriveType, PreGain,
+    EqBypass, LowGain, LowFreq, MidGain, MidFreq, MidQ, HighGain, HighFreq, PresenceGain, PresenceFreq,
+    CompBypass, CompThreshold, CompRatio, CompAttack, CompRelease,
+    PitchBypass, PitchMode,
+    DelayBypass, DelayTime, DelayFeedback, DelayMix, DelayHighCut,
+    ReverbBypass, ReverbSize, ReverbDamping, ReverbMix,
+    Count
+};
+
+// Plain copy of every parameter, indexed by ParamId
+using ParamValues = std::array<float, static_cast<size_t>(ParamId::Count)>;
+
+// How a parameter is stored and interpolated: switches and modes jump,
+// dB values and 0..1 amounts move linearly, frequencies, times and ratios
+// move geometrically so equal steps sound equal
+enum class ParamKind {
+    Switch,
+    Mode,
+    Linear,
+    Logarithmic
+};
 
 struct DSPParams {
+    float get(ParamId id) const;
+    void set(ParamId id, float value);
+    void copyFrom(const DSPParams& other);
+    ParamValues snapshot() const;
+    void apply(const ParamValues& values);
+
+    // Preset key for a parameter, e.g. "gateThreshold"
+    static const char* name(ParamId id);
+    static ParamKind kind(ParamId id);
+
+    // Point t (0..1) on the perceptual path from a to b; switches and modes
+    // take the nearer end
+    static ParamValues morph(const ParamValues& a, const ParamValues& b, float t);
+    static bool findByName(const std::string& name, ParamId& id);
+    static constexpr int count() { return static_cast<int>(ParamId::Count); }
+
     // Gate
     std::atomic<bool> gateBypass{true};
     std::atomic<float> gateThreshold{-60.0f};
@@ -56,66 +104,370 @@ struct DSPParams {
     std::atomic<float> reverbMix{0.25f};
 };
 
+// Everything the audio thread derives from a parameter set: switches,
+// linear thresholds, envelope and filter coefficients, the delay length.
+// Compiled once per change instead of once per block; a preset is compiled
+// on the UI thread and handed over whole.
+struct ChainSettings {
+    // A bypass value between 0 and 1 (a switch being smoothed) runs the
+    // stage at a wet level of 1 - bypass
+    void compile(const ParamValues& values, int sampleRate);
+
+    // Settings at point t between two parameter sets. Continuous values
+    // follow DSPParams::morph(); a stage switched on at one end only is
+    // blended in through its wet level, and differing drive curves or pitch
+    // modes are mixed rather than switched.
+    void compileMorph(const ParamValues& a, const ParamValues& b, float t, int sampleRate);
+
+    // The switch and wet level below of one stage
+    bool isOn(EffectId id) const;
+    float wetLevel(EffectId id) const;
+
+    ParamValues values{};
+    int sampleRate{0};
+
+    // Each stage runs when on, and its output is blended with its input by
+    // the wet level (1 unless morphing or switching between on and off)
+    bool gateOn{false};
+    float gateWet{1.0f};
+    float gateThreshold{0.0f};
+    float gateAttack{0.0f};
+    float gateRelease{0.0f};
+
+    bool driveOn{false};
+    float driveWet{1.0f};
+    int driveType{0};
+    int driveTypeB{0};
+    float driveMorph{0.0f}; // share of driveTypeB's curve
+    float driveGain{1.0f};
+    float driveMakeup{1.0f};
+
+    // Low shelf, mid peak, high shelf, presence shelf
+    static const int EQ_BANDS = 4;
+    bool eqOn{false};
+    float eqWet{1.0f};
+    SvfCoeffs<float> eq[EQ_BANDS];
+
+    bool compOn{false};
+    float compWet{1.0f};
+    float compThreshold{1.0f};
+    float compExponent{0.0f}; // 1/ratio - 1
+    float compAttack{0.0f};
+    float compRelease{0.0f};
+
+    bool pitchOn{false};
+    float pitchWet{1.0f};
+    float pitchSemitones{0.0f};
+
+    bool delayOn{false};
+    float delayWet{1.0f};
+    int delaySamples{1};
+    float delayFeedback{0.0f};
+    float delayMix{0.0f};
+    SvfCoeffs<float> delayHighCut; // low-pass in the repeats
+
+    bool reverbOn{false};
+    float reverbWet{1.0f};
+    float reverbDamping{0.0f};
+    float reverbMix{0.0f};
+};
+
+// Parameter change at an absolute sample of a chain's timeline
+struct ParamEvent {
+    int64_t time{0};
+    ParamId id{ParamId::Count};
+    float value{0.0f};
+};
+
+// Wait-free single-producer / single-consumer queue of parameter events
+// with fixed capacity, so the audio thread never allocates or locks. Same
+// index discipline as SpscRingBuffer.
+class ParamEventQueue {
+public:
+    ParamEventQueue();
+
+    // Producer side; false when full
+    bool push(const ParamEvent& event);
+
+    // Consumer side
+    bool peek(ParamEvent& event) const;
+    void pop();
+    void clear();
+
+    static const int CAPACITY = 1024;
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<ParamEvent> events_;
+
+    struct alignas(CACHE_LINE) PaddedIndex {
+        std::atomic<size_t> value{0};
+    };
+    PaddedIndex writePos_;
+    PaddedIndex readPos_;
+};
+
 class DSPChain {
 public:
     DSPChain();
     
     void setSampleRate(int sampleRate);
+
+    // Clears all filter, delay and reverb state without reallocating, so one
+    // chain can render many independent passes. The timeline restarts at 0,
+    // pending automation is dropped and the next parameters apply without
+    // smoothing.
+    void reset();
+
     void process(const float* input, float* outputL, float* outputR, int numSamples);
     
     DSPParams& getParams() { return params_; }
     void setLowLatency(bool enabled) { lowLatencyMode_ = enabled; }
+
+    // Whole-preset switch (UI thread). The settings are compiled here and
+    // published with one pointer swap; the audio thread crossfades from the
+    // current sound to the new one. Parameters read back afterwards are the
+    // preset's, and the audio thread never sees them half written.
+    void loadPreset(const ParamValues& values);
+
+    // Same with settings compiled ahead of time (see PresetBank); only
+    // recompiled if they were built for another sample rate
+    void loadPreset(std::shared_ptr<const ChainSettings> settings);
+
+    // A/B morph (UI thread). The chain interpolates between the two sets at
+    // control rate, following the position with a short glide, so a slider
+    // costs one atomic store per move. Knob changes are ignored while
+    // morphing; stopMorph() settles on the current point like a preset
+    // load. Loading a preset ends a morph.
+    void startMorph(const ParamValues& a, const ParamValues& b);
+    void setMorphPosition(float position) { morphTarget_.store(position); } // 0 = A, 1 = B
+    void stopMorph();
+    bool isMorphing() const { return morphHold_ != nullptr; }
+
+    // Sample-accurate automation (one producer thread). The value becomes
+    // the parameter's target on the given sample of the chain's timeline
+    // (see getSamplePosition()) and is reached with the same smoothing as a
+    // knob move. Events must be queued in time order; one already in the
+    // past applies at the start of the next block. Knob moves land at block
+    // starts instead, so offline renders that reset() the chain and drive
+    // every change through here come out bit-identical at any block size.
+    // Ignored while morphing. Returns false when the queue is full.
+    bool scheduleParam(ParamId id, float value, int64_t samplePosition);
+    int64_t getSamplePosition() const { return renderedPosition_.load(); } // first sample of the next block
+
+    // Effect order (UI thread). The graph is compiled here into a flat plan
+    // of stage calls and buffer moves and published with one pointer swap;
+    // the audio thread crossfades from the old order to the new one, or
+    // switches at once if the chain hasn't rendered since reset(). Returns
+    // false for an invalid graph.
+    bool setEffectGraph(const EffectGraph& graph);
+    const EffectGraph& getEffectGraph() const { return graph_; }
+
+    static const int CROSSFADE_MS = 20;
+    static const int MORPH_GLIDE_MS = 30;
+    static const int SMOOTHING_MS = 20; // parameter ramps; log-scaled values are within 1% after it
+    static const int CONTROL_INTERVAL = 32; // samples per settings update while gliding
     
 private:
-    void processGate(float* buffer, int numSamples);
-    void processDrive(float* buffer, int numSamples);
-    void processEQ(float* buffer, int numSamples);
-    void processCompressor(float* buffer, int numSamples);
-    void processPitchShift(const float* input, float* outputL, float* outputR, int numSamples);
-    void processDelay(float* bufferL, float* bufferR, int numSamples);
-    void processReverb(float* bufferL, float* bufferR, int numSamples);
-    
-    float processBiquad(float input, float* z1, float* z2, 
-                       float b0, float b1, float b2, float a1, float a2);
-    void calculateBiquadCoeffs(float freq, float q, float gain, bool isShelf,
-                              float& b0, float& b1, float& b2, float& a1, float& a2);
+    // Reverb (simple comb filters)
+    static const int NUM_COMBS = 8;
+
+    // Samples per coefficient step while the EQ moves to new settings
+    static const int EQ_RAMP_STEP = 8;
+
+    struct Voice;
+    struct PlanOp;
+    using PlanFn = void (DSPChain::*)(Voice& voice, const PlanOp& op, int numSamples);
+    using MonoFn = void (DSPChain::*)(Voice& voice, float* buffer, int numSamples);
+    using StereoFn = void (DSPChain::*)(Voice& voice, float* left, float* right, int numSamples);
+
+    // One call of an execution plan: a stage on one bus, or audio moved
+    // between buses. Bus 0 is the voice output; parallel branches run on
+    // buses 1 and up.
+    struct PlanOp {
+        PlanFn run{nullptr};
+        MonoFn mono{nullptr};
+        StereoFn stereo{nullptr};
+        EffectId effect{EffectId::Count};
+        int bus{0};
+        int source{0};   // first bus read by copies and mixes
+        int count{0};    // buses copied to or mixed in
+        float gain{1.0f};
+        bool skipInLowLatency{false};
+    };
+
+    // An EffectGraph flattened into calls run once per block, in order.
+    // Plain data, so the audio thread adopts one by copying. The leading
+    // effects that can run on one channel do so while the signal is still
+    // the mono input; the rest run on stereo buses.
+    static const int MAX_PLAN_OPS = 3 * EffectGraph::count() + 1;
+    struct ExecutionPlan {
+        PlanOp ops[MAX_PLAN_OPS];
+        int numOps{0};
+    };
+
+    // Filter, envelope, delay and reverb memory of one pass through the
+    // chain, with the settings it runs on. Two exist so that a preset switch
+    // can run the old and new sound side by side during the crossfade.
+    struct Voice {
+        ChainSettings settings;
+        ExecutionPlan plan;
+
+        float gateEnvelope{0.0f};
+
+        // EQ bands (both channels each) and the coefficients in use: when
+        // the settings change they are reached over one control interval in
+        // EQ_RAMP_STEP steps (none after a clear)
+        SvfFilter<float, 2> eqBands[ChainSettings::EQ_BANDS];
+        SvfCoeffs<float> eqCoeffs[ChainSettings::EQ_BANDS];
+        SvfCoeffs<float> eqTarget[ChainSettings::EQ_BANDS];
+        SvfCoeffs<float> eqStep[ChainSettings::EQ_BANDS];
+        int eqRamp{0};
+        bool eqPrimed{false};
+
+        float compEnvelope{0.0f};
+
+        std::unique_ptr<PitchShifter> pitchShifter;
+
+        // Frames written since the last reset; older delay taps read silence,
+        // so the 2 second lines never need clearing on the audio thread
+        std::vector<float> delayBufferL;
+        std::vector<float> delayBufferR;
+        int delayWritePos{0};
+        int64_t delayWritten{0};
+        SvfFilter<float, 2> delayFilter;
+
+        // Same for the combs: a slot not yet written since the reset reads
+        // silence, so the incoming voice of a fade starts without a fill
+        std::vector<float> combBuffersL[NUM_COMBS];
+        std::vector<float> combBuffersR[NUM_COMBS];
+        int combPositions[NUM_COMBS]{};
+        int64_t reverbWritten{0};
+
+        // Constant time apart from the small filter states
+        void clear();
+    };
+
+    struct MorphSets {
+        ParamValues a;
+        ParamValues b;
+    };
+
+    void processBlock(const float* input, float* outputL, float* outputR, int numSamples);
+    void processVoice(Voice& voice, const float* input, float* outputL, float* outputR, int numSamples);
+    void processGate(Voice& voice, float* buffer, int numSamples);
+    void processGateStereo(Voice& voice, float* bufferL, float* bufferR, int numSamples);
+    void processDrive(Voice& voice, float* buffer, int numSamples);
+    void processDriveStereo(Voice& voice, float* bufferL, float* bufferR, int numSamples);
+    void processEQ(Voice& voice, float* bufferL, float* bufferR, int numSamples);
+    void processCompressorMono(Voice& voice, float* buffer, int numSamples);
+    void processCompressor(Voice& voice, float* bufferL, float* bufferR, int numSamples);
+    void processPitchShift(Voice& voice, float* bufferL, float* bufferR, int numSamples);
+    void processDelay(Voice& voice, float* bufferL, float* bufferR, int numSamples);
+    void processReverb(Voice& voice, float* bufferL, float* bufferR, int numSamples);
+
+    // Plan compilation (any thread) and the calls a plan is made of
+    static bool compilePlan(const EffectGraph& graph, ExecutionPlan& plan);
+    void runMonoStage(Voice& voice, const PlanOp& op, int numSamples);
+    void runStereoStage(Voice& voice, const PlanOp& op, int numSamples);
+    void splitToStereo(Voice& voice, const PlanOp& op, int numSamples);
+    void copyToBranches(Voice& voice, const PlanOp& op, int numSamples);
+    void mixBranches(Voice& voice, const PlanOp& op, int numSamples);
+
+    // Audio thread, start of each block
+    void adoptPublished();
+    void syncParams();
+    void applyEvents();
+    Voice& beginFade();
+    Voice& targetVoice() { return voices_[fadeRemaining_ > 0 ? 1 - activeVoice_ : activeVoice_]; }
+
+    // Control rate (audio thread): parameter smoothing and the morph glide
+    // step on ticks every CONTROL_INTERVAL samples of the timeline, and
+    // once more when an event lands between them
+    void setTarget(int index, float value);
+    void resetSmoothing(const ParamValues& values);
+    bool isGliding() const;
+    void controlTick();
+    bool glideMorph();
     
+    static float shapeDrive(int type, float x);
+    static void blendStage(float wet, const float* dry, float* buffer, int numSamples);
+
+    // Stages part-way between on and off are blended with their input
+    void saveDry(float wet, const float* left, const float* right, int numSamples);
+    void mixDry(float wet, float* left, float* right, int numSamples);
+
     DSPParams params_;
     int sampleRate_{48000};
+
+    Voice voices_[2];
+    int activeVoice_{0};
+
+    // Equal-power crossfade to the other voice, as a rotating (cos, sin) pair
+    int fadeRemaining_{0};
+    double fadeCos_{1.0};
+    double fadeSin_{0.0};
+    double fadeStepCos_{1.0};
+    double fadeStepSin_{0.0};
+
+    // Preset, morph and effect order hand-off: the UI keeps the blocks
+    // alive, the audio thread copies them. Publishing a preset drops a
+    // pending morph and the other way round.
+    std::shared_ptr<const ChainSettings> publishedHold_;
+    std::atomic<const ChainSettings*> published_{nullptr};
+    std::shared_ptr<const MorphSets> morphHold_;
+    std::atomic<const MorphSets*> morphPublished_{nullptr};
+    std::shared_ptr<const ExecutionPlan> planHold_;
+    std::atomic<const ExecutionPlan*> planPublished_{nullptr};
+    std::atomic<bool> adopting_{false};
+    EffectGraph graph_; // UI thread
+
+    // Timeline and smoothing (audio thread). Switches ramp their bypass
+    // value, which ChainSettings turns into a wet level; Linear values ramp
+    // linearly over SMOOTHING_MS, Logarithmic ones glide geometrically and
+    // modes jump on their sample.
+    ParamEventQueue events_;
+    int64_t samplePosition_{0};
+    int64_t lastTick_{-1};
+    std::atomic<int64_t> renderedPosition_{0};
+    bool snapParams_{true};
+    bool smoothing_{false};
+    bool compilePending_{false};
+    ParamValues knobValues_{}; // last parameters read from params_
+    ParamValues smoothedValues_{};
+    ParamValues targetValues_{};
+    std::array<float, static_cast<size_t>(ParamId::Count)> rampStep_{};
+    std::array<int, static_cast<size_t>(ParamId::Count)> rampTicks_{};
+
+    // Morph state (audio thread)
+    std::atomic<float> morphTarget_{0.0f};
+    bool morphing_{false};
+    ParamValues morphA_{};
+    ParamValues morphB_{};
+    float morphPosition_{0.0f};
+
+    // Odd while loadPreset() writes the parameters; the audio thread then
+    // keeps its current settings instead of reading a mix of old and new
+    std::atomic<uint32_t> writeSequence_{0};
     
-    // Gate state
-    float gateEnvelope_{0.0f};
-    
-    // EQ state (separate for L/R)
-    float lowZ1_[2]{}, lowZ2_[2]{};
-    float midZ1_[2]{}, midZ2_[2]{};
-    float highZ1_[2]{}, highZ2_[2]{};
-    float presenceZ1_[2]{}, presenceZ2_[2]{};
-    
-    // Compressor state
-    float compEnvelope_{0.0f};
-    
-    // Pitch shifter
-    std::unique_ptr<PitchShifter> pitchShifter_;
-    
-    // Delay buffers
-    std::vector<float> delayBufferL_;
-    std::vector<float> delayBufferR_;
-    int delayWritePos_{0};
-    float delayFeedbackL_{0.0f};
-    float delayFeedbackR_{0.0f};
-    
-    // Reverb (simple comb filters)
-    static const int NUM_COMBS = 8;
-    std::vector<float> combBuffersL_[NUM_COMBS];
-    std::vector<float> combBuffersR_[NUM_COMBS];
-    int combPositions_[NUM_COMBS]{};
     float combFeedback_[NUM_COMBS];
 
     // Low latency mode flag and reusable buffers to avoid per-callback allocations
     bool lowLatencyMode_{false};
     std::vector<float> workBuffer_;
     std::vector<float> monoTemp_;
+    std::vector<float> fadeLeft_;
+    std::vector<float> fadeRight_;
+    std::vector<float> dryLeft_;
+    std::vector<float> dryRight_;
+
+    // Parallel branch buses, and where each bus of the voice being
+    // processed lives (bus 0 is its output)
+    std::vector<float> branchLeft_[EffectGraph::MAX_BRANCHES - 1];
+    std::vector<float> branchRight_[EffectGraph::MAX_BRANCHES - 1];
+    float* busLeft_[EffectGraph::MAX_BRANCHES]{};
+    float* busRight_[EffectGraph::MAX_BRANCHES]{};
 };
 
-#endif // DSPCHAIN_H
\ No newline at end of file
+#endif // DSPCHAIN_H
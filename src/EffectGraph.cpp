@@ -0,0 +1,205 @@
+#include "EffectGraph.h"
+#include <cctype>
+#include <string>
+
+namespace {
+    const char* const DRY_NAME = "dry";
+
+    // Words and the symbols > | { } of the text form
+    std::vector<std::string> tokenize(const std::string& text)
+    {
+        std::vector<std::string> tokens;
+        std::string word;
+        for (char c : text) {
+            if (std::isalpha(static_cast<unsigned char>(c))) {
+                word += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                continue;
+            }
+            if (!word.empty()) {
+                tokens.push_back(word);
+                word.clear();
+            }
+            if (!std::isspace(static_cast<unsigned char>(c))) {
+                tokens.push_back(std::string(1, c));
+            }
+        }
+        if (!word.empty()) tokens.push_back(word);
+        return tokens;
+    }
+
+    void setError(std::string* error, const std::string& message)
+    {
+        if (error) *error = message;
+    }
+}
+
+const char* EffectGraph::name(EffectId id)
+{
+    static const char* const names[] = {
+        "gate", "drive", "eq", "comp", "pitch", "delay", "reverb"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(EffectId::Count),
+                  "effect name table out of sync with EffectId");
+    return names[static_cast<int>(id)];
+}
+
+bool EffectGraph::findByName(const std::string& name, EffectId& id)
+{
+    for (int i = 0; i < count(); ++i) {
+        if (name == EffectGraph::name(static_cast<EffectId>(i))) {
+            id = static_cast<EffectId>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+EffectGraph EffectGraph::standard()
+{
+    EffectGraph graph;
+    for (int i = 0; i < count(); ++i) {
+        graph.add(static_cast<EffectId>(i));
+    }
+    return graph;
+}
+
+void EffectGraph::add(EffectId id)
+{
+    steps.push_back(Step{ Branch{ id } });
+}
+
+bool EffectGraph::validate(std::string* error) const
+{
+    int uses[static_cast<int>(EffectId::Count)] = {};
+    for (const Step& step : steps) {
+        if (step.empty() || static_cast<int>(step.size()) > MAX_BRANCHES) {
+            setError(error, "A parallel group can have at most " + std::to_string(MAX_BRANCHES) + " branches");
+            return false;
+        }
+        bool hasEffect = false;
+        for (const Branch& branch : step) {
+            for (EffectId id : branch) {
+                if (id == EffectId::Count) {
+                    setError(error, "Unknown effect");
+                    return false;
+                }
+                if (++uses[static_cast<int>(id)] > 1) {
+                    setError(error, std::string("\"") + name(id) + "\" appears more than once");
+                    return false;
+                }
+                hasEffect = true;
+            }
+        }
+        if (!hasEffect) {
+            setError(error, "A parallel group needs at least one effect");
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string EffectGraph::toString() const
+{
+    auto branchText = [](const Branch& branch) {
+        if (branch.empty()) return std::string(DRY_NAME);
+        std::string text;
+        for (EffectId id : branch) {
+            if (!text.empty()) text += " > ";
+            text += name(id);
+        }
+        return text;
+    };
+
+    std::string text;
+    for (const Step& step : steps) {
+        if (!text.empty()) text += " > ";
+        if (step.size() == 1) {
+            text += branchText(step[0]);
+            continue;
+        }
+        text += "{";
+        for (size_t b = 0; b < step.size(); ++b) {
+            if (b > 0) text += " | ";
+            text += branchText(step[b]);
+        }
+        text += "}";
+    }
+    return text;
+}
+
+bool EffectGraph::parse(const std::string& text, EffectGraph& graph, std::string* error)
+{
+    const std::vector<std::string> tokens = tokenize(text);
+    size_t pos = 0;
+    auto peek = [&]() { return pos < tokens.size() ? tokens[pos] : std::string(); };
+
+    // effect ('>' effect)*, or "dry"; stops at '|' and '}'
+    auto parseBranch = [&](Branch& branch) {
+        if (peek() == DRY_NAME) {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            EffectId id;
+            if (!findByName(peek(), id)) {
+                setError(error, peek().empty() ? "Expected an effect name at the end"
+                                               : "Unknown effect \"" + peek() + "\"");
+                return false;
+            }
+            branch.push_back(id);
+            ++pos;
+            // A group or "dry" after '>' is the next step, not part of this branch
+            if (peek() != ">" || pos + 1 >= tokens.size() || tokens[pos + 1] == "{" || tokens[pos + 1] == DRY_NAME) {
+                return true;
+            }
+            ++pos;
+        }
+    };
+
+    EffectGraph parsed;
+    for (bool first = true; pos < tokens.size(); first = false) {
+        if (!first) {
+            if (peek() != ">") {
+                setError(error, "Expected \">\" before \"" + peek() + "\"");
+                return false;
+            }
+            ++pos;
+        }
+
+        Step step;
+        if (peek() == "{") {
+            ++pos;
+            while (true) {
+                Branch branch;
+                if (!parseBranch(branch)) return false;
+                step.push_back(branch);
+                if (peek() == "|") {
+                    ++pos;
+                } else if (peek() == "}") {
+                    ++pos;
+                    break;
+                } else {
+                    setError(error, "Expected \"|\" or \"}\" in a parallel group");
+                    return false;
+                }
+            }
+            if (step.size() > 1) {
+                parsed.steps.push_back(step);
+            } else {
+                for (EffectId id : step[0]) {
+                    parsed.add(id);
+                }
+            }
+        } else {
+            Branch branch;
+            if (!parseBranch(branch)) return false;
+            for (EffectId id : branch) {
+                parsed.add(id);
+            }
+        }
+    }
+
+    if (!parsed.validate(error)) return false;
+    graph = parsed;
+    return true;
+}
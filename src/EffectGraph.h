@@ -0,0 +1,52 @@
+#ifndef EFFECTGRAPH_H
+#define EFFECTGRAPH_H
+
+#include <string>
+#include <vector>
+
+// The effects of the chain, as nodes of an EffectGraph
+enum class EffectId {
+    Gate, Drive, EQ, Compressor, Pitch, Delay, Reverb,
+    Count
+};
+
+// Order of the effects: a series of steps, each one effect or parallel
+// branches that all receive the step's input and are averaged at its end.
+// Each effect appears at most once, a step holds at least one effect and
+// at most MAX_BRANCHES branches, and an effect left out doesn't run.
+// As text: "gate > comp > drive > {delay | reverb > eq | dry}", effects by
+// name separated by '>', parallel branches in braces separated by '|' and
+// "dry" for a branch with no effects.
+struct EffectGraph {
+    using Branch = std::vector<EffectId>;
+    using Step = std::vector<Branch>;
+
+    std::vector<Step> steps;
+
+    // Gate, drive, EQ, compressor, pitch, delay, reverb in series
+    static EffectGraph standard();
+
+    // Appends one effect in series
+    void add(EffectId id);
+
+    // False (with the reason in error) when the rules above are broken
+    bool validate(std::string* error = nullptr) const;
+    bool isValid() const { return validate(); }
+    bool operator==(const EffectGraph& other) const { return steps == other.steps; }
+    bool operator!=(const EffectGraph& other) const { return steps != other.steps; }
+
+    std::string toString() const;
+
+    // False on a syntax error or a graph breaking the rules above; error
+    // then says what is wrong and graph is left alone
+    static bool parse(const std::string& text, EffectGraph& graph, std::string* error = nullptr);
+
+    // Name used in the text form, e.g. "comp"
+    static const char* name(EffectId id);
+    static bool findByName(const std::string& name, EffectId& id);
+    static constexpr int count() { return static_cast<int>(EffectId::Count); }
+
+    static const int MAX_BRANCHES = 4;
+};
+
+#endif // EFFECTGRAPH_H
@@ -0,0 +1,750 @@
+#include "FlacEncoder.h"
+#include "WavReader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace {
+    constexpr int MAX_LPC_ORDER = 8;
+    constexpr int MAX_FIXED_ORDER = 4;
+    constexpr int LPC_PRECISION = 15;       // coefficient bits, sign included
+    constexpr int MAX_PARTITION_ORDER = 8;
+    constexpr int MAX_RICE_PARAM = 30;
+    constexpr int BATCH_BLOCKS_PER_THREAD = 4;
+    constexpr int32_t MAX_RESIDUAL = 1 << 30;
+
+    // MSB-first bit packer appending to a byte vector
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<unsigned char>& out) : out_(out) {}
+
+        void write(uint32_t value, int bits)
+        {
+            if (bits == 0) return;
+            const uint64_t masked = (bits == 32) ? value : (value & ((1u << bits) - 1));
+            acc_ = (acc_ << bits) | masked;
+            count_ += bits;
+            while (count_ >= 8) {
+                count_ -= 8;
+                out_.push_back(static_cast<unsigned char>(acc_ >> count_));
+            }
+            acc_ &= (1ull << count_) - 1;
+        }
+
+        void writeSigned(int32_t value, int bits) { write(static_cast<uint32_t>(value), bits); }
+
+        void writeRice(uint32_t value, int param)
+        {
+            uint32_t zeros = value >> param;
+            while (zeros >= 32) {
+                write(0, 32);
+                zeros -= 32;
+            }
+            write(1, static_cast<int>(zeros) + 1);
+            write(value, param);
+        }
+
+        void alignToByte()
+        {
+            if (count_ > 0) write(0, 8 - count_);
+        }
+
+    private:
+        std::vector<unsigned char>& out_;
+        uint64_t acc_{0};
+        int count_{0};
+    };
+
+    uint32_t zigzag(int32_t value)
+    {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    uint8_t crc8(const unsigned char* data, size_t length)
+    {
+        uint8_t crc = 0;
+        for (size_t i = 0; i < length; ++i) {
+            crc ^= data[i];
+            for (int b = 0; b < 8; ++b) {
+                crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    uint16_t crc16(const unsigned char* data, size_t length)
+    {
+        struct Table {
+            uint16_t values[256];
+            Table()
+            {
+                for (int i = 0; i < 256; ++i) {
+                    uint16_t c = static_cast<uint16_t>(i << 8);
+                    for (int b = 0; b < 8; ++b) {
+                        c = (c & 0x8000) ? static_cast<uint16_t>((c << 1) ^ 0x8005) : static_cast<uint16_t>(c << 1);
+                    }
+                    values[i] = c;
+                }
+            }
+        };
+        static const Table table;
+
+        uint16_t crc = 0;
+        for (size_t i = 0; i < length; ++i) {
+            crc = static_cast<uint16_t>((crc << 8) ^ table.values[((crc >> 8) ^ data[i]) & 0xFF]);
+        }
+        return crc;
+    }
+
+    int sampleRateCode(int sampleRate)
+    {
+        switch (sampleRate) {
+            case 88200: return 1;
+            case 176400: return 2;
+            case 192000: return 3;
+            case 8000: return 4;
+            case 16000: return 5;
+            case 22050: return 6;
+            case 24000: return 7;
+            case 32000: return 8;
+            case 44100: return 9;
+            case 48000: return 10;
+            case 96000: return 11;
+            default: return 0; // taken from STREAMINFO
+        }
+    }
+
+    struct RicePlan {
+        int partitionOrder{0};
+        bool wideParams{false};
+        int params[1 << MAX_PARTITION_ORDER]{};
+    };
+
+    struct SubframePlan {
+        enum Type { Constant, Verbatim, Fixed, Lpc };
+        Type type{Verbatim};
+        int order{0};
+        int shift{0};
+        int32_t coefs[MAX_LPC_ORDER]{};
+        std::vector<int32_t> residual;
+        RicePlan rice;
+        uint64_t bits{0};
+    };
+
+    // Cheapest Rice parameter for a partition, by the usual n*(k+1) + sum>>k estimate
+    int riceParam(uint64_t sum, uint32_t count, uint64_t& bits)
+    {
+        int k = 0;
+        const uint64_t mean = sum / count;
+        while (k < MAX_RICE_PARAM && (mean >> (k + 1)) > 0) ++k;
+
+        int best = k;
+        bits = UINT64_MAX;
+        for (int candidate = std::max(0, k - 1); candidate <= std::min(MAX_RICE_PARAM, k + 1); ++candidate) {
+            uint64_t cost = static_cast<uint64_t>(count) * (candidate + 1) + (sum >> candidate);
+            if (cost < bits) {
+                bits = cost;
+                best = candidate;
+            }
+        }
+        return best;
+    }
+
+    // Picks the partition order and per-partition parameters; returns the residual size in bits
+    uint64_t planRice(const int32_t* residual, int blockSize, int order, RicePlan& plan)
+    {
+        int maxOrder = 0;
+        while (maxOrder < MAX_PARTITION_ORDER
+               && blockSize % (2 << maxOrder) == 0
+               && (blockSize >> (maxOrder + 1)) > order) {
+            ++maxOrder;
+        }
+
+        uint64_t sums[1 << MAX_PARTITION_ORDER];
+        const int finest = 1 << maxOrder;
+        const int finestSize = blockSize >> maxOrder;
+        for (int p = 0; p < finest; ++p) {
+            uint64_t sum = 0;
+            for (int i = std::max(p * finestSize, order); i < (p + 1) * finestSize; ++i) {
+                sum += zigzag(residual[i]);
+            }
+            sums[p] = sum;
+        }
+
+        uint64_t bestBits = UINT64_MAX;
+        for (int po = maxOrder; po >= 0; --po) {
+            const int parts = 1 << po;
+            const uint32_t partSize = static_cast<uint32_t>(blockSize >> po);
+            int params[1 << MAX_PARTITION_ORDER];
+            bool wide = false;
+            uint64_t total = 6; // method + partition order
+            for (int p = 0; p < parts; ++p) {
+                uint64_t bits;
+                const uint32_t count = partSize - (p == 0 ? order : 0);
+                params[p] = riceParam(sums[p], count, bits);
+                wide = wide || params[p] > 14;
+                total += bits;
+            }
+            total += static_cast<uint64_t>(parts) * (wide ? 5 : 4);
+
+            if (total < bestBits) {
+                bestBits = total;
+                plan.partitionOrder = po;
+                plan.wideParams = wide;
+                std::copy(params, params + parts, plan.params);
+            }
+
+            // Merge neighbouring partitions for the next coarser order
+            for (int p = 0; p < parts / 2; ++p) {
+                sums[p] = sums[2 * p] + sums[2 * p + 1];
+            }
+        }
+        return bestBits;
+    }
+
+    void planFixed(const int32_t* x, int n, int bps, SubframePlan& plan)
+    {
+        // Pick the order with the smallest absolute residual sum, then code it exactly
+        uint64_t error[MAX_FIXED_ORDER + 1] = {};
+        for (int i = MAX_FIXED_ORDER; i < n; ++i) {
+            int64_t e0 = x[i];
+            int64_t e1 = e0 - x[i - 1];
+            int64_t e2 = e1 - (static_cast<int64_t>(x[i - 1]) - x[i - 2]);
+            int64_t e3 = e2 - (static_cast<int64_t>(x[i - 1]) - 2 * static_cast<int64_t>(x[i - 2]) + x[i - 3]);
+            int64_t e4 = e3 - (static_cast<int64_t>(x[i - 1]) - 3 * static_cast<int64_t>(x[i - 2])
+                               + 3 * static_cast<int64_t>(x[i - 3]) - x[i - 4]);
+            error[0] += static_cast<uint64_t>(std::llabs(e0));
+            error[1] += static_cast<uint64_t>(std::llabs(e1));
+            error[2] += static_cast<uint64_t>(std::llabs(e2));
+            error[3] += static_cast<uint64_t>(std::llabs(e3));
+            error[4] += static_cast<uint64_t>(std::llabs(e4));
+        }
+        int order = 0;
+        const int maxOrder = std::min(MAX_FIXED_ORDER, n - 1);
+        for (int o = 1; o <= maxOrder; ++o) {
+            if (error[o] < error[order]) order = o;
+        }
+
+        plan.type = SubframePlan::Fixed;
+        plan.order = order;
+        plan.residual.assign(n, 0);
+        for (int i = order; i < n; ++i) {
+            int64_t r;
+            switch (order) {
+                case 0: r = x[i]; break;
+                case 1: r = static_cast<int64_t>(x[i]) - x[i - 1]; break;
+                case 2: r = static_cast<int64_t>(x[i]) - 2 * static_cast<int64_t>(x[i - 1]) + x[i - 2]; break;
+                case 3: r = static_cast<int64_t>(x[i]) - 3 * static_cast<int64_t>(x[i - 1])
+                            + 3 * static_cast<int64_t>(x[i - 2]) - x[i - 3]; break;
+                default: r = static_cast<int64_t>(x[i]) - 4 * static_cast<int64_t>(x[i - 1])
+                             + 6 * static_cast<int64_t>(x[i - 2]) - 4 * static_cast<int64_t>(x[i - 3]) + x[i - 4]; break;
+            }
+            plan.residual[i] = static_cast<int32_t>(r);
+        }
+        plan.bits = 8 + static_cast<uint64_t>(order) * bps + planRice(plan.residual.data(), n, order, plan.rice);
+    }
+
+    bool planLpc(const int32_t* x, int n, int bps, int order, SubframePlan& plan)
+    {
+        if (n <= order * 2) return false;
+
+        // Welch-windowed autocorrelation
+        std::vector<double> windowed(n);
+        const double half = (n - 1) * 0.5;
+        for (int i = 0; i < n; ++i) {
+            double t = (i - half) / half;
+            windowed[i] = x[i] * (1.0 - t * t);
+        }
+        double autoc[MAX_LPC_ORDER + 1];
+        for (int lag = 0; lag <= order; ++lag) {
+            double sum = 0.0;
+            for (int i = lag; i < n; ++i) {
+                sum += windowed[i] * windowed[i - lag];
+            }
+            autoc[lag] = sum;
+        }
+        if (autoc[0] <= 0.0) return false;
+
+        // Levinson-Durbin recursion
+        double lpc[MAX_LPC_ORDER] = {};
+        double err = autoc[0];
+        for (int i = 0; i < order; ++i) {
+            double acc = autoc[i + 1];
+            for (int j = 0; j < i; ++j) {
+                acc -= lpc[j] * autoc[i - j];
+            }
+            const double k = acc / err;
+            double previous[MAX_LPC_ORDER];
+            std::copy(lpc, lpc + i, previous);
+            lpc[i] = k;
+            for (int j = 0; j < i; ++j) {
+                lpc[j] = previous[j] - k * previous[i - 1 - j];
+            }
+            err *= (1.0 - k * k);
+            if (err <= 0.0) return false;
+        }
+
+        // Quantise with error feedback
+        double cmax = 0.0;
+        for (int j = 0; j < order; ++j) cmax = std::max(cmax, std::fabs(lpc[j]));
+        if (cmax <= 0.0) return false;
+        int log2cmax;
+        std::frexp(cmax, &log2cmax);
+        const int precision = LPC_PRECISION - 1;
+        const int shift = std::min(15, precision - log2cmax);
+        if (shift < 0) return false;
+
+        const int32_t qmax = (1 << precision) - 1;
+        const int32_t qmin = -(1 << precision);
+        double carry = 0.0;
+        for (int j = 0; j < order; ++j) {
+            double v = lpc[j] * (1 << shift) + carry;
+            int32_t q = static_cast<int32_t>(std::lround(v));
+            q = std::max(qmin, std::min(qmax, q));
+            carry = v - q;
+            plan.coefs[j] = q;
+        }
+
+        plan.type = SubframePlan::Lpc;
+        plan.order = order;
+        plan.shift = shift;
+        plan.residual.assign(n, 0);
+        for (int i = order; i < n; ++i) {
+            int64_t sum = 0;
+            for (int j = 0; j < order; ++j) {
+                sum += static_cast<int64_t>(plan.coefs[j]) * x[i - 1 - j];
+            }
+            int64_t r = x[i] - (sum >> shift);
+            if (r >= MAX_RESIDUAL || r <= -MAX_RESIDUAL) return false;
+            plan.residual[i] = static_cast<int32_t>(r);
+        }
+        plan.bits = 8 + static_cast<uint64_t>(order) * bps + 4 + 5
+                  + static_cast<uint64_t>(order) * LPC_PRECISION
+                  + planRice(plan.residual.data(), n, order, plan.rice);
+        return true;
+    }
+
+    void planSubframe(const int32_t* x, int n, int bps, SubframePlan& plan)
+    {
+        plan.type = SubframePlan::Verbatim;
+        plan.bits = 8 + static_cast<uint64_t>(n) * bps;
+
+        if (std::all_of(x, x + n, [x](int32_t v) { return v == x[0]; })) {
+            plan.type = SubframePlan::Constant;
+            plan.bits = 8 + bps;
+            return;
+        }
+
+        SubframePlan candidate;
+        planFixed(x, n, bps, candidate);
+        if (candidate.bits < plan.bits) std::swap(plan, candidate);
+
+        if (planLpc(x, n, bps, MAX_LPC_ORDER, candidate) && candidate.bits < plan.bits) {
+            std::swap(plan, candidate);
+        }
+    }
+
+    void writeResidual(BitWriter& bits, const SubframePlan& plan, int n)
+    {
+        const RicePlan& rice = plan.rice;
+        bits.write(rice.wideParams ? 1 : 0, 2);
+        bits.write(static_cast<uint32_t>(rice.partitionOrder), 4);
+
+        const int parts = 1 << rice.partitionOrder;
+        const int partSize = n >> rice.partitionOrder;
+        int i = plan.order;
+        for (int p = 0; p < parts; ++p) {
+            const int k = rice.params[p];
+            bits.write(static_cast<uint32_t>(k), rice.wideParams ? 5 : 4);
+            for (const int end = (p + 1) * partSize; i < end; ++i) {
+                bits.writeRice(zigzag(plan.residual[i]), k);
+            }
+        }
+    }
+
+    void writeSubframe(BitWriter& bits, const int32_t* x, int n, int bps, const SubframePlan& plan)
+    {
+        bits.write(0, 1);
+        switch (plan.type) {
+            case SubframePlan::Constant:
+                bits.write(0x00, 6);
+                bits.write(0, 1);
+                bits.writeSigned(x[0], bps);
+                break;
+            case SubframePlan::Verbatim:
+                bits.write(0x01, 6);
+                bits.write(0, 1);
+                for (int i = 0; i < n; ++i) bits.writeSigned(x[i], bps);
+                break;
+            case SubframePlan::Fixed:
+                bits.write(0x08 | static_cast<uint32_t>(plan.order), 6);
+                bits.write(0, 1);
+                for (int i = 0; i < plan.order; ++i) bits.writeSigned(x[i], bps);
+                writeResidual(bits, plan, n);
+                break;
+            case SubframePlan::Lpc:
+                bits.write(0x20 | static_cast<uint32_t>(plan.order - 1), 6);
+                bits.write(0, 1);
+                for (int i = 0; i < plan.order; ++i) bits.writeSigned(x[i], bps);
+                bits.write(LPC_PRECISION - 1, 4);
+                bits.writeSigned(plan.shift, 5);
+                for (int j = 0; j < plan.order; ++j) bits.writeSigned(plan.coefs[j], LPC_PRECISION);
+                writeResidual(bits, plan, n);
+                break;
+        }
+    }
+
+    void appendFrameNumber(std::vector<unsigned char>& out, uint64_t value)
+    {
+        // UTF-8 style variable-length coding
+        if (value < 0x80) {
+            out.push_back(static_cast<unsigned char>(value));
+            return;
+        }
+        int extra = 1;
+        while (extra < 6 && value >= (1ull << (5 * extra + 6))) ++extra;
+        const unsigned char lead = static_cast<unsigned char>(0xFF00 >> (extra + 1));
+        out.push_back(static_cast<unsigned char>(lead | (value >> (6 * extra))));
+        for (int i = extra - 1; i >= 0; --i) {
+            out.push_back(static_cast<unsigned char>(0x80 | ((value >> (6 * i)) & 0x3F)));
+        }
+    }
+}
+
+FlacEncoder::~FlacEncoder()
+{
+    close();
+}
+
+void FlacEncoder::setFormat(SampleFormat format)
+{
+    // FLAC is integer-only; float input is stored as 24-bit
+    converter_.setFormat(format == SampleFormat::Pcm16 ? SampleFormat::Pcm16 : SampleFormat::Pcm24);
+}
+
+void FlacEncoder::setNumThreads(int numThreads)
+{
+    const int hardware = std::max(1u, std::thread::hardware_concurrency());
+    numThreads_ = std::max(1, std::min(numThreads, hardware));
+}
+
+bool FlacEncoder::open(const std::string& filepath, int sampleRate, int numChannels)
+{
+    close();
+
+    file_.open(filepath, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    path_ = filepath;
+    sampleRate_ = sampleRate;
+    numChannels_ = numChannels;
+    bitsPerSample_ = converter_.getBytesPerSample() * 8;
+    framesWritten_ = 0;
+    framesEncoded_ = 0;
+    blocksWritten_ = 0;
+    minFrameBytes_ = 0;
+    maxFrameBytes_ = 0;
+
+    const int batchFrames = BLOCK_SIZE * BATCH_BLOCKS_PER_THREAD * numThreads_;
+    pending_.assign(numChannels_, std::vector<int32_t>(batchFrames));
+    pendingFrames_ = 0;
+
+    // Marker plus a single (last) STREAMINFO block
+    file_.write("fLaC", 4);
+    const unsigned char blockHeader[4] = { 0x80, 0x00, 0x00, 34 };
+    file_.write(reinterpret_cast<const char*>(blockHeader), 4);
+    writeStreamInfo();
+    return file_.good();
+}
+
+void FlacEncoder::writeStreamInfo()
+{
+    std::vector<unsigned char> info;
+    BitWriter bits(info);
+    bits.write(BLOCK_SIZE, 16);
+    bits.write(BLOCK_SIZE, 16);
+    bits.write(minFrameBytes_, 24);
+    bits.write(maxFrameBytes_, 24);
+    bits.write(static_cast<uint32_t>(sampleRate_), 20);
+    bits.write(static_cast<uint32_t>(numChannels_ - 1), 3);
+    bits.write(static_cast<uint32_t>(bitsPerSample_ - 1), 5);
+    bits.write(static_cast<uint32_t>(framesEncoded_ >> 32), 4);
+    bits.write(static_cast<uint32_t>(framesEncoded_), 32);
+    for (int i = 0; i < 4; ++i) bits.write(0, 32); // MD5 not computed
+    file_.write(reinterpret_cast<const char*>(info.data()), static_cast<std::streamsize>(info.size()));
+}
+
+bool FlacEncoder::write(const float* const* channels, int numFrames)
+{
+    if (!file_.is_open() || numFrames <= 0) {
+        return false;
+    }
+
+    const int capacity = static_cast<int>(pending_[0].size());
+    std::vector<const float*> input(numChannels_);
+    std::vector<int32_t*> output(numChannels_);
+    int done = 0;
+    while (done < numFrames) {
+        const int count = std::min(numFrames - done, capacity - pendingFrames_);
+        for (int ch = 0; ch < numChannels_; ++ch) {
+            input[ch] = channels[ch] + done;
+            output[ch] = pending_[ch].data() + pendingFrames_;
+        }
+        converter_.convertToInt(input.data(), numChannels_, count, output.data());
+        pendingFrames_ += count;
+        done += count;
+        if (pendingFrames_ == capacity && !flushBlocks(false)) {
+            return false;
+        }
+    }
+    framesWritten_ += numFrames;
+    return file_.good();
+}
+
+bool FlacEncoder::writeInt(const int32_t* const* channels, int numFrames)
+{
+    if (!file_.is_open() || numFrames <= 0) {
+        return false;
+    }
+
+    const int capacity = static_cast<int>(pending_[0].size());
+    int done = 0;
+    while (done < numFrames) {
+        const int count = std::min(numFrames - done, capacity - pendingFrames_);
+        for (int ch = 0; ch < numChannels_; ++ch) {
+            std::memcpy(pending_[ch].data() + pendingFrames_, channels[ch] + done, count * sizeof(int32_t));
+        }
+        pendingFrames_ += count;
+        done += count;
+        if (pendingFrames_ == capacity && !flushBlocks(false)) {
+            return false;
+        }
+    }
+    framesWritten_ += numFrames;
+    return file_.good();
+}
+
+bool FlacEncoder::flushBlocks(bool includePartial)
+{
+    const int fullBlocks = pendingFrames_ / BLOCK_SIZE;
+    const int tail = pendingFrames_ % BLOCK_SIZE;
+    const int numBlocks = fullBlocks + ((includePartial && tail > 0) ? 1 : 0);
+    if (numBlocks == 0) {
+        return true;
+    }
+
+    encoded_.resize(numBlocks);
+    auto encodeRange = [this, numBlocks](int first, int step) {
+        std::vector<const int32_t*> block(numChannels_);
+        for (int b = first; b < numBlocks; b += step) {
+            for (int ch = 0; ch < numChannels_; ++ch) {
+                block[ch] = pending_[ch].data() + static_cast<size_t>(b) * BLOCK_SIZE;
+            }
+            const int size = std::min(BLOCK_SIZE, pendingFrames_ - b * BLOCK_SIZE);
+            encodeBlock(block.data(), size, blocksWritten_ + b, encoded_[b]);
+        }
+    };
+
+    const int workers = std::min(numThreads_, numBlocks);
+    if (workers > 1) {
+        std::vector<std::thread> threads;
+        for (int t = 1; t < workers; ++t) {
+            threads.emplace_back(encodeRange, t, workers);
+        }
+        encodeRange(0, workers);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    } else {
+        encodeRange(0, 1);
+    }
+
+    for (int b = 0; b < numBlocks; ++b) {
+        const uint32_t bytes = static_cast<uint32_t>(encoded_[b].size());
+        file_.write(reinterpret_cast<const char*>(encoded_[b].data()), bytes);
+        minFrameBytes_ = (minFrameBytes_ == 0) ? bytes : std::min(minFrameBytes_, bytes);
+        maxFrameBytes_ = std::max(maxFrameBytes_, bytes);
+    }
+
+    // Only the final flush may leave a short block, so nothing is carried over
+    const int consumed = std::min(pendingFrames_, numBlocks * BLOCK_SIZE);
+    blocksWritten_ += numBlocks;
+    framesEncoded_ += consumed;
+    pendingFrames_ -= consumed;
+    return file_.good();
+}
+
+void FlacEncoder::encodeBlock(const int32_t* const* channels, int blockSize, uint64_t frameNumber,
+                              std::vector<unsigned char>& out) const
+{
+    const int bps = bitsPerSample_;
+    int assignment = numChannels_ - 1;
+
+    // Up to four candidate signals: L, R, mid, side (side needs one extra bit)
+    std::vector<SubframePlan> plans(numChannels_);
+    for (int ch = 0; ch < numChannels_; ++ch) {
+        planSubframe(channels[ch], blockSize, bps, plans[ch]);
+    }
+
+    const int32_t* sources[2] = { channels[0], numChannels_ > 1 ? channels[1] : nullptr };
+    int sourceBps[2] = { bps, bps };
+    std::vector<int32_t> mid, side;
+    SubframePlan midPlan, sidePlan;
+    if (numChannels_ == 2) {
+        mid.resize(blockSize);
+        side.resize(blockSize);
+        for (int i = 0; i < blockSize; ++i) {
+            const int32_t l = channels[0][i];
+            const int32_t r = channels[1][i];
+            mid[i] = (l + r) >> 1;
+            side[i] = l - r;
+        }
+        planSubframe(mid.data(), blockSize, bps, midPlan);
+        planSubframe(side.data(), blockSize, bps + 1, sidePlan);
+
+        const uint64_t independent = plans[0].bits + plans[1].bits;
+        const uint64_t leftSide = plans[0].bits + sidePlan.bits;
+        const uint64_t sideRight = sidePlan.bits + plans[1].bits;
+        const uint64_t midSide = midPlan.bits + sidePlan.bits;
+        const uint64_t best = std::min({ independent, leftSide, sideRight, midSide });
+
+        if (best == midSide) {
+            assignment = 10;
+            sources[0] = mid.data();
+            sources[1] = side.data();
+            sourceBps[1] = bps + 1;
+            std::swap(plans[0], midPlan);
+            std::swap(plans[1], sidePlan);
+        } else if (best == leftSide) {
+            assignment = 8;
+            sources[1] = side.data();
+            sourceBps[1] = bps + 1;
+            std::swap(plans[1], sidePlan);
+        } else if (best == sideRight) {
+            assignment = 9;
+            sources[0] = side.data();
+            sourceBps[0] = bps + 1;
+            std::swap(plans[0], sidePlan);
+        }
+    }
+
+    // Frame header
+    out.clear();
+    const int rateCode = sampleRateCode(sampleRate_);
+    const int sizeCode = (blockSize == BLOCK_SIZE) ? 12 : 7; // 4096, or explicit 16-bit size
+    out.push_back(0xFF);
+    out.push_back(0xF8); // sync, fixed block size
+    out.push_back(static_cast<unsigned char>((sizeCode << 4) | rateCode));
+    out.push_back(static_cast<unsigned char>((assignment << 4) | ((bps == 16 ? 4 : 6) << 1)));
+    appendFrameNumber(out, frameNumber);
+    if (sizeCode == 7) {
+        out.push_back(static_cast<unsigned char>((blockSize - 1) >> 8));
+        out.push_back(static_cast<unsigned char>((blockSize - 1) & 0xFF));
+    }
+    out.push_back(crc8(out.data(), out.size()));
+
+    BitWriter bits(out);
+    for (int ch = 0; ch < numChannels_; ++ch) {
+        const int32_t* source = (ch < 2) ? sources[ch] : channels[ch];
+        const int sourceBits = (ch < 2) ? sourceBps[ch] : bps;
+        writeSubframe(bits, source, blockSize, sourceBits, plans[ch]);
+    }
+    bits.alignToByte();
+
+    const uint16_t crc = crc16(out.data(), out.size());
+    out.push_back(static_cast<unsigned char>(crc >> 8));
+    out.push_back(static_cast<unsigned char>(crc & 0xFF));
+}
+
+bool FlacEncoder::updateHeader()
+{
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    std::streampos end = file_.tellp();
+    file_.seekp(8);
+    writeStreamInfo();
+    file_.seekp(end);
+    file_.flush();
+    return file_.good();
+}
+
+bool FlacEncoder::close()
+{
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    bool ok = flushBlocks(true);
+    ok = updateHeader() && ok;
+    file_.close();
+    pending_.clear();
+    encoded_.clear();
+    return ok;
+}
+
+bool FlacEncoder::encodeWavFile(const std::string& wavPath, const std::string& flacPath, int numThreads)
+{
+    WavReader reader;
+    if (!reader.open(wavPath)) {
+        return false;
+    }
+
+    const int bits = reader.getBitsPerSample();
+    const bool integer16 = !reader.isFloat() && bits <= 16;
+    const bool integer24 = !reader.isFloat() && bits == 24;
+
+    FlacEncoder encoder;
+    encoder.setFormat(integer16 ? SampleFormat::Pcm16 : SampleFormat::Pcm24);
+    encoder.setNumThreads(numThreads);
+    if (!encoder.open(flacPath, reader.getSampleRate(), reader.getNumChannels())) {
+        return false;
+    }
+
+    const int numChannels = reader.getNumChannels();
+    const int chunk = BLOCK_SIZE * BATCH_BLOCKS_PER_THREAD * encoder.numThreads_;
+    std::vector<std::vector<int32_t>> ints(numChannels, std::vector<int32_t>(chunk));
+    std::vector<std::vector<float>> floats;
+    std::vector<int32_t*> intPtrs(numChannels);
+    std::vector<float*> floatPtrs(numChannels);
+    for (int ch = 0; ch < numChannels; ++ch) {
+        intPtrs[ch] = ints[ch].data();
+    }
+    if (!integer16 && !integer24) {
+        floats.assign(numChannels, std::vector<float>(chunk));
+        for (int ch = 0; ch < numChannels; ++ch) {
+            floatPtrs[ch] = floats[ch].data();
+        }
+    }
+
+    bool ok = true;
+    for (uint64_t frame = 0; ok && frame < reader.getNumFrames(); ) {
+        int frames;
+        if (integer16 || integer24) {
+            frames = reader.readInt(frame, intPtrs.data(), numChannels, chunk);
+            if (bits == 8) {
+                for (int ch = 0; ch < numChannels; ++ch) {
+                    for (int i = 0; i < frames; ++i) ints[ch][i] *= 256; // 8-bit stored as 16
+                }
+            }
+            ok = encoder.writeInt(intPtrs.data(), frames);
+        } else {
+            frames = reader.read(frame, floatPtrs.data(), numChannels, chunk);
+            ok = encoder.write(floatPtrs.data(), frames);
+        }
+        if (frames <= 0) break;
+        frame += frames;
+    }
+
+    ok = encoder.close() && ok;
+    if (!ok) {
+        std::remove(flacPath.c_str());
+    }
+    return ok;
+}
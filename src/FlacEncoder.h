@@ -0,0 +1,71 @@
+#ifndef FLACENCODER_H
+#define FLACENCODER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "PcmConverter.h"
+
+// Streaming FLAC encoder (16 or 24-bit, fixed 4096-frame blocks). Each block
+// picks the cheapest of the fixed predictors and a quantised LPC fit, with
+// stereo decorrelation and partitioned Rice coding of the residual.
+// Audio is appended in blocks like WavWriter, and updateHeader() refreshes
+// STREAMINFO so an interrupted take is still decodable.
+class FlacEncoder {
+public:
+    FlacEncoder() = default;
+    ~FlacEncoder();
+
+    // Format (Pcm16 or Pcm24) and dither apply to the next open()
+    void setFormat(SampleFormat format);
+    void setDither(bool enabled) { converter_.setDither(enabled); }
+    void setGain(float gain) { converter_.setGain(gain); }
+
+    // Blocks are independent, so batches can be encoded on several threads.
+    // The recorder keeps the default of 1 on its writer thread.
+    void setNumThreads(int numThreads);
+
+    bool open(const std::string& filepath, int sampleRate, int numChannels);
+    bool write(const float* const* channels, int numFrames);
+    bool writeInt(const int32_t* const* channels, int numFrames);
+    bool updateHeader();
+    bool close();
+
+    bool isOpen() const { return file_.is_open(); }
+    uint64_t getFramesWritten() const { return framesWritten_; }
+    const std::string& getPath() const { return path_; }
+
+    // Export of an existing WAV clip: 8/16/24-bit sources are copied bit-exact,
+    // 32-bit and float sources are stored as 24-bit. Blocks use numThreads.
+    static bool encodeWavFile(const std::string& wavPath, const std::string& flacPath, int numThreads);
+
+    static const int BLOCK_SIZE = 4096;
+
+private:
+    bool flushBlocks(bool includePartial);
+    void encodeBlock(const int32_t* const* channels, int blockSize, uint64_t frameNumber,
+                     std::vector<unsigned char>& out) const;
+    void writeStreamInfo();
+
+    std::ofstream file_;
+    std::string path_;
+    int sampleRate_{48000};
+    int numChannels_{2};
+    int bitsPerSample_{24};
+    int numThreads_{1};
+    uint64_t framesWritten_{0};
+    uint64_t framesEncoded_{0};
+    uint64_t blocksWritten_{0};
+    uint32_t minFrameBytes_{0};
+    uint32_t maxFrameBytes_{0};
+
+    PcmConverter converter_;
+
+    // Planar integer samples waiting to fill a batch of blocks
+    std::vector<std::vector<int32_t>> pending_;
+    int pendingFrames_{0};
+    std::vector<std::vector<unsigned char>> encoded_;
+};
+
+#endif // FLACENCODER_H
@@ -0,0 +1,647 @@
+#include "FlacReader.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    constexpr size_t END_SCAN_BYTES = 4u << 20; // how far back open() looks for the last intact frame
+    constexpr int BISECT_BLOCKS = 2;            // farther than this from a known frame, probe instead of walking
+    constexpr int MAX_BISECTIONS = 64;
+    constexpr int MAX_LPC_ORDER = 32;
+    constexpr int MAX_BITS_PER_SAMPLE = 24; // keeps the side channel and predictions in 32 bits
+
+    // MSB-first bit reader over a byte range. Reads past the end return
+    // zeros and set overrun(), so callers check once per subframe.
+    class BitReader {
+    public:
+        BitReader(const unsigned char* data, size_t size) : data_(data), size_(size) {}
+
+        uint32_t read(int bits)
+        {
+            if (bits == 0) return 0;
+            if (count_ < bits) refill();
+            if (count_ < bits) {
+                overrun_ = true;
+                return 0;
+            }
+            const uint32_t value = static_cast<uint32_t>(acc_ >> (64 - bits));
+            acc_ <<= bits;
+            count_ -= bits;
+            return value;
+        }
+
+        int32_t readSigned(int bits)
+        {
+            if (bits == 0) return 0;
+            const uint32_t sign = 1u << (bits - 1);
+            return static_cast<int32_t>((read(bits) ^ sign) - sign);
+        }
+
+        // Number of 0 bits before the next 1
+        uint32_t readUnary()
+        {
+            uint32_t zeros = 0;
+            while (true) {
+                if (count_ == 0) refill();
+                if (count_ == 0) {
+                    overrun_ = true;
+                    return 0;
+                }
+                if (acc_ == 0) {
+                    zeros += static_cast<uint32_t>(count_);
+                    count_ = 0;
+                    continue;
+                }
+                while ((acc_ & (1ull << 63)) == 0) {
+                    acc_ <<= 1;
+                    --count_;
+                    ++zeros;
+                }
+                acc_ <<= 1;
+                --count_;
+                return zeros;
+            }
+        }
+
+        void alignToByte()
+        {
+            const int drop = count_ % 8;
+            acc_ <<= drop;
+            count_ -= drop;
+        }
+
+        // Bytes consumed so far; only meaningful when byte aligned
+        size_t bytePosition() const { return pos_ - static_cast<size_t>(count_ / 8); }
+        bool overrun() const { return overrun_; }
+
+    private:
+        void refill()
+        {
+            while (count_ <= 56 && pos_ < size_) {
+                acc_ |= static_cast<uint64_t>(data_[pos_++]) << (56 - count_);
+                count_ += 8;
+            }
+        }
+
+        const unsigned char* data_;
+        size_t size_;
+        size_t pos_{0};
+        uint64_t acc_{0};
+        int count_{0};
+        bool overrun_{false};
+    };
+
+    uint8_t crc8(const unsigned char* data, size_t length)
+    {
+        uint8_t crc = 0;
+        for (size_t i = 0; i < length; ++i) {
+            crc ^= data[i];
+            for (int b = 0; b < 8; ++b) {
+                crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    uint16_t crc16(const unsigned char* data, size_t length)
+    {
+        struct Table {
+            uint16_t values[256];
+            Table()
+            {
+                for (int i = 0; i < 256; ++i) {
+                    uint16_t c = static_cast<uint16_t>(i << 8);
+                    for (int b = 0; b < 8; ++b) {
+                        c = (c & 0x8000) ? static_cast<uint16_t>((c << 1) ^ 0x8005) : static_cast<uint16_t>(c << 1);
+                    }
+                    values[i] = c;
+                }
+            }
+        };
+        static const Table table;
+
+        uint16_t crc = 0;
+        for (size_t i = 0; i < length; ++i) {
+            crc = static_cast<uint16_t>((crc << 8) ^ table.values[((crc >> 8) ^ data[i]) & 0xFF]);
+        }
+        return crc;
+    }
+
+    // Partitioned Rice residual into out[order, n)
+    bool decodeResidual(BitReader& bits, int32_t* out, int n, int order)
+    {
+        const uint32_t method = bits.read(2);
+        if (method > 1) return false;
+        const int paramBits = (method == 0) ? 4 : 5;
+        const uint32_t escape = (method == 0) ? 15 : 31;
+
+        const int partitionOrder = static_cast<int>(bits.read(4));
+        const int partSize = n >> partitionOrder;
+        if ((partSize << partitionOrder) != n || partSize < order) return false;
+
+        int i = order;
+        for (int p = 0; p < (1 << partitionOrder); ++p) {
+            const uint32_t k = bits.read(paramBits);
+            const int end = (p + 1) * partSize;
+            if (k == escape) {
+                const int raw = static_cast<int>(bits.read(5));
+                for (; i < end; ++i) out[i] = bits.readSigned(raw);
+            } else {
+                for (; i < end; ++i) {
+                    const uint32_t value = (bits.readUnary() << k) | bits.read(static_cast<int>(k));
+                    out[i] = static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+                }
+            }
+            if (bits.overrun()) return false;
+        }
+        return true;
+    }
+
+    void restoreFixed(int32_t* x, int n, int order)
+    {
+        for (int i = order; i < n; ++i) {
+            int64_t prediction;
+            switch (order) {
+                case 0: prediction = 0; break;
+                case 1: prediction = x[i - 1]; break;
+                case 2: prediction = 2 * static_cast<int64_t>(x[i - 1]) - x[i - 2]; break;
+                case 3: prediction = 3 * static_cast<int64_t>(x[i - 1]) - 3 * static_cast<int64_t>(x[i - 2]) + x[i - 3]; break;
+                default: prediction = 4 * static_cast<int64_t>(x[i - 1]) - 6 * static_cast<int64_t>(x[i - 2])
+                                      + 4 * static_cast<int64_t>(x[i - 3]) - x[i - 4]; break;
+            }
+            x[i] = static_cast<int32_t>(x[i] + prediction);
+        }
+    }
+
+    void restoreLpc(int32_t* x, int n, const int32_t* coefs, int order, int shift)
+    {
+        for (int i = order; i < n; ++i) {
+            int64_t sum = 0;
+            for (int j = 0; j < order; ++j) {
+                sum += static_cast<int64_t>(coefs[j]) * x[i - 1 - j];
+            }
+            x[i] = static_cast<int32_t>(x[i] + (sum >> shift));
+        }
+    }
+
+    bool decodeSubframe(BitReader& bits, int bps, int32_t* out, int n)
+    {
+        if (bits.read(1) != 0) return false;
+        const uint32_t type = bits.read(6);
+        int wasted = 0;
+        if (bits.read(1) != 0) {
+            wasted = static_cast<int>(bits.readUnary()) + 1;
+            if (wasted >= bps) return false;
+            bps -= wasted;
+        }
+
+        if (type == 0) {
+            std::fill(out, out + n, bits.readSigned(bps));
+        } else if (type == 1) {
+            for (int i = 0; i < n; ++i) out[i] = bits.readSigned(bps);
+        } else if (type >= 8 && type <= 12) {
+            const int order = static_cast<int>(type - 8);
+            if (order > n) return false;
+            for (int i = 0; i < order; ++i) out[i] = bits.readSigned(bps);
+            if (!decodeResidual(bits, out, n, order)) return false;
+            restoreFixed(out, n, order);
+        } else if (type >= 32) {
+            const int order = static_cast<int>(type & 31) + 1;
+            if (order > n) return false;
+            for (int i = 0; i < order; ++i) out[i] = bits.readSigned(bps);
+            const int precision = static_cast<int>(bits.read(4)) + 1;
+            const int shift = bits.readSigned(5);
+            if (precision == 16 || shift < 0) return false;
+            int32_t coefs[MAX_LPC_ORDER];
+            for (int j = 0; j < order; ++j) coefs[j] = bits.readSigned(precision);
+            if (!decodeResidual(bits, out, n, order)) return false;
+            restoreLpc(out, n, coefs, order, shift);
+        } else {
+            return false;
+        }
+
+        if (wasted > 0) {
+            for (int i = 0; i < n; ++i) out[i] = static_cast<int32_t>(static_cast<uint32_t>(out[i]) << wasted);
+        }
+        return !bits.overrun();
+    }
+
+    struct FrameHeader {
+        uint64_t number;     // frame number, or first sample when block sizes vary
+        bool variable;
+        int blockSize;
+        uint32_t assignment;
+        int channels;
+        int depth;           // 0: as STREAMINFO
+    };
+
+    // Frame header through its CRC-8; returns the header length, or 0 if this is not one
+    size_t parseFrameHeader(const unsigned char* data, size_t size, FrameHeader& header)
+    {
+        static const int depths[8] = { 0, 8, 12, -1, 16, 20, 24, -1 };
+
+        BitReader bits(data, size);
+        if (bits.read(15) != 0x7FFC) return 0; // sync code and reserved bit
+        header.variable = bits.read(1) != 0;
+        const uint32_t sizeCode = bits.read(4);
+        const uint32_t rateCode = bits.read(4);
+        header.assignment = bits.read(4);
+        header.depth = depths[bits.read(3)];
+        if (bits.read(1) != 0 || header.assignment > 10 || header.depth < 0) return 0;
+
+        // UTF-8 style coded number
+        const uint32_t lead = bits.read(8);
+        int ones = 0;
+        while (ones < 8 && (lead & (0x80u >> ones))) ++ones;
+        if (ones == 1 || ones > 7) return 0;
+        uint64_t number = (ones == 0) ? lead : (lead & (0x7Fu >> ones));
+        for (int i = 1; i < ones; ++i) {
+            const uint32_t next = bits.read(8);
+            if ((next & 0xC0) != 0x80) return 0;
+            number = (number << 6) | (next & 0x3F);
+        }
+        header.number = number;
+
+        if (sizeCode == 1) header.blockSize = 192;
+        else if (sizeCode >= 2 && sizeCode <= 5) header.blockSize = 576 << (sizeCode - 2);
+        else if (sizeCode == 6) header.blockSize = static_cast<int>(bits.read(8)) + 1;
+        else if (sizeCode == 7) header.blockSize = static_cast<int>(bits.read(16)) + 1;
+        else if (sizeCode >= 8) header.blockSize = 256 << (sizeCode - 8);
+        else return 0;
+
+        // The rate always comes from STREAMINFO; only skip an explicit value
+        if (rateCode == 12) bits.read(8);
+        else if (rateCode == 13 || rateCode == 14) bits.read(16);
+        else if (rateCode == 15) return 0;
+
+        header.channels = (header.assignment < 8) ? static_cast<int>(header.assignment) + 1 : 2;
+
+        const size_t headerBytes = bits.bytePosition();
+        if (bits.read(8) != crc8(data, headerBytes) || bits.overrun()) return 0;
+        return headerBytes + 1;
+    }
+
+    // One frame into planar out (channel c at c * stride), checked against both CRCs
+    bool decodeFrame(const unsigned char* data, size_t size, int numChannels, int bitsPerSample, int stride,
+                     int32_t* out, FrameHeader& header, size_t& consumed)
+    {
+        const size_t headerBytes = parseFrameHeader(data, size, header);
+        if (headerBytes == 0 || header.channels != numChannels || header.blockSize > stride
+            || (header.depth != 0 && header.depth != bitsPerSample)) {
+            return false;
+        }
+
+        const uint32_t assignment = header.assignment;
+        const int n = header.blockSize;
+        BitReader bits(data + headerBytes, size - headerBytes);
+        for (int ch = 0; ch < numChannels; ++ch) {
+            const bool side = (assignment == 8 && ch == 1) || (assignment == 9 && ch == 0) || (assignment == 10 && ch == 1);
+            if (!decodeSubframe(bits, bitsPerSample + (side ? 1 : 0), out + static_cast<size_t>(ch) * stride, n)) {
+                return false;
+            }
+        }
+        bits.alignToByte();
+        const size_t frameBytes = headerBytes + bits.bytePosition();
+        if (bits.read(16) != crc16(data, frameBytes) || bits.overrun()) return false;
+        consumed = frameBytes + 2;
+
+        if (assignment >= 8) {
+            int32_t* a = out;
+            int32_t* b = out + stride;
+            for (int i = 0; i < n; ++i) {
+                if (assignment == 8) {         // left, side
+                    b[i] = a[i] - b[i];
+                } else if (assignment == 9) {  // side, right
+                    a[i] = a[i] + b[i];
+                } else {                       // mid, side
+                    const int64_t mid = static_cast<int64_t>(a[i]) * 2 + (b[i] & 1);
+                    a[i] = static_cast<int32_t>((mid + b[i]) >> 1);
+                    b[i] = static_cast<int32_t>((mid - b[i]) >> 1);
+                }
+            }
+        }
+        return true;
+    }
+
+    uint64_t readBigEndian(const unsigned char* p, int bytes)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) value = (value << 8) | p[i];
+        return value;
+    }
+}
+
+bool FlacReader::isFlacFile(const std::string& filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    char marker[4] = {};
+    return file.read(marker, 4) && std::memcmp(marker, "fLaC", 4) == 0;
+}
+
+bool FlacReader::open(const std::string& filepath)
+{
+    close();
+    if (!file_.open(filepath)) {
+        return false;
+    }
+
+    const unsigned char* base = file_.data();
+    const size_t size = file_.size();
+    if (size < 4 || std::memcmp(base, "fLaC", 4) != 0) {
+        close();
+        return false;
+    }
+
+    // Metadata blocks: STREAMINFO and SEEKTABLE are used, the rest (tags, padding) skipped
+    size_t pos = 4;
+    uint64_t totalFrames = 0;
+    bool haveInfo = false;
+    bool last = false;
+    while (!last) {
+        if (size - pos < 4) {
+            close();
+            return false;
+        }
+        last = (base[pos] & 0x80) != 0;
+        const int type = base[pos] & 0x7F;
+        const size_t length = static_cast<size_t>(readBigEndian(base + pos + 1, 3));
+        pos += 4;
+        if (length > size - pos) {
+            close();
+            return false;
+        }
+        if (type == 0 && length >= 34) {
+            BitReader bits(base + pos, length);
+            bits.read(16); // min block size
+            maxBlockSize_ = static_cast<int>(bits.read(16));
+            bits.read(24); // min and max frame size
+            bits.read(24);
+            sampleRate_ = static_cast<int>(bits.read(20));
+            numChannels_ = static_cast<int>(bits.read(3)) + 1;
+            bitsPerSample_ = static_cast<int>(bits.read(5)) + 1;
+            totalFrames = (static_cast<uint64_t>(bits.read(4)) << 32) | bits.read(32);
+            haveInfo = true;
+        } else if (type == 3) {
+            // Seek points: sample, byte offset from the first frame, frame length
+            for (size_t p = pos; p + 18 <= pos + length; p += 18) {
+                const uint64_t sample = readBigEndian(base + p, 8);
+                if (sample != ~0ull) {
+                    seekPoints_.push_back({ sample, static_cast<size_t>(readBigEndian(base + p + 8, 8)) });
+                }
+            }
+        }
+        pos += length;
+    }
+    if (!haveInfo || sampleRate_ <= 0 || bitsPerSample_ < 4 || bitsPerSample_ > MAX_BITS_PER_SAMPLE
+        || maxBlockSize_ < 16) {
+        close();
+        return false;
+    }
+    firstFrameOffset_ = pos;
+
+    for (auto& point : seekPoints_) {
+        point.offset = (point.offset < size - pos) ? point.offset + pos : size;
+    }
+    seekPoints_.erase(std::remove_if(seekPoints_.begin(), seekPoints_.end(),
+                                     [size](const SeekPoint& p) { return p.offset >= size; }),
+                      seekPoints_.end());
+    seekPoints_.push_back({ 0, firstFrameOffset_ });
+    std::sort(seekPoints_.begin(), seekPoints_.end(),
+              [](const SeekPoint& a, const SeekPoint& b) { return a.sample < b.sample; });
+    seekPoints_.erase(std::unique(seekPoints_.begin(), seekPoints_.end(),
+                                  [](const SeekPoint& a, const SeekPoint& b) { return a.sample == b.sample; }),
+                      seekPoints_.end());
+    // One point per frame once the whole stream has been read; reserved so
+    // a sequential pass does not reallocate under the lock
+    seekPoints_.reserve(seekPoints_.size() + static_cast<size_t>(std::min<uint64_t>(totalFrames, size) / maxBlockSize_) + 2);
+
+    const int slots = std::max(4, CACHE_SECONDS * sampleRate_ / maxBlockSize_ + 2);
+    cache_.resize(slots);
+    for (auto& frame : cache_) {
+        frame.samples.resize(static_cast<size_t>(numChannels_) * maxBlockSize_);
+    }
+
+    // The header count is a hint only: a take still being written, or cut
+    // short, has more or fewer frames than its last STREAMINFO update
+    numFrames_ = findStreamEnd();
+    if (numFrames_ == 0) {
+        numFrames_ = totalFrames;
+    }
+    return true;
+}
+
+uint64_t FlacReader::findStreamEnd() const
+{
+    // Scan back from the end for the last frame that decodes cleanly. Only
+    // called from open(), before the cache is shared.
+    const unsigned char* base = file_.data();
+    const size_t size = file_.size();
+    const size_t limit = size - std::min(size - firstFrameOffset_, END_SCAN_BYTES);
+    for (size_t pos = size - 1; pos-- > limit;) {
+        if (base[pos] != 0xFF || (base[pos + 1] & 0xFE) != 0xF8) continue;
+        uint64_t firstSample = 0;
+        int length = 0;
+        size_t consumed = 0;
+        if (decodeAt(pos, cache_[0].samples.data(), firstSample, length, consumed)) {
+            addSeekPoint(firstSample, pos);
+            return firstSample + length;
+        }
+    }
+    return 0;
+}
+
+bool FlacReader::decodeAt(size_t offset, int32_t* samples, uint64_t& firstSample, int& length, size_t& consumed) const
+{
+    if (offset >= file_.size()) return false;
+    FrameHeader header;
+    if (!decodeFrame(file_.data() + offset, file_.size() - offset, numChannels_, bitsPerSample_, maxBlockSize_,
+                     samples, header, consumed)) {
+        return false;
+    }
+    firstSample = header.variable ? header.number : header.number * static_cast<uint64_t>(maxBlockSize_);
+    length = header.blockSize;
+    return true;
+}
+
+void FlacReader::addSeekPoint(uint64_t sample, size_t offset) const
+{
+    const auto it = std::lower_bound(seekPoints_.begin(), seekPoints_.end(), sample,
+                                     [](const SeekPoint& p, uint64_t s) { return p.sample < s; });
+    if (it == seekPoints_.end() || it->sample != sample) {
+        seekPoints_.insert(it, { sample, offset });
+    }
+}
+
+FlacReader::CachedFrame* FlacReader::findCached(uint64_t sample) const
+{
+    for (auto& frame : cache_) {
+        if (!frame.busy && frame.length > 0 && sample >= frame.firstSample
+            && sample - frame.firstSample < static_cast<uint64_t>(frame.length)) {
+            return &frame;
+        }
+    }
+    return nullptr;
+}
+
+bool FlacReader::load(uint64_t sample) const
+{
+    // Claim the least recently used slot; it is decoded into outside the lock
+    CachedFrame* slot = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& frame : cache_) {
+            if (!frame.busy && (!slot || frame.lastUse < slot->lastUse)) slot = &frame;
+        }
+        if (!slot) return false;
+        slot->busy = true;
+        slot->length = 0;
+    }
+
+    const unsigned char* base = file_.data();
+    uint64_t firstSample = 0;
+    int length = 0;
+    bool found = false;
+    int bisections = 0;
+    while (!found) {
+        SeekPoint below{ 0, firstFrameOffset_ };
+        SeekPoint above{ numFrames_, file_.size() };
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto it = std::upper_bound(seekPoints_.begin(), seekPoints_.end(), sample,
+                                             [](uint64_t s, const SeekPoint& p) { return s < p.sample; });
+            if (it != seekPoints_.end()) above = *it;
+            if (it != seekPoints_.begin()) below = *(it - 1);
+        }
+
+        // Far from any known frame: probe for one at the interpolated byte position
+        if (bisections < MAX_BISECTIONS && sample - below.sample >= static_cast<uint64_t>(BISECT_BLOCKS) * maxBlockSize_
+            && above.sample > below.sample && above.offset > below.offset + 1) {
+            ++bisections;
+            const double fraction = static_cast<double>(sample - below.sample) / static_cast<double>(above.sample - below.sample);
+            size_t pos = below.offset + 1 + static_cast<size_t>(fraction * static_cast<double>(above.offset - below.offset - 1));
+            bool probed = false;
+            for (; pos + 1 < above.offset; ++pos) {
+                if (base[pos] != 0xFF || (base[pos + 1] & 0xFE) != 0xF8) continue;
+                size_t consumed = 0;
+                if (!decodeAt(pos, slot->samples.data(), firstSample, length, consumed)
+                    || firstSample <= below.sample || firstSample >= above.sample) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                addSeekPoint(firstSample, pos);
+                addSeekPoint(firstSample + length, pos + consumed);
+                found = sample < firstSample + static_cast<uint64_t>(length) && sample >= firstSample;
+                probed = true;
+                break;
+            }
+            if (probed) continue;
+        }
+
+        // Near a known frame, or nothing found in between: walk forward from it
+        size_t consumed = 0;
+        if (!decodeAt(below.offset, slot->samples.data(), firstSample, length, consumed)) break;
+        const uint64_t next = firstSample + static_cast<uint64_t>(length);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            addSeekPoint(next, below.offset + consumed);
+        }
+        found = sample < next && sample >= firstSample;
+        if (!found && (next <= below.sample || firstSample > sample)) break; // seek point disagrees with the frame
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    slot->busy = false;
+    if (found) {
+        slot->firstSample = firstSample;
+        slot->length = length;
+        slot->lastUse = ++useClock_;
+    }
+    return found;
+}
+
+void FlacReader::close()
+{
+    file_.close();
+    firstFrameOffset_ = 0;
+    sampleRate_ = 0;
+    numChannels_ = 0;
+    bitsPerSample_ = 0;
+    maxBlockSize_ = 0;
+    numFrames_ = 0;
+    seekPoints_.clear();
+    cache_.clear();
+    useClock_ = 0;
+}
+
+int FlacReader::copyFrames(uint64_t startFrame, int numFrames, int numChannels,
+                           float* const* floats, int32_t* const* ints) const
+{
+    if (!isOpen() || startFrame >= numFrames_ || numFrames <= 0) {
+        return 0;
+    }
+
+    const int frames = static_cast<int>(std::min<uint64_t>(numFrames, numFrames_ - startFrame));
+    const float scale = 1.0f / static_cast<float>(1u << (bitsPerSample_ - 1));
+    int done = 0;
+    int misses = 0;
+    while (done < frames) {
+        const uint64_t sample = startFrame + done;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (CachedFrame* frame = findCached(sample)) {
+                const int offset = static_cast<int>(sample - frame->firstSample);
+                const int count = std::min(frames - done, frame->length - offset);
+                for (int ch = 0; ch < numChannels; ++ch) {
+                    const int32_t* in = frame->samples.data()
+                                      + static_cast<size_t>(std::min(ch, numChannels_ - 1)) * maxBlockSize_ + offset;
+                    if (floats) {
+                        float* out = floats[ch] + done;
+                        for (int i = 0; i < count; ++i) {
+                            out[i] = static_cast<float>(in[i]) * scale;
+                        }
+                    } else {
+                        std::memcpy(ints[ch] + done, in, count * sizeof(int32_t));
+                    }
+                }
+                frame->lastUse = ++useClock_;
+                done += count;
+                misses = 0;
+                continue;
+            }
+        }
+        // Not prefetched: decode inline, as a WAV read would block on a page
+        // fault. A damaged frame ends the read.
+        if (++misses > 2 || !load(sample)) break;
+    }
+    return done;
+}
+
+int FlacReader::read(uint64_t startFrame, float* const* channels, int numChannels, int numFrames) const
+{
+    return copyFrames(startFrame, numFrames, numChannels, channels, nullptr);
+}
+
+int FlacReader::readInt(uint64_t startFrame, int32_t* const* channels, int numChannels, int numFrames) const
+{
+    return copyFrames(startFrame, numFrames, numChannels, nullptr, channels);
+}
+
+void FlacReader::prefetch(uint64_t startFrame, uint64_t numFrames) const
+{
+    if (!isOpen() || startFrame >= numFrames_) {
+        return;
+    }
+
+    const uint64_t end = startFrame + std::min(numFrames, numFrames_ - startFrame);
+    uint64_t sample = startFrame;
+    while (sample < end) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (const CachedFrame* frame = findCached(sample)) {
+                sample = frame->firstSample + frame->length;
+                continue;
+            }
+        }
+        if (!load(sample)) return;
+    }
+}
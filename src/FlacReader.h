@@ -0,0 +1,85 @@
+#ifndef FLACREADER_H
+#define FLACREADER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include "MappedFile.h"
+
+// Streaming FLAC decoder with the same interface as WavReader. open() reads
+// only the metadata and maps the file; frames are decoded on demand into a
+// small cache, located through seek points (the SEEKTABLE, if present, plus
+// every frame boundary seen so far) and a byte bisection for long jumps.
+// The length comes from the last intact frame, so an interrupted take opens
+// with the audio written before the break.
+//
+// read() and prefetch() may be called from several threads at once; the
+// cache is guarded by a mutex held only for lookups and copies, never while
+// decoding. A real-time reader calls prefetch() from a worker ahead of the
+// play position so the audio thread normally finds its frames decoded.
+class FlacReader {
+public:
+    FlacReader() = default;
+
+    bool open(const std::string& filepath);
+    void close();
+
+    bool isOpen() const { return file_.isOpen() && sampleRate_ > 0; }
+    int getSampleRate() const { return sampleRate_; }
+    int getNumChannels() const { return numChannels_; }
+    int getBitsPerSample() const { return bitsPerSample_; }
+    bool isFloat() const { return false; }
+    uint64_t getNumFrames() const { return numFrames_; }
+
+    // Planar float output; extra output channels repeat the last file channel.
+    // Returns the number of frames read.
+    int read(uint64_t startFrame, float* const* channels, int numChannels, int numFrames) const;
+
+    // Planar integers at the file's own bit depth
+    int readInt(uint64_t startFrame, int32_t* const* channels, int numChannels, int numFrames) const;
+
+    // Decodes the frames covering a range into the cache ahead of a real-time reader
+    void prefetch(uint64_t startFrame, uint64_t numFrames) const;
+
+    // Cheap check of the "fLaC" marker, without decoding
+    static bool isFlacFile(const std::string& filepath);
+
+    static const int CACHE_SECONDS = 6; // covers ClipPlayer's 4 s prefetch window
+
+private:
+    struct SeekPoint {
+        uint64_t sample;
+        size_t offset;
+    };
+
+    struct CachedFrame {
+        uint64_t firstSample{0};
+        int length{0};              // 0 while empty
+        bool busy{false};           // being decoded outside the lock
+        uint64_t lastUse{0};
+        std::vector<int32_t> samples; // planar, channel c at c * maxBlockSize_
+    };
+
+    bool decodeAt(size_t offset, int32_t* samples, uint64_t& firstSample, int& length, size_t& consumed) const;
+    uint64_t findStreamEnd() const;
+    bool load(uint64_t sample) const;
+    void addSeekPoint(uint64_t sample, size_t offset) const;
+    CachedFrame* findCached(uint64_t sample) const;
+    int copyFrames(uint64_t startFrame, int numFrames, int numChannels, float* const* floats, int32_t* const* ints) const;
+
+    MappedFile file_;
+    size_t firstFrameOffset_{0};
+    int sampleRate_{0};
+    int numChannels_{0};
+    int bitsPerSample_{0};
+    int maxBlockSize_{0};
+    uint64_t numFrames_{0};
+
+    mutable std::mutex mutex_;
+    mutable std::vector<SeekPoint> seekPoints_; // sorted by sample
+    mutable std::vector<CachedFrame> cache_;
+    mutable uint64_t useClock_{0};
+};
+
+#endif // FLACREADER_H
@@ -1,10 +1,152 @@
 #include "Looper.h"
+#include "MappedFile.h"
+#include "Resampler.h"
+#include "TimeStretcher.h"
 #include <algorithm>
 #include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <cmath>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace {
+    // Session file layout: SessionHeader, one SessionSlotEntry per slot, then
+    // the slot payloads. Payloads are 64-byte aligned so float data can be
+    // used in place straight from the mapping.
+    constexpr char SESSION_MAGIC[4] = {'G', 'L', 'P', 'S'};
+    constexpr uint32_t SESSION_VERSION = 1;
+    constexpr uint64_t PAYLOAD_ALIGN = 64;
+
+    // Int16 payloads are quantised to 16 bits: half the size, but lossy
+    enum SessionEncoding : uint32_t {
+        EncodingFloat32 = 0,
+        EncodingInt16 = 1
+    };
+
+    enum SessionSlotFlags : uint32_t {
+        SlotSelected = 1u << 0
+    };
+
+    struct SessionHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t sampleRate;
+        uint32_t slotCount;
+        float loopLevel;
+        uint32_t reserved[11];
+    };
+    static_assert(sizeof(SessionHeader) == 64, "session header layout");
+
+    struct SessionSlotEntry {
+        uint32_t length;
+        uint32_t flags;
+        uint32_t encoding;
+        uint32_t reserved;
+        uint64_t offsetLeft;
+        uint64_t offsetRight;
+    };
+    static_assert(sizeof(SessionSlotEntry) == 32, "session slot layout");
+
+    uint64_t alignPayload(uint64_t offset)
+    {
+        return (offset + PAYLOAD_ALIGN - 1) & ~(PAYLOAD_ALIGN - 1);
+    }
+
+    void writePadding(std::ofstream& file, uint64_t from, uint64_t to)
+    {
+        static const char zeros[PAYLOAD_ALIGN] = {};
+        if (to > from) file.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+
+    void writeChannel(std::ofstream& file, const float* samples, int length, uint32_t encoding)
+    {
+        if (encoding == EncodingFloat32) {
+            file.write(reinterpret_cast<const char*>(samples), static_cast<std::streamsize>(length) * sizeof(float));
+            return;
+        }
+        std::vector<int16_t> pcm(length);
+        for (int i = 0; i < length; ++i) {
+            float s = std::max(-1.0f, std::min(1.0f, samples[i]));
+            pcm[i] = static_cast<int16_t>(s * 32767.0f);
+        }
+        file.write(reinterpret_cast<const char*>(pcm.data()), static_cast<std::streamsize>(length) * sizeof(int16_t));
+    }
+
+    // Whole-slot conversion of a session saved at another sample rate
+    void resampleSlot(const float* left, const float* right, int length, double fromRate, double toRate,
+                      std::vector<float>& outL, std::vector<float>& outR)
+    {
+        const int outLength = static_cast<int>(std::max<int64_t>(1, std::llround(length * toRate / fromRate)));
+        outL.assign(outLength, 0.0f);
+        outR.assign(outLength, 0.0f);
+
+        Resampler resampler;
+        resampler.reset(2, fromRate, toRate);
+        const float* input[2] = { left, right };
+        resampler.push(input, length);
+        resampler.flush();
+
+        int done = 0;
+        while (done < outLength) {
+            float* output[2] = { outL.data() + done, outR.data() + done };
+            const int frames = resampler.pull(output, outLength - done);
+            if (frames <= 0) break;
+            done += frames;
+        }
+    }
+
+    bool isSameFile(const std::string& a, const std::string& b)
+    {
+        std::error_code error;
+        return std::filesystem::equivalent(std::filesystem::u8path(a), std::filesystem::u8path(b), error);
+    }
+
+    // Atomic replace; rename() won't overwrite an existing file on Windows
+    bool replaceFile(const std::string& from, const std::string& to)
+    {
+#ifdef _WIN32
+        auto widen = [](const std::string& path) {
+            int wideLen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+            std::wstring wide(wideLen > 0 ? wideLen : 0, L'\0');
+            if (wideLen > 0) MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], wideLen);
+            return wide;
+        };
+        return MoveFileExW(widen(from).c_str(), widen(to).c_str(),
+                           MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+}
 
 Looper::Looper()
 {
+    stretcher_ = std::make_unique<TimeStretcher>();
     setSampleRate(48000);
+    stretchThread_ = std::thread(&Looper::stretchThread, this);
+}
+
+Looper::~Looper()
+{
+    {
+        std::lock_guard<std::mutex> lock(stretchMutex_);
+        stopStretchThread_ = true;
+    }
+    stretchCV_.notify_one();
+    if (stretchThread_.joinable()) {
+        stretchThread_.join();
+    }
+    if (sessionThread_.joinable()) {
+        sessionThread_.join();
+    }
 }
 
 void Looper::setSampleRate(int sampleRate)
@@ -17,101 +159,111 @@ void Looper::setSampleRate(int sampleRate)
     loopBufferR_.resize(maxLengthSamples_, 0.0f);
 }
 
-void Looper::process(float* bufferL, float* bufferR, int numSamples)
+void Looper::process(float* bufferL, float* bufferR, int numSamples, float* loopL, float* loopR)
 {
     LooperState state = state_.load();
     float level = loopLevel_.load();
     
     std::lock_guard<std::mutex> lock(bufferMutex_);
 
+    if (loopL) {
+        std::fill(loopL, loopL + numSamples, 0.0f);
+        std::fill(loopR, loopR + numSamples, 0.0f);
+    }
+
     // When recording, we audibly layer currently active slots while capturing
     // new audio into the working buffer. This enables successive Record presses
     // to build up a stack of loops.
     if (state == LooperState::Recording) {
-        for (int i = 0; i < numSamples; ++i) {
-            // Play active slots (previous layers) into output first
-            for (auto &slot : slots_) {
-                if (slot.active && slot.length > 0) {
-                    bufferL[i] += slot.left[slot.position] * level;
-                    bufferR[i] += slot.right[slot.position] * level;
-                    slot.position = (slot.position + 1) % slot.length;
-                }
-            }
-            // Capture new layer
-            if (position_ < maxLengthSamples_) {
-                loopBufferL_[position_] = bufferL[i];
-                loopBufferR_[position_] = bufferR[i];
-                position_++;
-            }
+        // Play active slots (previous layers) into output first
+        mixActiveSlots(bufferL, bufferR, numSamples, level, loopL, loopR);
+        // Capture new layer
+        for (int i = 0; i < numSamples && position_ < maxLengthSamples_; ++i) {
+            loopBufferL_[position_] = bufferL[i];
+            loopBufferR_[position_] = bufferR[i];
+            position_++;
         }
     } else if (state == LooperState::Playing) {
         // Legacy single loop playback (only used before first slot creation)
         if (loopLength_ > 0) {
             for (int i = 0; i < numSamples; ++i) {
-                bufferL[i] += loopBufferL_[position_] * level;
-                bufferR[i] += loopBufferR_[position_] * level;
+                const float l = loopBufferL_[position_] * level;
+                const float r = loopBufferR_[position_] * level;
+                bufferL[i] += l;
+                bufferR[i] += r;
+                if (loopL) {
+                    loopL[i] += l;
+                    loopR[i] += r;
+                }
                 position_ = (position_ + 1) % loopLength_;
             }
         }
         // Slots playback (after first slot exists we rely mostly on slots_)
-        if (!slots_.empty()) {
-            for (int i = 0; i < numSamples; ++i) {
-                for (auto &slot : slots_) {
-                    if (slot.active && slot.length > 0) {
-                        bufferL[i] += slot.left[slot.position] * level;
-                        bufferR[i] += slot.right[slot.position] * level;
-                        slot.position = (slot.position + 1) % slot.length;
-                    }
-                }
-            }
-        }
+        mixActiveSlots(bufferL, bufferR, numSamples, level, loopL, loopR);
     } else if (state == LooperState::Overdubbing) {
         // Overdub onto legacy single loop only (prior to slot conversion)
         if (loopLength_ > 0) {
             for (int i = 0; i < numSamples; ++i) {
-                bufferL[i] += loopBufferL_[position_] * level;
-                bufferR[i] += loopBufferR_[position_] * level;
+                const float l = loopBufferL_[position_] * level;
+                const float r = loopBufferR_[position_] * level;
+                bufferL[i] += l;
+                bufferR[i] += r;
+                if (loopL) {
+                    loopL[i] += l;
+                    loopR[i] += r;
+                }
                 loopBufferL_[position_] = loopBufferL_[position_] * 0.7f + bufferL[i] * 0.3f;
                 loopBufferR_[position_] = loopBufferR_[position_] * 0.7f + bufferR[i] * 0.3f;
                 position_ = (position_ + 1) % loopLength_;
             }
         }
         // Also mix any active slots
-        if (!slots_.empty()) {
-            for (int i = 0; i < numSamples; ++i) {
-                for (auto &slot : slots_) {
-                    if (slot.active && slot.length > 0) {
-                        bufferL[i] += slot.left[slot.position] * level;
-                        bufferR[i] += slot.right[slot.position] * level;
-                        slot.position = (slot.position + 1) % slot.length;
-                    }
-                }
-            }
-        }
+        mixActiveSlots(bufferL, bufferR, numSamples, level, loopL, loopR);
     } else { // Off state - only play any active slots (should normally be none)
-        if (!slots_.empty()) {
-            for (int i = 0; i < numSamples; ++i) {
-                for (auto &slot : slots_) {
-                    if (slot.active && slot.length > 0) {
-                        bufferL[i] += slot.left[slot.position] * level;
-                        bufferR[i] += slot.right[slot.position] * level;
-                        slot.position = (slot.position + 1) % slot.length;
-                    }
-                }
+        mixActiveSlots(bufferL, bufferR, numSamples, level, loopL, loopR);
+    }
+}
+
+void Looper::mixActiveSlots(float* bufferL, float* bufferR, int numSamples, float level, float* loopL, float* loopR)
+{
+    for (auto &slot : slots_) {
+        if (!slot.active || !slot.audio || slot.audio->length <= 0) continue;
+        const LoopAudio& audio = *slot.audio;
+        int pos = slot.position;
+        for (int i = 0; i < numSamples; ++i) {
+            const float l = audio.left[pos] * level;
+            const float r = audio.right[pos] * level;
+            bufferL[i] += l;
+            bufferR[i] += r;
+            if (loopL) {
+                loopL[i] += l;
+                loopR[i] += r;
             }
+            if (++pos >= audio.length) pos = 0;
         }
+        slot.position = pos;
     }
 }
 
+std::shared_ptr<const Looper::LoopAudio> Looper::makeLoopAudio(const float* left, const float* right, int length)
+{
+    auto audio = std::make_shared<LoopAudio>();
+    audio->storageL.assign(left, left + length);
+    audio->storageR.assign(right, right + length);
+    audio->left = audio->storageL.data();
+    audio->right = audio->storageR.data();
+    audio->length = length;
+    return audio;
+}
+
 void Looper::startRecording()
 {
     std::lock_guard<std::mutex> lock(bufferMutex_);
     // If a legacy primary loop exists and no slots yet, convert it into a slot
     if (loopLength_ > 0 && slots_.empty()) {
         LoopSlot slot;
-        slot.length = loopLength_;
-        slot.left.assign(loopBufferL_.begin(), loopBufferL_.begin() + loopLength_);
-        slot.right.assign(loopBufferR_.begin(), loopBufferR_.begin() + loopLength_);
+        slot.id = nextSlotId_++;
+        slot.audio = makeLoopAudio(loopBufferL_.data(), loopBufferR_.data(), loopLength_);
         slot.selected = true;
         slots_.push_back(std::move(slot));
         // Reset legacy loop so future playback uses slots only
@@ -187,15 +339,108 @@ void Looper::clear()
 
 int Looper::addRecordedLoop()
 {
-    std::lock_guard<std::mutex> lock(bufferMutex_);
-    if (loopLength_ <= 0) return -1;
-    LoopSlot slot;
-    slot.length = loopLength_;
-    slot.left.assign(loopBufferL_.begin(), loopBufferL_.begin() + loopLength_);
-    slot.right.assign(loopBufferR_.begin(), loopBufferR_.begin() + loopLength_);
-    slot.selected = true; // auto-select
-    slots_.push_back(std::move(slot));
-    return (int)slots_.size() - 1;
+    StretchJob job;
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        if (loopLength_ <= 0) return -1;
+        LoopSlot slot;
+        slot.id = nextSlotId_++;
+        slot.audio = makeLoopAudio(loopBufferL_.data(), loopBufferR_.data(), loopLength_);
+        slot.selected = true; // auto-select
+        slots_.push_back(std::move(slot));
+        index = (int)slots_.size() - 1;
+        
+        // The first slot defines the master length; later ones are conformed to it
+        if (index > 0 && conformToMaster_.load()) {
+            int target = conformedLength(slots_.back().audio->length, slots_.front().audio->length);
+            if (target != slots_.back().audio->length) {
+                job.slotId = slots_.back().id;
+                job.source = slots_.back().audio;
+                job.targetLength = target;
+            }
+        }
+    }
+    
+    if (job.source) {
+        pendingStretchJobs_.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(stretchMutex_);
+            stretchJobs_.push_back(std::move(job));
+        }
+        stretchCV_.notify_one();
+    }
+    return index;
+}
+
+int Looper::conformedLength(int length, int masterLength) const
+{
+    if (masterLength <= 0 || length <= 0) return length;
+    
+    // Nearest of master/4, master/2, master, 2*master, ... in the log domain
+    int best = masterLength;
+    double bestDistance = std::abs(std::log(double(length) / masterLength));
+    for (int div = 2; div <= 4; div *= 2) {
+        int candidate = masterLength / div;
+        double distance = std::abs(std::log(double(length) / candidate));
+        if (candidate > 0 && distance < bestDistance) {
+            best = candidate;
+            bestDistance = distance;
+        }
+    }
+    int multiple = std::max(1, static_cast<int>(std::lround(double(length) / masterLength)));
+    double distance = std::abs(std::log(double(length) / (double(masterLength) * multiple)));
+    if (distance < bestDistance && (int64_t)masterLength * multiple <= maxLengthSamples_) {
+        best = masterLength * multiple;
+    }
+    return best;
+}
+
+void Looper::stretchThread()
+{
+    std::vector<float> outL;
+    std::vector<float> outR;
+    
+    while (true) {
+        StretchJob job;
+        {
+            std::unique_lock<std::mutex> lock(stretchMutex_);
+            stretchCV_.wait(lock, [this] { return stopStretchThread_ || !stretchJobs_.empty(); });
+            if (stopStretchThread_) break;
+            job = std::move(stretchJobs_.front());
+            stretchJobs_.pop_front();
+        }
+        
+        // The stretcher is only touched from this thread
+        if (stretcherSampleRate_ != sampleRate_) {
+            stretcherSampleRate_ = sampleRate_;
+            stretcher_->setSampleRate(stretcherSampleRate_);
+        }
+        const LoopAudio& src = *job.source;
+        outL.resize(job.targetLength);
+        outR.resize(job.targetLength);
+        stretcher_->process(src.left, src.right, src.length, outL.data(), outR.data(), job.targetLength);
+        
+        auto stretched = makeLoopAudio(outL.data(), outR.data(), job.targetLength);
+        
+        // Swap the conformed audio in; the replaced buffer is released below,
+        // outside the lock and off the audio thread
+        std::shared_ptr<const LoopAudio> replaced;
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex_);
+            for (auto& slot : slots_) {
+                if (slot.id == job.slotId && slot.audio == job.source) {
+                    slot.position = static_cast<int>((int64_t)slot.position * job.targetLength / job.source->length);
+                    replaced = std::move(slot.audio);
+                    slot.audio = std::move(stretched);
+                    break;
+                }
+            }
+        }
+        replaced.reset();
+        job.source.reset();
+        pendingStretchJobs_.fetch_sub(1);
+    }
 }
 
 void Looper::toggleSlotSelection(int index)
@@ -229,6 +474,211 @@ void Looper::clearAllSlots()
     slots_.clear();
 }
 
+bool Looper::saveSession(const std::string& filepath, bool lossy16Bit)
+{
+    // Only one save at a time; the previous writer must be finished first
+    if (sessionThread_.joinable()) {
+        sessionThread_.join();
+    }
+
+    detachMappedSlots(filepath);
+
+    // Snapshot under the lock is cheap: slot audio is shared, not copied
+    std::vector<LoopSlot> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        snapshot = slots_;
+    }
+    if (snapshot.empty()) return false;
+
+    const uint32_t sampleRate = static_cast<uint32_t>(sampleRate_);
+    const float level = loopLevel_.load();
+
+    sessionSaving_.store(true);
+    sessionThread_ = std::thread([this, filepath, lossy16Bit, sampleRate, level, snapshot = std::move(snapshot)]() {
+        const uint32_t encoding = lossy16Bit ? EncodingInt16 : EncodingFloat32;
+        const uint64_t bytesPerSample = lossy16Bit ? sizeof(int16_t) : sizeof(float);
+
+        SessionHeader header{};
+        std::memcpy(header.magic, SESSION_MAGIC, sizeof(header.magic));
+        header.version = SESSION_VERSION;
+        header.sampleRate = sampleRate;
+        header.slotCount = static_cast<uint32_t>(snapshot.size());
+        header.loopLevel = level;
+
+        std::vector<SessionSlotEntry> entries(snapshot.size());
+        uint64_t offset = alignPayload(sizeof(SessionHeader) + entries.size() * sizeof(SessionSlotEntry));
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            const LoopAudio& audio = *snapshot[i].audio;
+            SessionSlotEntry& entry = entries[i];
+            entry.length = static_cast<uint32_t>(audio.length);
+            entry.flags = snapshot[i].selected ? uint32_t(SlotSelected) : 0u;
+            entry.encoding = encoding;
+            entry.offsetLeft = offset;
+            offset = alignPayload(offset + audio.length * bytesPerSample);
+            entry.offsetRight = offset;
+            offset = alignPayload(offset + audio.length * bytesPerSample);
+        }
+
+        // Write next to the target and rename so a failed save never
+        // clobbers the previous session
+        const std::string tempPath = filepath + ".tmp";
+        bool ok = false;
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (file.is_open()) {
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(entries.data()),
+                           static_cast<std::streamsize>(entries.size() * sizeof(SessionSlotEntry)));
+                uint64_t written = sizeof(SessionHeader) + entries.size() * sizeof(SessionSlotEntry);
+                for (size_t i = 0; i < snapshot.size(); ++i) {
+                    const LoopAudio& audio = *snapshot[i].audio;
+                    writePadding(file, written, entries[i].offsetLeft);
+                    writeChannel(file, audio.left, audio.length, encoding);
+                    written = entries[i].offsetLeft + audio.length * bytesPerSample;
+                    writePadding(file, written, entries[i].offsetRight);
+                    writeChannel(file, audio.right, audio.length, encoding);
+                    written = entries[i].offsetRight + audio.length * bytesPerSample;
+                }
+                ok = file.good();
+            }
+        }
+        if (ok) {
+            ok = replaceFile(tempPath, filepath);
+        }
+        if (!ok) {
+            std::remove(tempPath.c_str());
+        }
+
+        sessionSaveOk_.store(ok);
+        sessionSaving_.store(false);
+    });
+    return true;
+}
+
+void Looper::detachMappedSlots(const std::string& filepath)
+{
+    // Slots played from the file about to be replaced get their own copy:
+    // Windows refuses to replace a mapped file, and elsewhere they would keep
+    // playing from the unlinked old one
+    std::vector<LoopSlot> mapped;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        for (const auto& slot : slots_) {
+            if (slot.audio && slot.audio->mapping) mapped.push_back(slot);
+        }
+    }
+
+    std::vector<std::shared_ptr<const LoopAudio>> released; // dropped after the lock
+    for (const auto& source : mapped) {
+        if (!isSameFile(source.audio->mapping->getPath(), filepath)) continue;
+        auto owned = makeLoopAudio(source.audio->left, source.audio->right, source.audio->length);
+
+        // Same check as the conform worker: a slot cleared or replaced
+        // meanwhile keeps what it has
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        for (auto& slot : slots_) {
+            if (slot.id == source.id && slot.audio == source.audio) {
+                released.push_back(std::move(slot.audio));
+                slot.audio = std::move(owned);
+                break;
+            }
+        }
+    }
+}
+
+bool Looper::loadSession(const std::string& filepath)
+{
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->open(filepath)) return false;
+
+    const unsigned char* base = mapping->data();
+    const uint64_t fileSize = mapping->size();
+    if (fileSize < sizeof(SessionHeader)) return false;
+
+    SessionHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, SESSION_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SESSION_VERSION || header.sampleRate == 0) {
+        return false;
+    }
+    const bool resample = static_cast<int>(header.sampleRate) != sampleRate_;
+
+    const uint64_t tableEnd = sizeof(SessionHeader) + uint64_t(header.slotCount) * sizeof(SessionSlotEntry);
+    if (tableEnd > fileSize) return false;
+
+    std::vector<LoopSlot> loaded;
+    loaded.reserve(header.slotCount);
+    for (uint32_t i = 0; i < header.slotCount; ++i) {
+        SessionSlotEntry entry;
+        std::memcpy(&entry, base + sizeof(SessionHeader) + i * sizeof(SessionSlotEntry), sizeof(entry));
+
+        const uint64_t bytesPerSample = entry.encoding == EncodingInt16 ? sizeof(int16_t) : sizeof(float);
+        const uint64_t channelBytes = uint64_t(entry.length) * bytesPerSample;
+        if (entry.length == 0 || entry.length > uint32_t(INT32_MAX) ||
+            (entry.encoding != EncodingFloat32 && entry.encoding != EncodingInt16) ||
+            entry.offsetLeft % bytesPerSample != 0 || entry.offsetRight % bytesPerSample != 0 ||
+            entry.offsetLeft > fileSize || channelBytes > fileSize - entry.offsetLeft ||
+            entry.offsetRight > fileSize || channelBytes > fileSize - entry.offsetRight) {
+            return false;
+        }
+
+        auto audio = std::make_shared<LoopAudio>();
+        audio->length = static_cast<int>(entry.length);
+        if (entry.encoding == EncodingFloat32) {
+            // Raw payloads are played straight from the mapping
+            audio->left = reinterpret_cast<const float*>(base + entry.offsetLeft);
+            audio->right = reinterpret_cast<const float*>(base + entry.offsetRight);
+            audio->mapping = mapping;
+        } else {
+            const int16_t* pcmL = reinterpret_cast<const int16_t*>(base + entry.offsetLeft);
+            const int16_t* pcmR = reinterpret_cast<const int16_t*>(base + entry.offsetRight);
+            audio->storageL.resize(entry.length);
+            audio->storageR.resize(entry.length);
+            for (uint32_t n = 0; n < entry.length; ++n) {
+                audio->storageL[n] = pcmL[n] * (1.0f / 32767.0f);
+                audio->storageR[n] = pcmR[n] * (1.0f / 32767.0f);
+            }
+            audio->left = audio->storageL.data();
+            audio->right = audio->storageR.data();
+        }
+
+        // Saved at another rate: converted once here so pitch and length stay right
+        if (resample) {
+            std::vector<float> left, right;
+            resampleSlot(audio->left, audio->right, audio->length, header.sampleRate, sampleRate_, left, right);
+            audio->storageL = std::move(left);
+            audio->storageR = std::move(right);
+            audio->left = audio->storageL.data();
+            audio->right = audio->storageR.data();
+            audio->length = static_cast<int>(audio->storageL.size());
+            audio->mapping.reset();
+        }
+
+        LoopSlot slot;
+        slot.audio = std::move(audio);
+        slot.selected = (entry.flags & SlotSelected) != 0;
+        loaded.push_back(std::move(slot));
+    }
+
+    state_.store(LooperState::Off);
+    setLoopLevel(header.loopLevel);
+
+    // Swap under the lock; the old slot audio is released here, off the audio thread
+    std::vector<LoopSlot> previous;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        previous.swap(slots_);
+        slots_ = std::move(loaded);
+        for (auto& slot : slots_) {
+            slot.id = nextSlotId_++;
+        }
+        loopLength_ = 0;
+        position_ = 0;
+    }
+    return true;
+}
+
 bool Looper::isSlotSelected(int index) const
 {
     if (index < 0 || index >= (int)slots_.size()) return false;
@@ -4,6 +4,15 @@
 #include <vector>
 #include <atomic>
 #include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <cstdint>
+
+class MappedFile;
+class TimeStretcher;
 
 enum class LooperState {
     Off,
@@ -15,9 +24,14 @@ enum class LooperState {
 class Looper {
 public:
     Looper();
+    ~Looper();
     
     void setSampleRate(int sampleRate);
-    void process(float* bufferL, float* bufferR, int numSamples);
+
+    // Adds the playing loops to the buffers. loopL/loopR, when given, receive
+    // the looper's own output alone (e.g. for a loop stem).
+    void process(float* bufferL, float* bufferR, int numSamples,
+                 float* loopL = nullptr, float* loopR = nullptr);
     
     // Controls
     void startRecording();
@@ -36,6 +50,21 @@ public:
     void clearAllSlots();
     int getSlotCount() const { return (int)slots_.size(); }
     bool isSlotSelected(int index) const;
+
+    // Session persistence. Saving snapshots the slots and writes the file on a
+    // background thread; loading maps the file and plays slots from the mapping.
+    // lossy16Bit stores 16-bit samples at half the size instead of floats.
+    // A session saved at another sample rate is resampled when loaded.
+    bool saveSession(const std::string& filepath, bool lossy16Bit = false);
+    bool loadSession(const std::string& filepath);
+    bool isSavingSession() const { return sessionSaving_.load(); }
+    bool lastSessionSaveOk() const { return sessionSaveOk_.load(); }
+    
+    // New slots are time-stretched on a worker thread to the first slot's
+    // length (or a multiple/fraction of it) so layers stay phase-locked
+    void setConformToMaster(bool enabled) { conformToMaster_.store(enabled); }
+    bool getConformToMaster() const { return conformToMaster_.load(); }
+    bool isConforming() const { return pendingStretchJobs_.load() > 0; }
     
     // Parameters
     void setLoopLevel(float level);
@@ -61,7 +90,7 @@ private:
     // then copied into a slot on stopRecording(). We layer by playing any
     // selected/active slots while capturing new audio here.
     
-    int sampleRate_{48000};
+    std::atomic<int> sampleRate_{48000};
     int maxLengthSamples_;
     float maxLengthSeconds_ { static_cast<float>(MAX_LOOP_SECONDS) };
     int loopLength_{0};
@@ -69,15 +98,54 @@ private:
     
     std::mutex bufferMutex_;
 
-    struct LoopSlot {
-        std::vector<float> left;
-        std::vector<float> right;
+    // Immutable slot audio. Samples live either in the owned vectors or in a
+    // mapped session file; left/right point at whichever one backs the slot.
+    struct LoopAudio {
+        const float* left{nullptr};
+        const float* right{nullptr};
         int length{0};
+        std::vector<float> storageL;
+        std::vector<float> storageR;
+        std::shared_ptr<MappedFile> mapping;
+    };
+
+    struct LoopSlot {
+        uint64_t id{0};
+        std::shared_ptr<const LoopAudio> audio;
         int position{0};
         bool selected{false};
         bool active{false};
     };
     std::vector<LoopSlot> slots_;
+
+    void mixActiveSlots(float* bufferL, float* bufferR, int numSamples, float level, float* loopL, float* loopR);
+    static std::shared_ptr<const LoopAudio> makeLoopAudio(const float* left, const float* right, int length);
+    void detachMappedSlots(const std::string& filepath);
+
+    // Conform-to-master worker. Jobs reference slots by id so a cleared or
+    // replaced slot simply drops the stretched result.
+    struct StretchJob {
+        uint64_t slotId{0};
+        std::shared_ptr<const LoopAudio> source;
+        int targetLength{0};
+    };
+    void stretchThread();
+    int conformedLength(int length, int masterLength) const;
+    
+    uint64_t nextSlotId_{1};
+    std::atomic<bool> conformToMaster_{true};
+    std::atomic<int> pendingStretchJobs_{0};
+    std::unique_ptr<TimeStretcher> stretcher_;
+    int stretcherSampleRate_{0};
+    std::deque<StretchJob> stretchJobs_;
+    std::mutex stretchMutex_;
+    std::condition_variable stretchCV_;
+    bool stopStretchThread_{false};
+    std::thread stretchThread_;
+
+    std::thread sessionThread_;
+    std::atomic<bool> sessionSaving_{false};
+    std::atomic<bool> sessionSaveOk_{true};
 };
 
 #endif // LOOPER_H
\ No newline at end of file
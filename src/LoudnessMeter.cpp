@@ -0,0 +1,357 @@
+#include "LoudnessMeter.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LOUDNESSMETER_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LOUDNESSMETER_NEON 1
+#endif
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double ABSOLUTE_GATE_LUFS = -70.0;
+    constexpr double RELATIVE_GATE_LU = -10.0;
+    constexpr double RANGE_RELATIVE_GATE_LU = -20.0;
+    constexpr double RANGE_LOW_PERCENTILE = 0.10;
+    constexpr double RANGE_HIGH_PERCENTILE = 0.95;
+
+    // BS.1770-4 Annex 2 interpolation filter, one row per phase
+    constexpr float TRUE_PEAK_COEFFS[4][12] = {
+        {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f,
+          -0.0594482421875f,  0.1373291015625f,  0.9721679687500f, -0.1022949218750f,
+           0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+        { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f,
+          -0.1665039062500f,  0.4650878906250f,  0.7797851562500f, -0.2003173828125f,
+           0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+        { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f,
+          -0.2003173828125f,  0.7797851562500f,  0.4650878906250f, -0.1665039062500f,
+           0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+        { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f,
+          -0.1022949218750f,  0.9721679687500f,  0.1373291015625f, -0.0594482421875f,
+           0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f }
+    };
+
+    double energyToLoudness(double energy)
+    {
+        return -0.691 + 10.0 * std::log10(energy);
+    }
+
+    double loudnessToEnergy(double loudness)
+    {
+        return std::pow(10.0, (loudness + 0.691) / 10.0);
+    }
+}
+
+void LoudnessMeter::reset(int sampleRate, int numChannels)
+{
+    sampleRate_ = sampleRate;
+    numChannels_ = numChannels;
+
+    // K-weighting stage 1: high shelf (+4 dB above ~1.7 kHz), designed for
+    // this sample rate so the response matches the 48 kHz reference
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(PI * f0 / sampleRate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        shelf_.b0 = (vh + vb * k / q + k * k) / a0;
+        shelf_.b1 = 2.0 * (k * k - vh) / a0;
+        shelf_.b2 = (vh - vb * k / q + k * k) / a0;
+        shelf_.a1 = 2.0 * (k * k - 1.0) / a0;
+        shelf_.a2 = (1.0 - k / q + k * k) / a0;
+    }
+    // Stage 2: RLB high-pass at ~38 Hz
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(PI * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+        highPass_.b0 = 1.0;
+        highPass_.b1 = -2.0;
+        highPass_.b2 = 1.0;
+        highPass_.a1 = 2.0 * (k * k - 1.0) / a0;
+        highPass_.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    state_.assign(numChannels, ChannelState{});
+    subBlockFrames_ = std::max(1, sampleRate / 10);
+    subBlockPos_ = 0;
+    subBlockSum_ = 0.0;
+    subBlockCount_ = 0;
+    blockEnergies_.clear();
+    shortTermEnergies_.clear();
+    peakHistory_.assign(numChannels, std::vector<float>(TRUE_PEAK_TAPS - 1, 0.0f));
+    peakScratch_.clear();
+    samplePeak_ = 0.0f;
+    truePeak_ = 0.0f;
+}
+
+void LoudnessMeter::process(const float* const* channels, int numFrames)
+{
+    for (int ch = 0; ch < numChannels_; ++ch) {
+        measurePeaks(channels[ch], numFrames, ch);
+    }
+
+    int done = 0;
+    while (done < numFrames) {
+        const int frames = std::min(numFrames - done, subBlockFrames_ - subBlockPos_);
+
+        if (numChannels_ == 2) {
+            subBlockSum_ += filterStereo(channels[0] + done, channels[1] + done, frames);
+        } else {
+            for (int ch = 0; ch < numChannels_; ++ch) {
+                subBlockSum_ += filterChannel(channels[ch] + done, frames, state_[ch]);
+            }
+        }
+
+        subBlockPos_ += frames;
+        done += frames;
+        if (subBlockPos_ == subBlockFrames_) {
+            finishSubBlock();
+        }
+    }
+}
+
+double LoudnessMeter::filterChannel(const float* in, int numFrames, ChannelState& st) const
+{
+    double sum = 0.0;
+    for (int i = 0; i < numFrames; ++i) {
+        const double x = in[i];
+
+        // Transposed direct form II, two stages in double
+        const double y1 = shelf_.b0 * x + st.z1[0];
+        st.z1[0] = shelf_.b1 * x - shelf_.a1 * y1 + st.z2[0];
+        st.z2[0] = shelf_.b2 * x - shelf_.a2 * y1;
+
+        const double y2 = highPass_.b0 * y1 + st.z1[1];
+        st.z1[1] = highPass_.b1 * y1 - highPass_.a1 * y2 + st.z2[1];
+        st.z2[1] = highPass_.b2 * y1 - highPass_.a2 * y2;
+
+        sum += y2 * y2;
+    }
+    return sum;
+}
+
+double LoudnessMeter::filterStereo(const float* left, const float* right, int numFrames)
+{
+    ChannelState& l = state_[0];
+    ChannelState& r = state_[1];
+
+#if defined(LOUDNESSMETER_SSE2)
+    // Lane 0 is the left channel, lane 1 the right; same recurrence as filterChannel
+    const __m128d sb0 = _mm_set1_pd(shelf_.b0), sb1 = _mm_set1_pd(shelf_.b1), sb2 = _mm_set1_pd(shelf_.b2);
+    const __m128d sa1 = _mm_set1_pd(shelf_.a1), sa2 = _mm_set1_pd(shelf_.a2);
+    const __m128d hb0 = _mm_set1_pd(highPass_.b0), hb1 = _mm_set1_pd(highPass_.b1), hb2 = _mm_set1_pd(highPass_.b2);
+    const __m128d ha1 = _mm_set1_pd(highPass_.a1), ha2 = _mm_set1_pd(highPass_.a2);
+    __m128d z10 = _mm_set_pd(r.z1[0], l.z1[0]), z20 = _mm_set_pd(r.z2[0], l.z2[0]);
+    __m128d z11 = _mm_set_pd(r.z1[1], l.z1[1]), z21 = _mm_set_pd(r.z2[1], l.z2[1]);
+    __m128d sum = _mm_setzero_pd();
+    for (int i = 0; i < numFrames; ++i) {
+        const __m128d x = _mm_set_pd(right[i], left[i]);
+        const __m128d y1 = _mm_add_pd(_mm_mul_pd(sb0, x), z10);
+        z10 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(sb1, x), _mm_mul_pd(sa1, y1)), z20);
+        z20 = _mm_sub_pd(_mm_mul_pd(sb2, x), _mm_mul_pd(sa2, y1));
+        const __m128d y2 = _mm_add_pd(_mm_mul_pd(hb0, y1), z11);
+        z11 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(hb1, y1), _mm_mul_pd(ha1, y2)), z21);
+        z21 = _mm_sub_pd(_mm_mul_pd(hb2, y1), _mm_mul_pd(ha2, y2));
+        sum = _mm_add_pd(sum, _mm_mul_pd(y2, y2));
+    }
+    double lanes[2];
+    _mm_storel_pd(&l.z1[0], z10); _mm_storeh_pd(&r.z1[0], z10);
+    _mm_storel_pd(&l.z2[0], z20); _mm_storeh_pd(&r.z2[0], z20);
+    _mm_storel_pd(&l.z1[1], z11); _mm_storeh_pd(&r.z1[1], z11);
+    _mm_storel_pd(&l.z2[1], z21); _mm_storeh_pd(&r.z2[1], z21);
+    _mm_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1];
+#elif defined(LOUDNESSMETER_NEON)
+    const float64x2_t sb0 = vdupq_n_f64(shelf_.b0), sb1 = vdupq_n_f64(shelf_.b1), sb2 = vdupq_n_f64(shelf_.b2);
+    const float64x2_t sa1 = vdupq_n_f64(shelf_.a1), sa2 = vdupq_n_f64(shelf_.a2);
+    const float64x2_t hb0 = vdupq_n_f64(highPass_.b0), hb1 = vdupq_n_f64(highPass_.b1), hb2 = vdupq_n_f64(highPass_.b2);
+    const float64x2_t ha1 = vdupq_n_f64(highPass_.a1), ha2 = vdupq_n_f64(highPass_.a2);
+    const double init[4][2] = { { l.z1[0], r.z1[0] }, { l.z2[0], r.z2[0] }, { l.z1[1], r.z1[1] }, { l.z2[1], r.z2[1] } };
+    float64x2_t z10 = vld1q_f64(init[0]), z20 = vld1q_f64(init[1]);
+    float64x2_t z11 = vld1q_f64(init[2]), z21 = vld1q_f64(init[3]);
+    float64x2_t sum = vdupq_n_f64(0.0);
+    for (int i = 0; i < numFrames; ++i) {
+        const double pair[2] = { left[i], right[i] };
+        const float64x2_t x = vld1q_f64(pair);
+        const float64x2_t y1 = vfmaq_f64(z10, sb0, x);
+        z10 = vfmsq_f64(vfmaq_f64(z20, sb1, x), sa1, y1);
+        z20 = vfmsq_f64(vmulq_f64(sb2, x), sa2, y1);
+        const float64x2_t y2 = vfmaq_f64(z11, hb0, y1);
+        z11 = vfmsq_f64(vfmaq_f64(z21, hb1, y1), ha1, y2);
+        z21 = vfmsq_f64(vmulq_f64(hb2, y1), ha2, y2);
+        sum = vfmaq_f64(sum, y2, y2);
+    }
+    l.z1[0] = vgetq_lane_f64(z10, 0); r.z1[0] = vgetq_lane_f64(z10, 1);
+    l.z2[0] = vgetq_lane_f64(z20, 0); r.z2[0] = vgetq_lane_f64(z20, 1);
+    l.z1[1] = vgetq_lane_f64(z11, 0); r.z1[1] = vgetq_lane_f64(z11, 1);
+    l.z2[1] = vgetq_lane_f64(z21, 0); r.z2[1] = vgetq_lane_f64(z21, 1);
+    return vaddvq_f64(sum);
+#else
+    return filterChannel(left, numFrames, l) + filterChannel(right, numFrames, r);
+#endif
+}
+
+void LoudnessMeter::measurePeaks(const float* in, int numFrames, int channel)
+{
+    // History then block, so every tap reads a contiguous run
+    std::vector<float>& ext = peakScratch_;
+    const int historyLength = TRUE_PEAK_TAPS - 1;
+    std::vector<float>& history = peakHistory_[channel];
+    ext.assign(history.begin(), history.end());
+    ext.insert(ext.end(), in, in + numFrames);
+    std::copy(ext.end() - historyLength, ext.end(), history.begin());
+
+    // Output i of a phase reads ext[i + historyLength - k] for tap k
+    const float* x = ext.data() + historyLength;
+    float peak = std::max(samplePeak_, truePeak_);
+    float sample = samplePeak_;
+    int i = 0;
+
+#if defined(LOUDNESSMETER_SSE2)
+    // Four outputs of all four phases per iteration, accumulated in registers
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 vPeak = _mm_setzero_ps();
+    __m128 vSample = _mm_setzero_ps();
+    for (; i + 4 <= numFrames; i += 4) {
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+        __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+        for (int k = 0; k < TRUE_PEAK_TAPS; ++k) {
+            const __m128 v = _mm_loadu_ps(x + i - k);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(v, _mm_set1_ps(TRUE_PEAK_COEFFS[0][k])));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(v, _mm_set1_ps(TRUE_PEAK_COEFFS[1][k])));
+            acc2 = _mm_add_ps(acc2, _mm_mul_ps(v, _mm_set1_ps(TRUE_PEAK_COEFFS[2][k])));
+            acc3 = _mm_add_ps(acc3, _mm_mul_ps(v, _mm_set1_ps(TRUE_PEAK_COEFFS[3][k])));
+        }
+        vSample = _mm_max_ps(vSample, _mm_and_ps(_mm_loadu_ps(x + i), signMask));
+        vPeak = _mm_max_ps(vPeak, _mm_max_ps(_mm_max_ps(_mm_and_ps(acc0, signMask), _mm_and_ps(acc1, signMask)),
+                                             _mm_max_ps(_mm_and_ps(acc2, signMask), _mm_and_ps(acc3, signMask))));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, vPeak);
+    peak = std::max({ peak, lanes[0], lanes[1], lanes[2], lanes[3] });
+    _mm_storeu_ps(lanes, vSample);
+    sample = std::max({ sample, lanes[0], lanes[1], lanes[2], lanes[3] });
+#elif defined(LOUDNESSMETER_NEON)
+    float32x4_t vPeak = vdupq_n_f32(0.0f);
+    float32x4_t vSample = vdupq_n_f32(0.0f);
+    for (; i + 4 <= numFrames; i += 4) {
+        float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+        float32x4_t acc2 = vdupq_n_f32(0.0f), acc3 = vdupq_n_f32(0.0f);
+        for (int k = 0; k < TRUE_PEAK_TAPS; ++k) {
+            const float32x4_t v = vld1q_f32(x + i - k);
+            acc0 = vfmaq_n_f32(acc0, v, TRUE_PEAK_COEFFS[0][k]);
+            acc1 = vfmaq_n_f32(acc1, v, TRUE_PEAK_COEFFS[1][k]);
+            acc2 = vfmaq_n_f32(acc2, v, TRUE_PEAK_COEFFS[2][k]);
+            acc3 = vfmaq_n_f32(acc3, v, TRUE_PEAK_COEFFS[3][k]);
+        }
+        vSample = vmaxq_f32(vSample, vabsq_f32(vld1q_f32(x + i)));
+        vPeak = vmaxq_f32(vPeak, vmaxq_f32(vmaxq_f32(vabsq_f32(acc0), vabsq_f32(acc1)),
+                                           vmaxq_f32(vabsq_f32(acc2), vabsq_f32(acc3))));
+    }
+    peak = std::max(peak, vmaxvq_f32(vPeak));
+    sample = std::max(sample, vmaxvq_f32(vSample));
+#endif
+
+    for (; i < numFrames; ++i) {
+        sample = std::max(sample, std::fabs(x[i]));
+        for (int phase = 0; phase < TRUE_PEAK_PHASES; ++phase) {
+            float acc = 0.0f;
+            for (int k = 0; k < TRUE_PEAK_TAPS; ++k) {
+                acc += TRUE_PEAK_COEFFS[phase][k] * x[i - k];
+            }
+            peak = std::max(peak, std::fabs(acc));
+        }
+    }
+
+    samplePeak_ = sample;
+    truePeak_ = std::max(peak, sample);
+}
+
+void LoudnessMeter::finishSubBlock()
+{
+    recentSubBlocks_[subBlockCount_ % SHORT_TERM_SUB_BLOCKS] = subBlockSum_ / subBlockFrames_;
+    ++subBlockCount_;
+    subBlockSum_ = 0.0;
+    subBlockPos_ = 0;
+
+    auto meanOfLast = [this](int count) {
+        double sum = 0.0;
+        for (int i = 1; i <= count; ++i) {
+            sum += recentSubBlocks_[(subBlockCount_ - i) % SHORT_TERM_SUB_BLOCKS];
+        }
+        return sum / count;
+    };
+    if (subBlockCount_ >= 4) {
+        blockEnergies_.push_back(meanOfLast(4));
+    }
+    if (subBlockCount_ >= SHORT_TERM_SUB_BLOCKS) {
+        shortTermEnergies_.push_back(meanOfLast(SHORT_TERM_SUB_BLOCKS));
+    }
+}
+
+double LoudnessMeter::getIntegratedLoudness() const
+{
+    const double absoluteGate = loudnessToEnergy(ABSOLUTE_GATE_LUFS);
+
+    double sum = 0.0;
+    size_t count = 0;
+    for (double e : blockEnergies_) {
+        if (e > absoluteGate) {
+            sum += e;
+            ++count;
+        }
+    }
+    if (count == 0) return -std::numeric_limits<double>::infinity();
+
+    const double relativeGate = sum / count * std::pow(10.0, RELATIVE_GATE_LU / 10.0);
+    sum = 0.0;
+    count = 0;
+    for (double e : blockEnergies_) {
+        if (e > absoluteGate && e > relativeGate) {
+            sum += e;
+            ++count;
+        }
+    }
+    return energyToLoudness(sum / count);
+}
+
+double LoudnessMeter::getLoudnessRange() const
+{
+    const double absoluteGate = loudnessToEnergy(ABSOLUTE_GATE_LUFS);
+
+    double sum = 0.0;
+    size_t count = 0;
+    for (double e : shortTermEnergies_) {
+        if (e > absoluteGate) {
+            sum += e;
+            ++count;
+        }
+    }
+    if (count == 0) return 0.0;
+
+    const double relativeGate = sum / count * std::pow(10.0, RANGE_RELATIVE_GATE_LU / 10.0);
+    std::vector<double> gated;
+    gated.reserve(count);
+    for (double e : shortTermEnergies_) {
+        if (e > absoluteGate && e > relativeGate) {
+            gated.push_back(e);
+        }
+    }
+    if (gated.size() < 2) return 0.0;
+
+    // Percentiles of the short-term loudness distribution (energy order is the same)
+    std::sort(gated.begin(), gated.end());
+    const size_t last = gated.size() - 1;
+    const double low = gated[static_cast<size_t>(std::lround(last * RANGE_LOW_PERCENTILE))];
+    const double high = gated[static_cast<size_t>(std::lround(last * RANGE_HIGH_PERCENTILE))];
+    return energyToLoudness(high) - energyToLoudness(low);
+}
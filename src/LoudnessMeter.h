@@ -0,0 +1,69 @@
+#ifndef LOUDNESSMETER_H
+#define LOUDNESSMETER_H
+
+#include <vector>
+
+// ITU-R BS.1770 / EBU R128 measurement of a stream fed in blocks:
+// integrated loudness (LUFS), loudness range (LU, EBU Tech 3342), sample
+// peak and 4x oversampled true peak. Audio is K-weighted per channel (a
+// stereo pair runs in the two lanes of one SIMD register), mean square is
+// taken over 400 ms blocks with 75% overlap for the integrated value and
+// over 3 s windows every 100 ms for the range. All channels are weighted 1.0.
+class LoudnessMeter {
+public:
+    LoudnessMeter() = default;
+
+    void reset(int sampleRate, int numChannels);
+    void process(const float* const* channels, int numFrames);
+
+    // Minus infinity when nothing passed the absolute gate
+    double getIntegratedLoudness() const;
+
+    // Zero when fewer than two short-term windows passed the gates
+    double getLoudnessRange() const;
+
+    float getSamplePeak() const { return samplePeak_; }
+    float getTruePeak() const { return truePeak_; }
+
+private:
+    struct Biquad {
+        double b0, b1, b2, a1, a2;
+    };
+    struct ChannelState {
+        double z1[2];
+        double z2[2];
+    };
+
+    double filterChannel(const float* in, int numFrames, ChannelState& st) const;
+    double filterStereo(const float* left, const float* right, int numFrames);
+    void measurePeaks(const float* in, int numFrames, int channel);
+    void finishSubBlock();
+
+    int sampleRate_{48000};
+    int numChannels_{0};
+    Biquad shelf_{};
+    Biquad highPass_{};
+    std::vector<ChannelState> state_;
+
+    // 100 ms sub-blocks. A gating block is the mean of the last four, a
+    // short-term window the mean of the last thirty.
+    static const int SHORT_TERM_SUB_BLOCKS = 30;
+    int subBlockFrames_{4800};
+    int subBlockPos_{0};
+    double subBlockSum_{0.0};
+    double recentSubBlocks_[SHORT_TERM_SUB_BLOCKS]{};
+    int subBlockCount_{0};
+    std::vector<double> blockEnergies_;
+    std::vector<double> shortTermEnergies_;
+
+    // True peak: the last TAPS - 1 input samples per channel, then the block
+    static const int TRUE_PEAK_PHASES = 4;
+    static const int TRUE_PEAK_TAPS = 12;
+    std::vector<std::vector<float>> peakHistory_;
+    std::vector<float> peakScratch_;
+
+    float samplePeak_{0.0f};
+    float truePeak_{0.0f};
+};
+
+#endif // LOUDNESSMETER_H
@@ -4,16 +4,27 @@
 #include "Looper.h"
 #include "Recorder.h"
 #include "ClipManager.h"
+#include "ClipIndex.h"
+#include "RetroCapture.h"
+#include "Reamper.h"
+#include "PresetIO.h"
+#include "AuditionRenderer.h"
+#include "PresetPreview.h"
+#include "WaveformView.h"
+#include "ClipPlayer.h"
+#include "BackingTrack.h"
+#include "ClipListModel.h"
+#include "PresetBank.h"
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QFileDialog>
 #include <QDir>
-#include <QJsonDocument>
-#include <QJsonObject>
 #include <QFile>
 #include <QScreen>
 #include <QApplication>
 #include <QShowEvent>
+#include <QSignalBlocker>
+#include <algorithm>
 #include <cmath>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -24,6 +35,10 @@ MainWindow::MainWindow(QWidget *parent)
 {
     audioEngine_ = std::make_unique<AudioEngine>();
     clipManager_ = std::make_unique<ClipManager>();
+    presetBank_ = std::make_unique<PresetBank>();
+    presetBank_->setDirectory(getPresetsDirectory());
+    reamper_ = std::make_unique<Reamper>();
+    auditionRenderer_ = std::make_unique<AuditionRenderer>();
     
     mediaPlayer_ = new QMediaPlayer(this);
     audioOutput_ = new QAudioOutput(this);
@@ -36,6 +51,8 @@ MainWindow::MainWindow(QWidget *parent)
     connect(updateTimer_, &QTimer::timeout, this, &MainWindow::updateLooperStatus);
     connect(updateTimer_, &QTimer::timeout, this, &MainWindow::updateRecorderStatus);
     connect(updateTimer_, &QTimer::timeout, this, &MainWindow::updatePlaybackPosition);
+    connect(updateTimer_, &QTimer::timeout, this, &MainWindow::updatePresetPreview);
+    connect(updateTimer_, &QTimer::timeout, this, &MainWindow::updateBackingTrackStatus);
     updateTimer_->start(33); // ~30 Hz
     
     connect(mediaPlayer_, &QMediaPlayer::positionChanged, this, &MainWindow::updatePlaybackPosition);
@@ -669,6 +686,36 @@ void MainWindow::createEffectsPanel()
     connect(reverbMix_, &QSlider::valueChanged, this, &MainWindow::onEffectParameterChanged);
     
     effectsTab->addTab(reverbWidget, "Reverb");
+    
+    // Order Tab
+    QWidget* orderWidget = new QWidget();
+    QVBoxLayout* orderLayout = new QVBoxLayout(orderWidget);
+    QLabel* orderHelp = new QLabel("Effects run left to right. Group parallel branches in braces, "
+                                   "e.g. gate > comp > drive > eq > {delay | reverb | dry}. "
+                                   "Effects left out are skipped.");
+    orderHelp->setWordWrap(true);
+    orderLayout->addWidget(orderHelp);
+    
+    effectOrderEdit_ = new QLineEdit(QString::fromStdString(EffectGraph::standard().toString()));
+    orderLayout->addWidget(effectOrderEdit_);
+    
+    QHBoxLayout* orderButtons = new QHBoxLayout();
+    QPushButton* applyOrderButton = new QPushButton("Apply");
+    QPushButton* defaultOrderButton = new QPushButton("Default");
+    orderButtons->addWidget(applyOrderButton);
+    orderButtons->addWidget(defaultOrderButton);
+    orderButtons->addStretch();
+    orderLayout->addLayout(orderButtons);
+    orderLayout->addStretch();
+    
+    connect(applyOrderButton, &QPushButton::clicked, this, &MainWindow::onApplyEffectOrder);
+    connect(effectOrderEdit_, &QLineEdit::returnPressed, this, &MainWindow::onApplyEffectOrder);
+    connect(defaultOrderButton, &QPushButton::clicked, this, [this]() {
+        effectOrderEdit_->setText(QString::fromStdString(EffectGraph::standard().toString()));
+        onApplyEffectOrder();
+    });
+    
+    effectsTab->addTab(orderWidget, "Order");
 }
 
 void MainWindow::createLooperPanel()
@@ -704,6 +751,10 @@ void MainWindow::createLooperPanel()
     levelLayout->addWidget(looperLevelLabel_);
     layout->addLayout(levelLayout);
     
+    looperSyncCheck_ = new QCheckBox("Sync new loops to first loop length");
+    looperSyncCheck_->setChecked(true);
+    layout->addWidget(looperSyncCheck_);
+    
     looperStatusLabel_ = new QLabel("Status: Off");
     layout->addWidget(looperStatusLabel_);
     
@@ -721,12 +772,26 @@ void MainWindow::createLooperPanel()
     loopButtonsLayout_->addWidget(loopRemoveAllButton_);
     layout->addLayout(loopButtonsLayout_);
     connect(loopRemoveAllButton_, &QPushButton::clicked, this, &MainWindow::onLoopRemoveAll);
+
+    // Session save/load
+    QHBoxLayout* sessionLayout = new QHBoxLayout();
+    sessionLayout->setSpacing(8);
+    saveSessionButton_ = new QPushButton("Save Session");
+    loadSessionButton_ = new QPushButton("Load Session");
+    sessionLayout->addWidget(saveSessionButton_);
+    sessionLayout->addWidget(loadSessionButton_);
+    layout->addLayout(sessionLayout);
+    connect(saveSessionButton_, &QPushButton::clicked, this, &MainWindow::onSaveLooperSession);
+    connect(loadSessionButton_, &QPushButton::clicked, this, &MainWindow::onLoadLooperSession);
     
     connect(looperRecordButton_, &QPushButton::clicked, this, &MainWindow::onLooperRecord);
     connect(looperPlayButton_, &QPushButton::clicked, this, &MainWindow::onLooperPlayStop);
     connect(looperOverdubButton_, &QPushButton::clicked, this, &MainWindow::onLooperOverdub);
     connect(looperClearButton_, &QPushButton::clicked, this, &MainWindow::onLooperClear);
     connect(looperLevelSlider_, &QSlider::valueChanged, this, &MainWindow::onLooperLevelChanged);
+    connect(looperSyncCheck_, &QCheckBox::toggled, this, [this](bool on) {
+        if (audioEngine_->getLooper()) audioEngine_->getLooper()->setConformToMaster(on);
+    });
 }
 
 void MainWindow::createRecorderPanel()
@@ -755,6 +820,33 @@ void MainWindow::createRecorderPanel()
     nameLayout->addWidget(recordNameEdit_);
     layout->addLayout(nameLayout);
     
+    QHBoxLayout* formatLayout = new QHBoxLayout();
+    formatLayout->addWidget(new QLabel("Format:"));
+    recordFormatCombo_ = new QComboBox();
+    recordFormatCombo_->addItem("24-bit PCM");
+    recordFormatCombo_->addItem("16-bit PCM");
+    recordFormatCombo_->addItem("16-bit PCM (dithered)");
+    recordFormatCombo_->addItem("32-bit float");
+    recordFormatCombo_->addItem("FLAC 24-bit (lossless)");
+    recordFormatCombo_->addItem("FLAC 16-bit (lossless)");
+    formatLayout->addWidget(recordFormatCombo_);
+    layout->addLayout(formatLayout);
+    
+    // Stems are written sample-aligned with the mix for offline reamping
+    QHBoxLayout* stemLayout = new QHBoxLayout();
+    stemLayout->addWidget(new QLabel("Also record:"));
+    recordDryCheck_ = new QCheckBox("DI");
+    recordWetCheck_ = new QCheckBox("Wet");
+    recordLoopCheck_ = new QCheckBox("Loops");
+    stemLayout->addWidget(recordDryCheck_);
+    stemLayout->addWidget(recordWetCheck_);
+    stemLayout->addWidget(recordLoopCheck_);
+    stemLayout->addStretch();
+    layout->addLayout(stemLayout);
+    
+    recordCombinedCheck_ = new QCheckBox("Put stems in one multichannel file");
+    layout->addWidget(recordCombinedCheck_);
+    
     downloadButton_ = new QPushButton("Download/Save As");
     downloadButton_->setEnabled(false);
     downloadButton_->setMinimumHeight(24);
@@ -766,9 +858,39 @@ void MainWindow::createRecorderPanel()
     recordDurationLabel_ = new QLabel("Duration: 00:00");
     layout->addWidget(recordDurationLabel_);
     
+    // Retro capture keeps recent playing in memory without arming the recorder
+    QHBoxLayout* retroLayout = new QHBoxLayout();
+    retroCheck_ = new QCheckBox("Always keep last");
+    retroMinutesSpin_ = new QSpinBox();
+    retroMinutesSpin_->setRange(1, 30);
+    retroMinutesSpin_->setValue(5);
+    retroMinutesSpin_->setSuffix(" min");
+    retroCompactCheck_ = new QCheckBox("16-bit (half memory)");
+    retroLayout->addWidget(retroCheck_);
+    retroLayout->addWidget(retroMinutesSpin_);
+    retroLayout->addWidget(retroCompactCheck_);
+    retroLayout->addStretch();
+    layout->addLayout(retroLayout);
+    
+    QHBoxLayout* retroCaptureLayout = new QHBoxLayout();
+    retroCaptureButton_ = new QPushButton("Capture Last");
+    retroCaptureButton_->setEnabled(false);
+    retroCaptureButton_->setMinimumHeight(24);
+    retroSecondsSpin_ = new QSpinBox();
+    retroSecondsSpin_->setRange(5, 1800);
+    retroSecondsSpin_->setValue(60);
+    retroSecondsSpin_->setSuffix(" s");
+    retroCaptureLayout->addWidget(retroCaptureButton_);
+    retroCaptureLayout->addWidget(retroSecondsSpin_);
+    layout->addLayout(retroCaptureLayout);
+    
     connect(recordStartButton_, &QPushButton::clicked, this, &MainWindow::onStartRecording);
     connect(recordStopButton_, &QPushButton::clicked, this, &MainWindow::onStopRecording);
     connect(downloadButton_, &QPushButton::clicked, this, &MainWindow::onDownloadRecording);
+    connect(retroCheck_, &QCheckBox::toggled, this, &MainWindow::onRetroSettingsChanged);
+    connect(retroMinutesSpin_, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onRetroSettingsChanged);
+    connect(retroCompactCheck_, &QCheckBox::toggled, this, &MainWindow::onRetroSettingsChanged);
+    connect(retroCaptureButton_, &QPushButton::clicked, this, &MainWindow::onRetroCapture);
 }
 
 void MainWindow::createPlaybackPanel()
@@ -779,9 +901,30 @@ void MainWindow::createPlaybackPanel()
     panel->setMinimumHeight(260); // ensure adequate vertical space
     panel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     
-    clipList_ = new QListWidget();
+    // Filter and order; both work on the in-memory index
+    QHBoxLayout* clipFilterLayout = new QHBoxLayout();
+    clipFilterEdit_ = new QLineEdit();
+    clipFilterEdit_->setPlaceholderText("Filter clips");
+    clipFilterEdit_->setClearButtonEnabled(true);
+    clipSortCombo_ = new QComboBox();
+    clipSortCombo_->addItem("Newest first", ClipListModel::SortNewest);
+    clipSortCombo_->addItem("Oldest first", ClipListModel::SortOldest);
+    clipSortCombo_->addItem("Name", ClipListModel::SortName);
+    clipSortCombo_->addItem("Longest first", ClipListModel::SortLongest);
+    clipSortCombo_->addItem("Loudest first", ClipListModel::SortLoudest);
+    clipFilterLayout->addWidget(clipFilterEdit_, 1);
+    clipFilterLayout->addWidget(clipSortCombo_);
+    layout->addLayout(clipFilterLayout);
+    
+    // Rows are created on demand, so large libraries stay responsive
+    clipModel_ = new ClipListModel(clipManager_->getIndex(), this);
+    clipList_ = new QListView();
+    clipList_->setModel(clipModel_);
+    clipList_->setUniformItemSizes(true);
+    clipList_->setLayoutMode(QListView::Batched);
     clipList_->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     clipList_->setMinimumHeight(120);
+    clipList_->setSelectionMode(QAbstractItemView::ExtendedSelection);
     layout->addWidget(clipList_);
     
     QHBoxLayout* transportLayout = new QHBoxLayout();
@@ -793,6 +936,10 @@ void MainWindow::createPlaybackPanel()
     transportLayout->addWidget(stopPlayButton_);
     layout->addLayout(transportLayout);
     
+    // Drawn from the clip's peak sidecar; click to seek, wheel to zoom
+    waveformView_ = new WaveformView();
+    layout->addWidget(waveformView_);
+    
     playbackProgressBar_ = new QProgressBar();
     playbackProgressBar_->setRange(0, 100);
     layout->addWidget(playbackProgressBar_);
@@ -808,32 +955,134 @@ void MainWindow::createPlaybackPanel()
     volumeLayout->addWidget(clipVolumeSlider_);
     clipVolumeLabel_ = new QLabel("100%");
     volumeLayout->addWidget(clipVolumeLabel_);
+    clipThroughChainCheck_ = new QCheckBox("Through effects");
+    clipThroughChainCheck_->setToolTip("Feed the clip into the effects chain instead of the output, like a live DI");
+    volumeLayout->addWidget(clipThroughChainCheck_);
     layout->addLayout(volumeLayout);
     
+    // Backing track streamed from disk at the engine rate, for playing along
+    QHBoxLayout* backingLayout = new QHBoxLayout();
+    backingLoadButton_ = new QPushButton("Backing Track...");
+    backingLoadButton_->setToolTip("Load a WAV or FLAC (any sample rate) to play along with");
+    backingPlayButton_ = new QPushButton("Play");
+    backingStopButton_ = new QPushButton("Stop");
+    backingPlayButton_->setEnabled(false);
+    backingStopButton_->setEnabled(false);
+    backingThroughChainCheck_ = new QCheckBox("Through effects");
+    backingVolumeSlider_ = new QSlider(Qt::Horizontal);
+    backingVolumeSlider_->setRange(0, 100);
+    backingVolumeSlider_->setValue(80);
+    backingVolumeSlider_->setMaximumWidth(100);
+    backingStatusLabel_ = new QLabel("No backing track");
+    backingLayout->addWidget(backingLoadButton_);
+    backingLayout->addWidget(backingPlayButton_);
+    backingLayout->addWidget(backingStopButton_);
+    backingLayout->addWidget(backingThroughChainCheck_);
+    backingLayout->addWidget(backingVolumeSlider_);
+    backingLayout->addWidget(backingStatusLabel_, 1);
+    layout->addLayout(backingLayout);
+    
     QHBoxLayout* manageLayout = new QHBoxLayout();
     renameButton_ = new QPushButton("Rename");
     deleteButton_ = new QPushButton("Delete");
     revealButton_ = new QPushButton("Reveal in Explorer");
+    convertFlacButton_ = new QPushButton("Convert to FLAC");
     manageLayout->addWidget(renameButton_);
     manageLayout->addWidget(deleteButton_);
     manageLayout->addWidget(revealButton_);
+    manageLayout->addWidget(convertFlacButton_);
     layout->addLayout(manageLayout);
+    
+    // Export a copy, optionally normalised to a loudness target from the index
+    QHBoxLayout* exportLayout = new QHBoxLayout();
+    exportButton_ = new QPushButton("Export...");
+    exportNormalizeCheck_ = new QCheckBox("Normalise to");
+    exportNormalizeCheck_->setToolTip("Apply gain on export so the clip reaches the target integrated loudness (true peak kept at or below -1 dBTP)");
+    exportTargetSpin_ = new QSpinBox();
+    exportTargetSpin_->setRange(-36, -6);
+    exportTargetSpin_->setValue(-14);
+    exportTargetSpin_->setSuffix(" LUFS");
+    exportLayout->addWidget(exportButton_);
+    exportLayout->addWidget(exportNormalizeCheck_);
+    exportLayout->addWidget(exportTargetSpin_);
+    exportLayout->addStretch();
+    layout->addLayout(exportLayout);
+    
+    // Offline render of DI clips through the current settings
+    QHBoxLayout* reampLayout = new QHBoxLayout();
+    reampButton_ = new QPushButton("Reamp");
+    reampButton_->setToolTip("Render the selected DI clips through the current effects, faster than real time");
+    cancelReampButton_ = new QPushButton("Cancel");
+    cancelReampButton_->setEnabled(false);
+    reampStatusLabel_ = new QLabel("");
+    reampLayout->addWidget(reampButton_);
+    reampLayout->addWidget(cancelReampButton_);
+    reampLayout->addWidget(reampStatusLabel_, 1);
+    layout->addLayout(reampLayout);
 
     // Slight spacing adjustments so controls are not cramped
     layout->setSpacing(6);
     
-    connect(clipList_, &QListWidget::itemSelectionChanged, this, &MainWindow::onClipSelected);
+    connect(clipList_->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWindow::onClipSelected);
+    connect(clipList_->selectionModel(), &QItemSelectionModel::currentChanged, this, &MainWindow::onClipSelected);
+    connect(clipFilterEdit_, &QLineEdit::textChanged, clipModel_, &ClipListModel::setFilter);
+    connect(clipSortCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int) {
+        clipModel_->setSortOrder(static_cast<ClipListModel::SortOrder>(clipSortCombo_->currentData().toInt()));
+    });
     connect(playButton_, &QPushButton::clicked, this, &MainWindow::onPlayClip);
     connect(pauseButton_, &QPushButton::clicked, this, &MainWindow::onPauseClip);
     connect(stopPlayButton_, &QPushButton::clicked, this, &MainWindow::onStopClip);
     connect(renameButton_, &QPushButton::clicked, this, &MainWindow::onRenameClip);
     connect(deleteButton_, &QPushButton::clicked, this, &MainWindow::onDeleteClip);
     connect(revealButton_, &QPushButton::clicked, this, &MainWindow::onRevealClip);
+    connect(convertFlacButton_, &QPushButton::clicked, this, &MainWindow::onConvertClipToFlac);
+    connect(exportButton_, &QPushButton::clicked, this, &MainWindow::onExportClip);
+    connect(reampButton_, &QPushButton::clicked, this, &MainWindow::onReampClips);
+    connect(cancelReampButton_, &QPushButton::clicked, this, [this]() { reamper_->cancel(); });
     connect(clipVolumeSlider_, &QSlider::valueChanged, this, &MainWindow::onClipVolumeChanged);
+    connect(clipThroughChainCheck_, &QCheckBox::toggled, this, [this](bool checked) {
+        audioEngine_->getClipPlayer()->setRoute(checked ? ClipPlayer::Route::Chain : ClipPlayer::Route::Output);
+    });
+    connect(waveformView_, &WaveformView::seekRequested, this, &MainWindow::onWaveformSeek);
+    connect(backingLoadButton_, &QPushButton::clicked, this, &MainWindow::onLoadBackingTrack);
+    connect(backingPlayButton_, &QPushButton::clicked, this, &MainWindow::onBackingPlayPause);
+    connect(backingStopButton_, &QPushButton::clicked, this, [this]() { audioEngine_->getBackingTrack()->stop(); });
+    connect(backingThroughChainCheck_, &QCheckBox::toggled, this, [this](bool checked) {
+        audioEngine_->getBackingTrack()->setPlacement(checked ? BackingTrack::Placement::PreChain
+                                                              : BackingTrack::Placement::PostChain);
+    });
+    connect(backingVolumeSlider_, &QSlider::valueChanged, this, [this](int value) {
+        audioEngine_->getBackingTrack()->setVolume(value / 100.0f);
+    });
+    audioEngine_->getBackingTrack()->setVolume(backingVolumeSlider_->value() / 100.0f);
     
-    // Populate clip list
-    QStringList clips = clipManager_->getClipList();
-    clipList_->addItems(clips);
+    // The model follows the index itself; this only updates the buttons and waveform
+    connect(clipManager_->getIndex(), &ClipIndex::clipsChanged, this, &MainWindow::onClipSelected);
+    refreshClipList();
+}
+
+void MainWindow::refreshClipList()
+{
+    // Applied as row inserts/removals, so selection and scroll position are kept
+    clipModel_->refresh();
+    onClipSelected();
+}
+
+QString MainWindow::selectedClipName() const
+{
+    return clipModel_->clipName(clipList_->currentIndex().row());
+}
+
+QStringList MainWindow::selectedClipNames() const
+{
+    // In list order rather than the order rows were clicked
+    QModelIndexList rows = clipList_->selectionModel()->selectedRows();
+    std::sort(rows.begin(), rows.end());
+    QStringList names;
+    for (const QModelIndex& row : rows) {
+        names << clipModel_->clipName(row.row());
+    }
+    return names;
 }
 
 void MainWindow::createPresetsPanel()
@@ -847,6 +1096,7 @@ void MainWindow::createPresetsPanel()
     presetList_ = new QListWidget();
     presetList_->setMinimumHeight(110);
     presetList_->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    presetList_->setMouseTracking(true); // hover starts a background preview render
     layout->addWidget(presetList_);
     
     QHBoxLayout* nameLayout = new QHBoxLayout();
@@ -860,14 +1110,67 @@ void MainWindow::createPresetsPanel()
     savePresetButton_ = new QPushButton("Save");
     loadPresetButton_ = new QPushButton("Load");
     deletePresetButton_ = new QPushButton("Delete");
+    previewButton_ = new QPushButton("Preview");
+    previewButton_->setToolTip("Hear your last phrase through the selected preset without loading it");
     buttonLayout->addWidget(savePresetButton_);
     buttonLayout->addWidget(loadPresetButton_);
     buttonLayout->addWidget(deletePresetButton_);
+    buttonLayout->addWidget(previewButton_);
     layout->addLayout(buttonLayout);
     
+    // Batch render of a DI file through every preset or a parameter grid
+    QHBoxLayout* auditionLayout = new QHBoxLayout();
+    auditionButton_ = new QPushButton("Audition...");
+    auditionButton_->setToolTip("Render a DI clip through every saved preset or a grid of settings");
+    auditionStatusLabel_ = new QLabel("");
+    auditionLayout->addWidget(auditionButton_);
+    auditionLayout->addWidget(auditionStatusLabel_, 1);
+    layout->addLayout(auditionLayout);
+    
+    // A/B morph between two captured settings; the chain interpolates them itself
+    QHBoxLayout* morphLayout = new QHBoxLayout();
+    morphSetAButton_ = new QPushButton("Set A");
+    morphSetAButton_->setToolTip("Capture the current settings as morph end A");
+    morphSetBButton_ = new QPushButton("Set B");
+    morphSetBButton_->setToolTip("Capture the current settings as morph end B");
+    morphSlider_ = new QSlider(Qt::Horizontal);
+    morphSlider_->setRange(0, 100);
+    morphSlider_->setValue(0);
+    morphButton_ = new QPushButton("Morph");
+    morphButton_->setCheckable(true);
+    morphButton_->setToolTip("Blend continuously between A and B with the slider; "
+                             "effect controls are ignored until morphing is switched off");
+    morphLayout->addWidget(morphSetAButton_);
+    morphLayout->addWidget(new QLabel("A"));
+    morphLayout->addWidget(morphSlider_, 1);
+    morphLayout->addWidget(new QLabel("B"));
+    morphLayout->addWidget(morphSetBButton_);
+    morphLayout->addWidget(morphButton_);
+    layout->addLayout(morphLayout);
+    
     connect(savePresetButton_, &QPushButton::clicked, this, &MainWindow::onSavePreset);
     connect(loadPresetButton_, &QPushButton::clicked, this, &MainWindow::onLoadPreset);
     connect(deletePresetButton_, &QPushButton::clicked, this, &MainWindow::onDeletePreset);
+    connect(auditionButton_, &QPushButton::clicked, this, &MainWindow::onAuditionPresets);
+    connect(previewButton_, &QPushButton::clicked, this, &MainWindow::onPreviewPreset);
+    connect(presetList_, &QListWidget::itemEntered, this, &MainWindow::onPresetHovered);
+    connect(presetList_, &QListWidget::currentItemChanged, this,
+            [this](QListWidgetItem* current, QListWidgetItem*) { onPresetHovered(current); });
+    connect(presetBank_.get(), &PresetBank::presetsChanged, this, &MainWindow::refreshPresetList);
+    connect(morphSetAButton_, &QPushButton::clicked, this, [this]() {
+        ParamValues values = audioEngine_->getDSPChain()->getParams().snapshot();
+        morphA_.assign(values.begin(), values.end());
+        if (morphButton_->isChecked()) onMorphToggled(true);
+    });
+    connect(morphSetBButton_, &QPushButton::clicked, this, [this]() {
+        ParamValues values = audioEngine_->getDSPChain()->getParams().snapshot();
+        morphB_.assign(values.begin(), values.end());
+        if (morphButton_->isChecked()) onMorphToggled(true);
+    });
+    connect(morphSlider_, &QSlider::valueChanged, this, [this](int value) {
+        audioEngine_->getDSPChain()->setMorphPosition(value / 100.0f);
+    });
+    connect(morphButton_, &QPushButton::toggled, this, &MainWindow::onMorphToggled);
     
     refreshPresetList();
 }
@@ -882,8 +1185,12 @@ void MainWindow::onStartEngine()
     int bufferSize = bufferSizeSpin_->value();
     bool wasapi = wasapiCheck_->isChecked();
     
+    // A loaded clip may not match the new sample rate
+    audioEngine_->getClipPlayer()->unload();
+    
     if (audioEngine_->start(inputId, outputId, sampleRate, bufferSize, wasapi)) {
         engineRunning_ = true;
+        presetBank_->setSampleRate(audioEngine_->getSampleRate());
         startButton_->setEnabled(false);
         stopButton_->setEnabled(true);
         
@@ -900,6 +1207,8 @@ void MainWindow::onStartEngine()
 void MainWindow::onStopEngine()
 {
     audioEngine_->stop();
+    audioEngine_->getClipPlayer()->pause();
+    audioEngine_->getBackingTrack()->pause();
     engineRunning_ = false;
     startButton_->setEnabled(true);
     stopButton_->setEnabled(false);
@@ -926,7 +1235,7 @@ void MainWindow::onResetPeaks()
 
 void MainWindow::onEffectBypassChanged()
 {
-    if (!audioEngine_->getDSPChain()) return;
+    if (!audioEngine_->getDSPChain() || syncingControls_) return;
     
     auto& params = audioEngine_->getDSPChain()->getParams();
     params.gateBypass.store(gateBypass_->isChecked());
@@ -940,7 +1249,7 @@ void MainWindow::onEffectBypassChanged()
 
 void MainWindow::onEffectParameterChanged()
 {
-    if (!audioEngine_->getDSPChain()) return;
+    if (!audioEngine_->getDSPChain() || syncingControls_) return;
     
     auto& params = audioEngine_->getDSPChain()->getParams();
     
@@ -1060,14 +1369,95 @@ void MainWindow::onLooperLevelChanged(int value)
     looperLevelLabel_->setText(QString::number(value) + "%");
 }
 
+void MainWindow::onSaveLooperSession()
+{
+    auto* looper = audioEngine_->getLooper();
+    if (!looper) return;
+    if (looper->getSlotCount() == 0) {
+        QMessageBox::warning(this, "Warning", "There are no loop slots to save!");
+        return;
+    }
+    
+    QString filepath = QFileDialog::getSaveFileName(this, "Save Looper Session",
+        getSessionsDirectory(), "Looper Sessions (*.gls)");
+    if (filepath.isEmpty()) return;
+    if (!filepath.endsWith(".gls")) filepath += ".gls";
+    
+    // Written on the looper's background thread; completion shows in the status line
+    if (looper->saveSession(filepath.toStdString())) {
+        sessionSaveReported_ = false;
+        saveSessionButton_->setEnabled(false);
+    }
+}
+
+void MainWindow::onLoadLooperSession()
+{
+    auto* looper = audioEngine_->getLooper();
+    if (!looper) return;
+    
+    QString filepath = QFileDialog::getOpenFileName(this, "Load Looper Session",
+        getSessionsDirectory(), "Looper Sessions (*.gls)");
+    if (filepath.isEmpty()) return;
+    
+    if (!looper->loadSession(filepath.toStdString())) {
+        QMessageBox::critical(this, "Error", "Failed to load looper session!");
+        return;
+    }
+    looperLevelSlider_->setValue(static_cast<int>(looper->getLoopLevel() * 100));
+    rebuildLoopSlotButtons();
+}
+
 void MainWindow::onStartRecording()
 {
     if (!audioEngine_->getRecorder()) return;
     
-    audioEngine_->getRecorder()->startRecording();
+    // The take streams straight into the clips folder under its final name.
+    // A previous unsaved take keeps its generated name.
+    if (downloadButton_->isEnabled()) {
+        recordNameEdit_->clear();
+    }
+    if (recordNameEdit_->text().isEmpty()) {
+        currentClipName_ = clipManager_->generateClipName();
+        recordNameEdit_->setText(currentClipName_);
+    } else {
+        currentClipName_ = recordNameEdit_->text();
+    }
+    static const SampleFormat formats[] = { SampleFormat::Pcm24, SampleFormat::Pcm16,
+                                            SampleFormat::Pcm16, SampleFormat::Float32,
+                                            SampleFormat::Pcm24, SampleFormat::Pcm16 };
+    int formatIndex = recordFormatCombo_->currentIndex();
+    bool flac = formatIndex >= 4;
+    QString filepath = clipManager_->getClipsDirectory() + "/" + currentClipName_ + (flac ? ".flac" : ".wav");
+    QString existingPath = clipManager_->getClipPath(currentClipName_);
+    if (QFile::exists(existingPath)) {
+        auto reply = QMessageBox::question(this, "Overwrite Clip",
+            QString("A clip named '%1' already exists. Overwrite it?").arg(currentClipName_),
+            QMessageBox::Yes | QMessageBox::No);
+        if (reply != QMessageBox::Yes) return;
+        if (existingPath != filepath) {
+            QFile::remove(existingPath); // the old clip was stored in the other format
+        }
+    }
+    
+    audioEngine_->getRecorder()->setOutputFormat(formats[formatIndex], formatIndex == 2);
+    audioEngine_->getRecorder()->setFlacEncoding(flac);
+    int stems = (recordDryCheck_->isChecked() ? Recorder::StemDry : 0)
+              | (recordWetCheck_->isChecked() ? Recorder::StemWet : 0)
+              | (recordLoopCheck_->isChecked() ? Recorder::StemLoop : 0);
+    audioEngine_->getRecorder()->setStems(stems, recordCombinedCheck_->isChecked());
+    audioEngine_->getRecorder()->setAutoSavePath(filepath.toStdString());
+    if (!audioEngine_->getRecorder()->startRecording()) {
+        QMessageBox::critical(this, "Error", QString("Failed to create recording file:\n%1").arg(filepath));
+        return;
+    }
     isRecording_ = true;
     recordStartButton_->setEnabled(false);
     recordStopButton_->setEnabled(true);
+    recordFormatCombo_->setEnabled(false);
+    recordDryCheck_->setEnabled(false);
+    recordWetCheck_->setEnabled(false);
+    recordLoopCheck_->setEnabled(false);
+    recordCombinedCheck_->setEnabled(false);
     downloadButton_->setEnabled(false);
     recordStatusLabel_->setText("Status: Recording...");
 }
@@ -1080,20 +1470,25 @@ void MainWindow::onStopRecording()
     isRecording_ = false;
     recordStartButton_->setEnabled(true);
     recordStopButton_->setEnabled(false);
+    recordFormatCombo_->setEnabled(true);
+    recordDryCheck_->setEnabled(true);
+    recordWetCheck_->setEnabled(true);
+    recordLoopCheck_->setEnabled(true);
+    recordCombinedCheck_->setEnabled(true);
     
     if (audioEngine_->getRecorder()->hasRecordedAudio()) {
+        // Already on disk; Download/Save As renames the clip if the name was changed
         downloadButton_->setEnabled(true);
-        recordStatusLabel_->setText("Status: Ready to save");
-        
-        // Generate default name if empty
-        if (recordNameEdit_->text().isEmpty()) {
-            currentClipName_ = clipManager_->generateClipName();
-            recordNameEdit_->setText(currentClipName_);
-        } else {
-            currentClipName_ = recordNameEdit_->text();
-        }
+        recordStatusLabel_->setText(QString("Status: Saved as %1").arg(currentClipName_));
+        // The take grew after it was first indexed; re-analyse it for its waveform
+        clipManager_->getIndex()->sync();
+        refreshClipList();
     } else {
         recordStatusLabel_->setText("Status: No audio recorded");
+        for (const std::string& path : audioEngine_->getRecorder()->getTakePaths()) {
+            QFile::remove(QString::fromStdString(path));
+        }
+        audioEngine_->getRecorder()->clearRecording();
     }
 }
 
@@ -1103,19 +1498,19 @@ void MainWindow::onDownloadRecording()
     
     QString clipName = recordNameEdit_->text();
     if (clipName.isEmpty()) {
-        clipName = clipManager_->generateClipName();
+        clipName = currentClipName_;
         recordNameEdit_->setText(clipName);
     }
     
-    QString filepath = clipManager_->getClipsDirectory() + "/" + clipName + ".wav";
+    QString takeSuffix = QFileInfo(QString::fromStdString(audioEngine_->getRecorder()->getTakePath())).suffix();
+    QString filepath = clipManager_->getClipsDirectory() + "/" + clipName + "." + takeSuffix;
     
     if (audioEngine_->getRecorder()->saveToFile(filepath.toStdString())) {
         QMessageBox::information(this, "Success", 
             QString("Recording saved as:\n%1").arg(clipName));
         
         // Refresh clip list
-        clipList_->clear();
-        clipList_->addItems(clipManager_->getClipList());
+        refreshClipList();
         
         // Clear recorder
         audioEngine_->getRecorder()->clearRecording();
@@ -1127,54 +1522,121 @@ void MainWindow::onDownloadRecording()
     }
 }
 
+void MainWindow::onRetroSettingsChanged()
+{
+    auto* retro = audioEngine_->getRetroCapture();
+    if (!retro) return;
+    
+    // Reallocates the history ring; what was held so far is dropped
+    int minutes = retroCheck_->isChecked() ? retroMinutesSpin_->value() : 0;
+    retro->configure(minutes * 60, retroCompactCheck_->isChecked());
+    retroSecondsSpin_->setMaximum(qMax(5, minutes * 60));
+    retroCaptureButton_->setEnabled(retroCheck_->isChecked());
+}
+
+void MainWindow::onRetroCapture()
+{
+    auto* retro = audioEngine_->getRetroCapture();
+    if (!retro || !retro->isEnabled()) return;
+    
+    if (retro->getAvailableSeconds() <= 0.0f) {
+        recordStatusLabel_->setText("Status: Nothing played yet");
+        return;
+    }
+    
+    // Written on a background thread as <name>.wav (wet) and <name>_DI.wav
+    retroClipName_ = clipManager_->generateClipName();
+    QString base = clipManager_->getClipsDirectory() + "/" + retroClipName_;
+    if (retro->captureLast(static_cast<float>(retroSecondsSpin_->value()),
+                           (base + ".wav").toStdString(), (base + "_DI.wav").toStdString(), SampleFormat::Pcm24)) {
+        retroCaptureReported_ = false;
+        retroCaptureButton_->setEnabled(false);
+        recordStatusLabel_->setText("Status: Capturing...");
+    }
+}
+
 void MainWindow::onClipSelected()
 {
     // Enable/disable buttons based on selection
-    bool hasSelection = !clipList_->selectedItems().isEmpty();
+    bool hasSelection = clipList_->selectionModel()->hasSelection();
     playButton_->setEnabled(hasSelection);
     pauseButton_->setEnabled(hasSelection);
     stopPlayButton_->setEnabled(hasSelection);
     renameButton_->setEnabled(hasSelection);
     deleteButton_->setEnabled(hasSelection);
     revealButton_->setEnabled(hasSelection);
+    convertFlacButton_->setEnabled(hasSelection && !clipManager_->isBusy());
+    exportButton_->setEnabled(hasSelection && !clipManager_->isBusy());
+    reampButton_->setEnabled(hasSelection && !reamper_->isRunning());
+    
+    // Waveform of the current clip. Also retried on every index update, since
+    // the sidecar of a new take appears once its analysis finishes.
+    QString clipName = selectedClipName();
+    if (clipName.isEmpty()) {
+        waveformView_->clear();
+        waveformClip_.clear();
+    } else if (clipName != waveformClip_ || !waveformView_->hasPeaks()) {
+        QFileInfo clipFile(clipManager_->getClipPath(clipName));
+        waveformView_->setPeakFile(clipManager_->getPeaksPath(clipName), clipFile.size(),
+                                   clipFile.lastModified().toMSecsSinceEpoch());
+        waveformClip_ = clipName;
+    }
 }
 
 void MainWindow::onPlayClip()
 {
-    if (clipList_->selectedItems().isEmpty()) return;
+    if (!clipList_->selectionModel()->hasSelection()) return;
     
-    QString clipName = clipList_->currentItem()->text();
-    QString filepath = clipManager_->getClipsDirectory() + "/" + clipName + ".wav";
+    QString clipName = selectedClipName();
+    QString filepath = clipManager_->getClipPath(clipName);
+    
+    // Played by the engine, mixed with live playing on the same device
+    ClipPlayer* player = audioEngine_->getClipPlayer();
+    if (audioEngine_->isRunning()) {
+        if ((player->isLoaded() && player->getPath() == filepath.toStdString())
+            || player->load(filepath.toStdString(), audioEngine_->getSampleRate())) {
+            mediaPlayer_->stop();
+            player->play();
+            return;
+        }
+    }
     
+    // No engine: system player
+    player->unload();
     mediaPlayer_->setSource(QUrl::fromLocalFile(filepath));
     mediaPlayer_->play();
 }
 
 void MainWindow::onPauseClip()
 {
+    audioEngine_->getClipPlayer()->pause();
     mediaPlayer_->pause();
 }
 
 void MainWindow::onStopClip()
 {
+    audioEngine_->getClipPlayer()->stop();
     mediaPlayer_->stop();
     playbackProgressBar_->setValue(0);
+    waveformView_->setPosition(0.0);
     playbackPositionLabel_->setText("00:00 / 00:00");
 }
 
 void MainWindow::onRenameClip()
 {
-    if (clipList_->selectedItems().isEmpty()) return;
+    if (!clipList_->selectionModel()->hasSelection()) return;
     
-    QString oldName = clipList_->currentItem()->text();
+    QString oldName = selectedClipName();
     bool ok;
     QString newName = QInputDialog::getText(this, "Rename Clip", 
         "Enter new name:", QLineEdit::Normal, oldName, &ok);
     
     if (ok && !newName.isEmpty() && newName != oldName) {
+        audioEngine_->getClipPlayer()->unload();
+        waveformView_->clear();
+        waveformClip_.clear();
         if (clipManager_->renameClip(oldName, newName)) {
-            clipList_->clear();
-            clipList_->addItems(clipManager_->getClipList());
+            refreshClipList();
             QMessageBox::information(this, "Success", "Clip renamed successfully!");
         } else {
             QMessageBox::critical(this, "Error", "Failed to rename clip!");
@@ -1184,9 +1646,9 @@ void MainWindow::onRenameClip()
 
 void MainWindow::onDeleteClip()
 {
-    if (clipList_->selectedItems().isEmpty()) return;
+    if (!clipList_->selectionModel()->hasSelection()) return;
     
-    QString clipName = clipList_->currentItem()->text();
+    QString clipName = selectedClipName();
     
     auto reply = QMessageBox::question(this, "Delete Clip",
         QString("Are you sure you want to delete '%1'?").arg(clipName),
@@ -1198,14 +1660,16 @@ void MainWindow::onDeleteClip()
             mediaPlayer_->stop();
             mediaPlayer_->setSource(QUrl()); // release file handle
         }
+        audioEngine_->getClipPlayer()->unload();
+        waveformView_->clear();
+        waveformClip_.clear();
         // Attempt deletion
         if (clipManager_->deleteClip(clipName)) {
-            clipList_->clear();
-            clipList_->addItems(clipManager_->getClipList());
+            refreshClipList();
             QMessageBox::information(this, "Success", "Clip deleted successfully!");
         } else {
             // Provide more diagnostic info
-            QString path = clipManager_->getClipsDirectory() + "/" + clipName + ".wav";
+            QString path = clipManager_->getClipPath(clipName);
             QFileInfo fi(path);
             QString reason;
             if (!fi.exists()) reason = "File does not exist at expected path.";
@@ -1217,15 +1681,131 @@ void MainWindow::onDeleteClip()
 
 void MainWindow::onRevealClip()
 {
-    if (clipList_->selectedItems().isEmpty()) return;
+    if (!clipList_->selectionModel()->hasSelection()) return;
     
-    QString clipName = clipList_->currentItem()->text();
+    QString clipName = selectedClipName();
     clipManager_->revealInExplorer(clipName);
 }
 
+void MainWindow::onConvertClipToFlac()
+{
+    if (!clipList_->selectionModel()->hasSelection() || clipManager_->isBusy()) return;
+    
+    QString clipName = selectedClipName();
+    if (QFileInfo(clipManager_->getClipPath(clipName)).suffix() == "flac") {
+        QMessageBox::information(this, "Convert to FLAC", QString("'%1' is already a FLAC clip.").arg(clipName));
+        return;
+    }
+    
+    // Release the file if it is loaded in the player
+    if (mediaPlayer_->playbackState() != QMediaPlayer::StoppedState) {
+        mediaPlayer_->stop();
+    }
+    mediaPlayer_->setSource(QUrl());
+    audioEngine_->getClipPlayer()->unload();
+    waveformView_->clear();
+    waveformClip_.clear();
+    
+    // Encoded on a worker; updateRecorderStatus() reports the result
+    if (!clipManager_->startConvertToFlac(clipName)) {
+        QMessageBox::critical(this, "Error", QString("Failed to convert '%1' to FLAC!").arg(clipName));
+        return;
+    }
+    clipJobName_ = clipName;
+    clipJobIsExport_ = false;
+    clipJobReported_ = false;
+    convertFlacButton_->setEnabled(false);
+    exportButton_->setEnabled(false);
+    recordStatusLabel_->setText(QString("Status: Converting %1 to FLAC...").arg(clipName));
+}
+
+void MainWindow::onExportClip()
+{
+    if (!clipList_->selectionModel()->hasSelection() || clipManager_->isBusy()) return;
+    
+    QString clipName = selectedClipName();
+    
+    const QString wav24 = "WAV 24-bit (*.wav)";
+    const QString wav16 = "WAV 16-bit (*.wav)";
+    const QString wavFloat = "WAV 32-bit float (*.wav)";
+    const QString flac16 = "FLAC 16-bit (*.flac)";
+    const QString flac24 = "FLAC 24-bit (*.flac)";
+    QString filter = wav24;
+    QString path = QFileDialog::getSaveFileName(this, "Export Clip",
+        QDir::homePath() + "/" + clipName + ".wav",
+        QStringList({ wav24, wav16, wavFloat, flac24, flac16 }).join(";;"), &filter);
+    if (path.isEmpty()) return;
+    
+    SampleFormat format = SampleFormat::Pcm24;
+    if (filter == wav16 || filter == flac16) format = SampleFormat::Pcm16;
+    else if (filter == wavFloat) format = SampleFormat::Float32;
+    const bool flac = filter == flac16 || filter == flac24;
+    if (flac != (QFileInfo(path).suffix().compare("flac", Qt::CaseInsensitive) == 0)) {
+        path = QFileInfo(path).path() + "/" + QFileInfo(path).completeBaseName() + (flac ? ".flac" : ".wav");
+    }
+    
+    // Measured (if needed) and written on a worker; updateRecorderStatus() reports the result
+    if (!clipManager_->startExport(clipName, path, format, exportNormalizeCheck_->isChecked(),
+                                   exportTargetSpin_->value())) {
+        QMessageBox::critical(this, "Error", QString("Failed to export '%1'!").arg(clipName));
+        return;
+    }
+    clipJobName_ = clipName;
+    clipJobIsExport_ = true;
+    clipJobNormalized_ = exportNormalizeCheck_->isChecked();
+    clipJobReported_ = false;
+    convertFlacButton_->setEnabled(false);
+    exportButton_->setEnabled(false);
+    recordStatusLabel_->setText(QString("Status: Exporting %1...").arg(clipName));
+}
+
+void MainWindow::onReampClips()
+{
+    if (!clipList_->selectionModel()->hasSelection() || reamper_->isRunning()) return;
+    
+    QStringList clips = clipManager_->getClipList();
+    QDir dir(clipManager_->getClipsDirectory());
+    std::vector<ReampJob> jobs;
+    QStringList queuedSources;
+    QStringList reservedNames;
+    
+    for (const QString& clipName : selectedClipNames()) {
+        // A take's DI stem is preferred over its mix; other clips are used as-is
+        QString source = clipName;
+        if (!source.endsWith("_DI") && clips.contains(source + "_DI")) {
+            source += "_DI";
+        }
+        if (queuedSources.contains(source)) continue;
+        
+        QString sourcePath = clipManager_->getClipPath(source);
+        QString base = source.endsWith("_DI") ? source.left(source.length() - 3) : source;
+        QString outName = base + "_Reamp";
+        for (int n = 2; clips.contains(outName) || reservedNames.contains(outName); ++n) {
+            outName = QString("%1_Reamp%2").arg(base).arg(n);
+        }
+        reservedNames << outName;
+        queuedSources << source;
+        jobs.push_back({ sourcePath.toStdString(), dir.filePath(outName + ".wav").toStdString() });
+    }
+    
+    if (jobs.empty()) {
+        QMessageBox::information(this, "Reamp", "No clips to reamp in the selection.");
+        return;
+    }
+    
+    DSPChain* chain = audioEngine_->getDSPChain();
+    if (reamper_->start(jobs, chain->getParams(), chain->getEffectGraph(), SampleFormat::Pcm24)) {
+        reampReported_ = false;
+        reampButton_->setEnabled(false);
+        cancelReampButton_->setEnabled(true);
+        reampStatusLabel_->setText(QString("Reamping %1 clip(s)...").arg(jobs.size()));
+    }
+}
+
 void MainWindow::onClipVolumeChanged(int value)
 {
     audioOutput_->setVolume(value / 100.0f);
+    audioEngine_->getClipPlayer()->setVolume(value / 100.0f);
     clipVolumeLabel_->setText(QString::number(value) + "%");
 }
 
@@ -1238,7 +1818,6 @@ void MainWindow::onSavePreset()
     }
     
     savePresetToFile(presetName);
-    refreshPresetList();
     QMessageBox::information(this, "Success", 
         QString("Preset '%1' saved successfully!").arg(presetName));
 }
@@ -1274,7 +1853,7 @@ void MainWindow::onDeletePreset()
         QString filepath = getPresetsDirectory() + "/" + presetName + ".json";
         QFile file(filepath);
         if (file.remove()) {
-            refreshPresetList();
+            presetBank_->sync();
             QMessageBox::information(this, "Success", "Preset deleted successfully!");
         } else {
             QMessageBox::critical(this, "Error", "Failed to delete preset!");
@@ -1282,6 +1861,165 @@ void MainWindow::onDeletePreset()
     }
 }
 
+bool MainWindow::requestPresetPreview(const QString& name)
+{
+    std::shared_ptr<const PresetBank::Preset> preset = presetBank_->find(name);
+    if (!preset) return false;
+    
+    // Keyed by file contents, so an edited preset is rendered again.
+    // Keys the file does not store fall back to the defaults.
+    const float inputGain = std::isnan(preset->data.inputGain) ? 1.0f : preset->data.inputGain;
+    previewKey_ = preset->key;
+    return audioEngine_->getPresetPreview()->request(previewKey_, preset->settings->values, inputGain);
+}
+
+void MainWindow::onPresetHovered(QListWidgetItem* item)
+{
+    // Render ahead so Preview plays immediately; a playing preview is left alone
+    if (!item || !engineRunning_ || previewPending_ || audioEngine_->getPresetPreview()->isPlaying()) return;
+    requestPresetPreview(item->text());
+}
+
+void MainWindow::onPreviewPreset()
+{
+    PresetPreview* preview = audioEngine_->getPresetPreview();
+    if (preview->isPlaying() || previewPending_) {
+        preview->stop();
+        previewPending_ = false;
+        previewButton_->setText("Preview");
+        return;
+    }
+    
+    if (presetList_->selectedItems().isEmpty()) {
+        QMessageBox::warning(this, "Warning", "Please select a preset to preview!");
+        return;
+    }
+    if (!engineRunning_ || !requestPresetPreview(presetList_->currentItem()->text())) {
+        QMessageBox::information(this, "Preview", "Start the engine and play a phrase first; "
+                                 "the preview replays it through the selected preset.");
+        return;
+    }
+    
+    // Starts in updatePresetPreview() once the render is ready
+    previewPending_ = true;
+    previewButton_->setText("Stop Preview");
+}
+
+void MainWindow::updatePresetPreview()
+{
+    PresetPreview* preview = audioEngine_->getPresetPreview();
+    if (previewPending_) {
+        if (preview->play(previewKey_)) {
+            previewPending_ = false;
+        }
+    } else if (previewButton_->text() != "Preview" && !preview->isPlaying()) {
+        previewButton_->setText("Preview");
+    }
+}
+
+void MainWindow::onMorphToggled(bool enabled)
+{
+    DSPChain* chain = audioEngine_->getDSPChain();
+    if (!enabled) {
+        // Stays on the sound at the slider position
+        chain->stopMorph();
+        updateEffectsUI();
+        return;
+    }
+    
+    // An end that was never set is the current sound
+    ParamValues a = chain->getParams().snapshot();
+    ParamValues b = a;
+    if (morphA_.size() == a.size()) std::copy(morphA_.begin(), morphA_.end(), a.begin());
+    if (morphB_.size() == b.size()) std::copy(morphB_.begin(), morphB_.end(), b.begin());
+    chain->setMorphPosition(morphSlider_->value() / 100.0f);
+    chain->startMorph(a, b);
+}
+
+void MainWindow::onAuditionPresets()
+{
+    if (auditionRenderer_->isRunning()) return;
+    
+    QString diPath = QFileDialog::getOpenFileName(this, "Audition: choose DI clip",
+        clipManager_->getClipsDirectory(), "Audio files (*.wav *.flac)");
+    if (diPath.isEmpty()) return;
+    
+    QStringList modes = { "Every saved preset", "Grid of settings" };
+    bool ok = false;
+    QString mode = QInputDialog::getItem(this, "Audition", "Render through:", modes, 0, false, &ok);
+    if (!ok) return;
+    
+    std::vector<AuditionVariant> variants;
+    if (mode == modes[0]) {
+        for (const QString& name : presetBank_->names()) {
+            // Keys a preset does not store fall back to the defaults
+            std::shared_ptr<const PresetBank::Preset> preset = presetBank_->find(name);
+            
+            AuditionVariant variant;
+            variant.name = name.toStdString();
+            variant.params = preset->settings->values;
+            variant.inputGain = std::isnan(preset->data.inputGain) ? 1.0f : preset->data.inputGain;
+            variant.outputGain = std::isnan(preset->data.outputGain) ? 1.0f : preset->data.outputGain;
+            variants.push_back(variant);
+        }
+        if (variants.empty()) {
+            QMessageBox::information(this, "Audition", "There are no saved presets to audition.");
+            return;
+        }
+    } else {
+        QString spec = QInputDialog::getText(this, "Audition grid",
+            "Parameters and values, e.g. driveAmount=0.2,0.5,0.8; delayMix=0,0.3",
+            QLineEdit::Normal, "", &ok);
+        if (!ok || spec.trimmed().isEmpty()) return;
+        
+        std::vector<AuditionAxis> axes;
+        for (const QString& part : spec.split(';', Qt::SkipEmptyParts)) {
+            QStringList keyValues = part.split('=');
+            ParamId id;
+            if (keyValues.size() != 2 || !DSPParams::findByName(keyValues[0].trimmed().toStdString(), id)) {
+                QMessageBox::warning(this, "Audition", QString("Cannot read '%1'.").arg(part.trimmed()));
+                return;
+            }
+            AuditionAxis axis { id, {} };
+            for (const QString& value : keyValues[1].split(',', Qt::SkipEmptyParts)) {
+                bool isNumber = false;
+                float v = value.trimmed().toFloat(&isNumber);
+                if (!isNumber) {
+                    QMessageBox::warning(this, "Audition", QString("'%1' is not a number.").arg(value.trimmed()));
+                    return;
+                }
+                axis.values.push_back(v);
+            }
+            axes.push_back(axis);
+        }
+        
+        // Swept on top of the current settings
+        AuditionVariant base;
+        base.name = "current";
+        base.params = audioEngine_->getDSPChain()->getParams().snapshot();
+        base.inputGain = audioEngine_->getInputGain();
+        base.outputGain = audioEngine_->getOutputGain();
+        variants = AuditionRenderer::makeGrid(base, axes);
+    }
+    
+    QString outputDir = QDir(clipManager_->getClipsDirectory()).filePath(
+        QString("Audition_%1_%2").arg(QFileInfo(diPath).completeBaseName())
+                                 .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss")));
+    if (!QDir().mkpath(outputDir)) {
+        QMessageBox::critical(this, "Error", "Failed to create the audition folder!");
+        return;
+    }
+    
+    if (auditionRenderer_->start(diPath.toStdString(), variants, audioEngine_->getDSPChain()->getEffectGraph(),
+                                 outputDir.toStdString(), SampleFormat::Pcm24)) {
+        auditionReported_ = false;
+        auditionButton_->setEnabled(false);
+        auditionStatusLabel_->setText(QString("Rendering %1 variations...").arg(variants.size()));
+    } else {
+        QMessageBox::critical(this, "Error", "Failed to read the DI clip!");
+    }
+}
+
 void MainWindow::updateMeters()
 {
     if (!engineRunning_) return;
@@ -1365,6 +2103,21 @@ void MainWindow::updateLooperStatus()
     if (slotCount > 0) {
         looperStatusLabel_->setText(looperStatusLabel_->text() + QString(" | Slots: %1").arg(slotCount));
     }
+    
+    if (audioEngine_->getLooper()->isConforming()) {
+        looperStatusLabel_->setText(looperStatusLabel_->text() + " | Syncing loop...");
+    }
+    
+    // Report background session save completion once
+    if (audioEngine_->getLooper()->isSavingSession()) {
+        looperStatusLabel_->setText(looperStatusLabel_->text() + " | Saving session...");
+    } else if (!sessionSaveReported_) {
+        sessionSaveReported_ = true;
+        saveSessionButton_->setEnabled(true);
+        if (!audioEngine_->getLooper()->lastSessionSaveOk()) {
+            QMessageBox::critical(this, "Error", "Failed to save looper session!");
+        }
+    }
 }
 
 void MainWindow::updateRecorderStatus()
@@ -1373,18 +2126,121 @@ void MainWindow::updateRecorderStatus()
     
     if (isRecording_) {
         float duration = audioEngine_->getRecorder()->getRecordingDuration();
-        recordDurationLabel_->setText(QString("Duration: %1").arg(formatTime(duration)));
+        QString text = QString("Duration: %1").arg(formatTime(duration));
+        
+        // Frames the writer could not keep up with (disk stalls)
+        quint64 dropped = audioEngine_->getRecorder()->getDroppedFrames();
+        if (dropped > 0) {
+            text += QString(" | Dropped: %1 frames").arg(dropped);
+            recordDurationLabel_->setStyleSheet("color: #ff5555;");
+        } else {
+            recordDurationLabel_->setStyleSheet("");
+        }
+        recordDurationLabel_->setText(text);
+    }
+    
+    // Report background retro capture completion once
+    auto* retro = audioEngine_->getRetroCapture();
+    if (!retroCaptureReported_ && retro && !retro->isCapturing()) {
+        retroCaptureReported_ = true;
+        retroCaptureButton_->setEnabled(retro->isEnabled());
+        if (retro->lastCaptureOk()) {
+            recordStatusLabel_->setText(QString("Status: Captured as %1").arg(retroClipName_));
+            refreshClipList();
+        } else {
+            recordStatusLabel_->setText("Status: Capture failed");
+        }
+    }
+    
+    // Report a background clip conversion or export once
+    if (!clipJobReported_ && !clipManager_->isBusy()) {
+        clipJobReported_ = true;
+        const bool hasSelection = clipList_->selectionModel()->hasSelection();
+        convertFlacButton_->setEnabled(hasSelection);
+        exportButton_->setEnabled(hasSelection);
+        const bool ok = clipManager_->finishJob();
+        if (!clipJobIsExport_) {
+            if (ok) {
+                refreshClipList();
+                recordStatusLabel_->setText(QString("Status: Converted %1 to FLAC").arg(clipJobName_));
+            } else {
+                recordStatusLabel_->setText("Status: Conversion failed");
+                QMessageBox::critical(this, "Error", QString("Failed to convert '%1' to FLAC!").arg(clipJobName_));
+            }
+        } else if (!ok) {
+            recordStatusLabel_->setText("Status: Export failed");
+            QString reason = clipJobNormalized_ ? "\nThe clip may be silent." : QString();
+            QMessageBox::critical(this, "Error", QString("Failed to export '%1'!%2").arg(clipJobName_, reason));
+        } else if (clipJobNormalized_) {
+            const double gainDb = clipManager_->getJobGainDb();
+            recordStatusLabel_->setText(QString("Status: Exported %1 (%2%3 dB)")
+                .arg(clipJobName_).arg(gainDb >= 0.0 ? "+" : "").arg(gainDb, 0, 'f', 1));
+        } else {
+            recordStatusLabel_->setText(QString("Status: Exported %1").arg(clipJobName_));
+        }
+    }
+    
+    // Batch reamp progress, then a one-off summary
+    if (reamper_->isRunning()) {
+        reampStatusLabel_->setText(QString("Reamping %1/%2 clips: %3% (%4x real time)")
+            .arg(reamper_->getFinishedJobs())
+            .arg(reamper_->getTotalJobs())
+            .arg(static_cast<int>(reamper_->getProgress() * 100.0f))
+            .arg(reamper_->getRealtimeFactor(), 0, 'f', 1));
+    } else if (!reampReported_) {
+        reampReported_ = true;
+        int done = reamper_->getTotalJobs() - reamper_->getFailedJobs();
+        QString text = QString("Reamped %1 clip(s) at %2x real time")
+            .arg(done)
+            .arg(reamper_->getRealtimeFactor(), 0, 'f', 1);
+        if (reamper_->getFailedJobs() > 0) {
+            text += QString(", %1 failed or cancelled").arg(reamper_->getFailedJobs());
+        }
+        reampStatusLabel_->setText(text);
+        cancelReampButton_->setEnabled(false);
+        reampButton_->setEnabled(clipList_->selectionModel()->hasSelection());
+        refreshClipList();
+    }
+    
+    // Audition batch progress, then where the results went
+    if (auditionRenderer_->isRunning()) {
+        auditionStatusLabel_->setText(QString("Rendering %1/%2 (%3x real time)")
+            .arg(auditionRenderer_->getFinishedJobs())
+            .arg(auditionRenderer_->getTotalJobs())
+            .arg(auditionRenderer_->getRealtimeFactor(), 0, 'f', 1));
+    } else if (!auditionReported_) {
+        auditionReported_ = true;
+        auditionButton_->setEnabled(true);
+        QString summary = QString::fromStdString(auditionRenderer_->getSummaryPath());
+        if (auditionRenderer_->summaryWritten()) {
+            auditionStatusLabel_->setText(QString("Done: %1 clips, summary in %2")
+                .arg(auditionRenderer_->getTotalJobs() - auditionRenderer_->getFailedJobs())
+                .arg(QDir::toNativeSeparators(summary)));
+        } else {
+            auditionStatusLabel_->setText("Audition failed");
+        }
     }
 }
 
 void MainWindow::updatePlaybackPosition()
 {
-    if (mediaPlayer_->playbackState() == QMediaPlayer::PlayingState) {
+    ClipPlayer* player = audioEngine_->getClipPlayer();
+    if (player->isLoaded() && player->getNumFrames() > 0) {
+        const double sampleRate = player->getSampleRate();
+        const double position = player->getPosition() / sampleRate;
+        const double duration = player->getNumFrames() / sampleRate;
+        playbackProgressBar_->setValue(static_cast<int>(100.0 * position / duration));
+        waveformView_->setPosition(position / duration);
+        playbackPositionLabel_->setText(QString("%1 / %2")
+            .arg(formatTime(static_cast<float>(position)))
+            .arg(formatTime(static_cast<float>(duration))));
+    } else if (mediaPlayer_->playbackState() == QMediaPlayer::PlayingState) {
         qint64 position = mediaPlayer_->position();
         qint64 duration = mediaPlayer_->duration();
         
         if (duration > 0) {
             playbackProgressBar_->setValue(static_cast<int>(100.0f * position / duration));
+            waveformView_->setPosition(static_cast<double>(position) / duration);
             playbackPositionLabel_->setText(QString("%1 / %2")
                 .arg(formatTime(position / 1000.0f))
                 .arg(formatTime(duration / 1000.0f)));
@@ -1392,11 +2248,94 @@ void MainWindow::updatePlaybackPosition()
     }
 }
 
+void MainWindow::onWaveformSeek(double fraction)
+{
+    if (waveformClip_.isEmpty()) return;
+    
+    // Sample-accurate when the engine is playing this clip
+    QString filepath = clipManager_->getClipPath(waveformClip_);
+    ClipPlayer* player = audioEngine_->getClipPlayer();
+    if (player->isLoaded() && player->getPath() == filepath.toStdString()) {
+        player->seek(static_cast<uint64_t>(fraction * player->getNumFrames()));
+        waveformView_->setPosition(fraction);
+        return;
+    }
+    
+    QUrl source = QUrl::fromLocalFile(filepath);
+    if (mediaPlayer_->source() != source) {
+        mediaPlayer_->setSource(source);
+    }
+    
+    // The index knows the length before the player has parsed the file
+    ClipInfo info;
+    if (clipManager_->getIndex()->clipInfo(waveformClip_, info)) {
+        mediaPlayer_->setPosition(static_cast<qint64>(fraction * info.duration * 1000.0));
+    }
+    waveformView_->setPosition(fraction);
+}
+
+void MainWindow::onLoadBackingTrack()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Load Backing Track",
+        clipManager_->getClipsDirectory(), "Audio Files (*.wav *.flac)");
+    if (path.isEmpty()) return;
+    
+    BackingTrack* track = audioEngine_->getBackingTrack();
+    if (!track->load(path.toStdString())) {
+        QMessageBox::critical(this, "Error", QString("Failed to load '%1'!").arg(QFileInfo(path).fileName()));
+        return;
+    }
+    backingPlayButton_->setEnabled(true);
+    backingStopButton_->setEnabled(true);
+}
+
+void MainWindow::onBackingPlayPause()
+{
+    BackingTrack* track = audioEngine_->getBackingTrack();
+    if (track->isPlaying()) {
+        track->pause();
+    } else {
+        track->play();
+    }
+}
+
+void MainWindow::updateBackingTrackStatus()
+{
+    BackingTrack* track = audioEngine_->getBackingTrack();
+    if (!track->isLoaded()) return;
+    
+    backingPlayButton_->setText(track->isPlaying() ? "Pause" : "Play");
+    backingStatusLabel_->setText(QString("%1  %2 / %3")
+        .arg(QFileInfo(QString::fromStdString(track->getPath())).completeBaseName())
+        .arg(formatTime(static_cast<float>(track->getPosition())))
+        .arg(formatTime(static_cast<float>(track->getDuration()))));
+}
+
+void MainWindow::onApplyEffectOrder()
+{
+    if (!audioEngine_->getDSPChain()) return;
+    
+    EffectGraph graph;
+    std::string error;
+    if (!EffectGraph::parse(effectOrderEdit_->text().toStdString(), graph, &error)) {
+        QMessageBox::warning(this, "Effect Order", QString::fromStdString(error));
+        return;
+    }
+    
+    // The live chain crossfades to the new order; previews follow it
+    audioEngine_->getDSPChain()->setEffectGraph(graph);
+    audioEngine_->getPresetPreview()->setEffectGraph(graph);
+    effectOrderEdit_->setText(QString::fromStdString(graph.toString()));
+}
+
 void MainWindow::updateEffectsUI()
 {
     if (!audioEngine_->getDSPChain()) return;
     
     auto& params = audioEngine_->getDSPChain()->getParams();
+    // Slider positions are rounded; writing them back would nudge the
+    // parameters just switched in
+    syncingControls_ = true;
     
     // Update all UI elements from parameters
     gateBypass_->setChecked(params.gateBypass.load());
@@ -1464,133 +2403,40 @@ void MainWindow::updateEffectsUI()
     reverbSizeLabel_->setText(QString::number(reverbSize_->value()) + "%");
     reverbDampingLabel_->setText(QString::number(reverbDamping_->value()) + "%");
     reverbMixLabel_->setText(QString::number(reverbMix_->value()) + "%");
+    syncingControls_ = false;
 }
 
 void MainWindow::savePresetToFile(const QString& name)
 {
     if (!audioEngine_->getDSPChain()) return;
     
-    auto& params = audioEngine_->getDSPChain()->getParams();
-    
-    QJsonObject json;
-    
-    // Gate
-    json["gateBypass"] = params.gateBypass.load();
-    json["gateThreshold"] = static_cast<double>(params.gateThreshold.load());
-    
-    // Drive
-    json["driveBypass"] = params.driveBypass.load();
-    json["driveAmount"] = static_cast<double>(params.driveAmount.load());
-    json["driveType"] = params.driveType.load();
-    json["preGain"] = static_cast<double>(params.preGain.load());
-    
-    // EQ
-    json["eqBypass"] = params.eqBypass.load();
-    json["lowGain"] = static_cast<double>(params.lowGain.load());
-    json["lowFreq"] = static_cast<double>(params.lowFreq.load());
-    json["midGain"] = static_cast<double>(params.midGain.load());
-    json["midFreq"] = static_cast<double>(params.midFreq.load());
-    json["midQ"] = static_cast<double>(params.midQ.load());
-    json["highGain"] = static_cast<double>(params.highGain.load());
-    json["highFreq"] = static_cast<double>(params.highFreq.load());
-    json["presenceGain"] = static_cast<double>(params.presenceGain.load());
-    
-    // Compressor
-    json["compBypass"] = params.compBypass.load();
-    json["compThreshold"] = static_cast<double>(params.compThreshold.load());
-    json["compRatio"] = static_cast<double>(params.compRatio.load());
-    
-    // Pitch
-    json["pitchBypass"] = params.pitchBypass.load();
-    json["pitchMode"] = params.pitchMode.load();
-    
-    // Delay
-    json["delayBypass"] = params.delayBypass.load();
-    json["delayTime"] = static_cast<double>(params.delayTime.load());
-    json["delayFeedback"] = static_cast<double>(params.delayFeedback.load());
-    json["delayMix"] = static_cast<double>(params.delayMix.load());
-    
-    // Reverb
-    json["reverbBypass"] = params.reverbBypass.load();
-    json["reverbSize"] = static_cast<double>(params.reverbSize.load());
-    json["reverbDamping"] = static_cast<double>(params.reverbDamping.load());
-    json["reverbMix"] = static_cast<double>(params.reverbMix.load());
-    
-    // Global
-    json["inputGain"] = static_cast<double>(audioEngine_->getInputGain());
-    json["outputGain"] = static_cast<double>(audioEngine_->getOutputGain());
-    json["loopLevel"] = static_cast<double>(audioEngine_->getLooper()->getLoopLevel());
+    PresetData preset;
+    preset.params = audioEngine_->getDSPChain()->getParams().snapshot();
+    preset.inputGain = audioEngine_->getInputGain();
+    preset.outputGain = audioEngine_->getOutputGain();
+    preset.loopLevel = audioEngine_->getLooper()->getLoopLevel();
     
-    QString filepath = getPresetsDirectory() + "/" + name + ".json";
-    QFile file(filepath);
-    if (file.open(QIODevice::WriteOnly)) {
-        QJsonDocument doc(json);
-        file.write(doc.toJson());
-        file.close();
-    }
+    PresetIO::save(getPresetsDirectory() + "/" + name + ".json", preset);
+    presetBank_->sync();
 }
 
 void MainWindow::loadPresetFromFile(const QString& name)
 {
-    QString filepath = getPresetsDirectory() + "/" + name + ".json";
-    QFile file(filepath);
-    if (!file.open(QIODevice::ReadOnly)) return;
-    
-    QByteArray data = file.readAll();
-    file.close();
-    
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    QJsonObject json = doc.object();
-    
     if (!audioEngine_->getDSPChain()) return;
-    auto& params = audioEngine_->getDSPChain()->getParams();
-    
-    // Gate
-    params.gateBypass.store(json["gateBypass"].toBool());
-    params.gateThreshold.store(json["gateThreshold"].toDouble());
-    
-    // Drive
-    params.driveBypass.store(json["driveBypass"].toBool());
-    params.driveAmount.store(json["driveAmount"].toDouble());
-    params.driveType.store(json["driveType"].toInt());
-    if (json.contains("preGain")) params.preGain.store(json["preGain"].toDouble());
-    
-    // EQ
-    params.eqBypass.store(json["eqBypass"].toBool());
-    params.lowGain.store(json["lowGain"].toDouble());
-    params.lowFreq.store(json["lowFreq"].toDouble());
-    params.midGain.store(json["midGain"].toDouble());
-    params.midFreq.store(json["midFreq"].toDouble());
-    params.midQ.store(json["midQ"].toDouble());
-    params.highGain.store(json["highGain"].toDouble());
-    params.highFreq.store(json["highFreq"].toDouble());
-    if (json.contains("presenceGain")) params.presenceGain.store(json["presenceGain"].toDouble());
-    
-    // Compressor
-    params.compBypass.store(json["compBypass"].toBool());
-    params.compThreshold.store(json["compThreshold"].toDouble());
-    params.compRatio.store(json["compRatio"].toDouble());
-    
-    // Pitch
-    params.pitchBypass.store(json["pitchBypass"].toBool());
-    params.pitchMode.store(json["pitchMode"].toInt());
-    
-    // Delay
-    params.delayBypass.store(json["delayBypass"].toBool());
-    params.delayTime.store(json["delayTime"].toDouble());
-    params.delayFeedback.store(json["delayFeedback"].toDouble());
-    params.delayMix.store(json["delayMix"].toDouble());
     
-    // Reverb
-    params.reverbBypass.store(json["reverbBypass"].toBool());
-    params.reverbSize.store(json["reverbSize"].toDouble());
-    params.reverbDamping.store(json["reverbDamping"].toDouble());
-    params.reverbMix.store(json["reverbMix"].toDouble());
+    // Parsed and compiled ahead of time; keys missing from older files keep their values
+    std::shared_ptr<const PresetBank::Preset> preset = presetBank_->find(name);
+    if (!preset) return;
+    DSPChain* chain = audioEngine_->getDSPChain();
+    chain->loadPreset(presetBank_->recall(*preset, chain->getParams().snapshot()));
+    {
+        QSignalBlocker blocker(morphButton_); // the load ended any morph
+        morphButton_->setChecked(false);
+    }
     
-    // Global
-    audioEngine_->setInputGain(json["inputGain"].toDouble());
-    audioEngine_->setOutputGain(json["outputGain"].toDouble());
-    audioEngine_->getLooper()->setLoopLevel(json["loopLevel"].toDouble());
+    if (!std::isnan(preset->data.inputGain)) audioEngine_->setInputGain(preset->data.inputGain);
+    if (!std::isnan(preset->data.outputGain)) audioEngine_->setOutputGain(preset->data.outputGain);
+    if (!std::isnan(preset->data.loopLevel)) audioEngine_->getLooper()->setLoopLevel(preset->data.loopLevel);
     
     inputGainSlider_->setValue(audioEngine_->getInputGain() * 100);
     outputGainSlider_->setValue(audioEngine_->getOutputGain() * 100);
@@ -1599,16 +2445,17 @@ void MainWindow::loadPresetFromFile(const QString& name)
 
 void MainWindow::refreshPresetList()
 {
-    presetList_->clear();
+    QString current = presetList_->currentItem() ? presetList_->currentItem()->text() : QString();
     
-    QDir dir(getPresetsDirectory());
-    QStringList filters;
-    filters << "*.json";
-    
-    QFileInfoList files = dir.entryInfoList(filters, QDir::Files);
-    for (const QFileInfo& file : files) {
-        presetList_->addItem(file.baseName());
+    presetList_->blockSignals(true);
+    presetList_->clear();
+    for (const QString& name : presetBank_->names()) {
+        QListWidgetItem* item = new QListWidgetItem(name, presetList_);
+        if (name == current) {
+            presetList_->setCurrentItem(item);
+        }
     }
+    presetList_->blockSignals(false);
 }
 
 QString MainWindow::getPresetsDirectory()
@@ -1625,6 +2472,20 @@ QString MainWindow::getPresetsDirectory()
     return dir;
 }
 
+QString MainWindow::getSessionsDirectory()
+{
+#ifdef Q_OS_WIN
+    QString dir = QDir::homePath() + "/AppData/Roaming/GuitarEffectsApp/Sessions";
+#elif defined(Q_OS_MAC)
+    QString dir = QDir::homePath() + "/Library/Application Support/GuitarEffectsApp/Sessions";
+#else
+    QString dir = QDir::homePath() + "/.local/share/GuitarEffectsApp/Sessions";
+#endif
+    
+    QDir().mkpath(dir);
+    return dir;
+}
+
 QString MainWindow::formatTime(float seconds)
 {
     int mins = static_cast<int>(seconds) / 60;
@@ -1673,12 +2534,21 @@ void MainWindow::onLoopSlotClicked(int index)
 void MainWindow::onLoopRemoveAll()
 {
     audioEngine_->getLooper()->clearAllSlots();
+    rebuildLoopSlotButtons();
+}
+
+void MainWindow::rebuildLoopSlotButtons()
+{
     for (auto* b : loopSlotButtons_) {
         loopButtonsLayout_->removeWidget(b);
         b->deleteLater();
     }
     loopSlotButtons_.clear();
-    loopRemoveAllButton_->setEnabled(false);
+    int slotCount = audioEngine_->getLooper()->getSlotCount();
+    for (int i = 0; i < slotCount; ++i) {
+        addLoopSlotButton(i);
+    }
+    loopRemoveAllButton_->setEnabled(slotCount > 0);
     refreshLoopButtonsStyles();
 }
 
@@ -1686,7 +2556,10 @@ void MainWindow::onLoopRemoveAll()
 void MainWindow::applyQuickPreset(const QString& name)
 {
     if (!audioEngine_->getDSPChain()) return;
-    auto& p = audioEngine_->getDSPChain()->getParams();
+    // Built on a copy and switched in whole, like a preset file
+    DSPParams p;
+    p.copyFrom(audioEngine_->getDSPChain()->getParams());
+    syncingControls_ = true;
 
     if (name == "richfuzz") {
         // Light gain: minimal distortion, no fuzz, modest EQ lift, subtle ambience.
@@ -1747,6 +2620,12 @@ void MainWindow::applyQuickPreset(const QString& name)
         p.reverbBypass.store(true); reverbBypass_->setChecked(true); reverbSize_->setValue(50); reverbDamping_->setValue(50); reverbMix_->setValue(25); p.reverbSize.store(0.50f); p.reverbDamping.store(0.50f); p.reverbMix.store(0.25f);
     }
 
+    syncingControls_ = false;
+    audioEngine_->getDSPChain()->loadPreset(p.snapshot());
+    {
+        QSignalBlocker blocker(morphButton_); // the load ended any morph
+        morphButton_->setChecked(false);
+    }
     updateEffectsUI();
 }
 
@@ -1779,7 +2658,7 @@ QToolButton { background:#32363a; color:#e6e9ec; font-weight:bold; padding:6px;
 QToolButton:checked { background:#3a3f44; }
 QPushButton { background:#3b4045; color:#f5f7f9; border:1px solid #565b60; padding:5px 10px; border-radius:3px; }
 QPushButton:hover { background:#465057; }
-QLineEdit, QComboBox, QListWidget { border:1px solid #4a4f54; border-radius:3px; }
+QLineEdit, QComboBox, QListWidget, QListView { border:1px solid #4a4f54; border-radius:3px; }
 QSlider::groove:horizontal { height:6px; background:#454a50; border-radius:3px; }
 QSlider::handle:horizontal { background:#4b78ff; width:14px; margin:-4px 0; border-radius:7px; }
 QTabWidget::pane { border:1px solid #43474c; }
@@ -13,6 +13,7 @@
 #include <QCheckBox>
 #include <QLineEdit>
 #include <QListWidget>
+#include <QListView>
 #include <QTabWidget>
 #include <QProgressBar>
 #include <QGroupBox>
@@ -22,12 +23,18 @@
 #include <QMediaPlayer>
 #include <QAudioOutput>
 #include <memory>
+#include <vector>
 
 class AudioEngine;
 class DSPChain;
 class Looper;
 class Recorder;
 class ClipManager;
+class Reamper;
+class AuditionRenderer;
+class WaveformView;
+class ClipListModel;
+class PresetBank;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -49,6 +56,7 @@ private slots:
     // Effects
     void onEffectBypassChanged();
     void onEffectParameterChanged();
+    void onApplyEffectOrder();
     void updateEffectsUI();
     
     // Looper
@@ -57,11 +65,15 @@ private slots:
     void onLooperOverdub();
     void onLooperClear();
     void onLooperLevelChanged(int value);
+    void onSaveLooperSession();
+    void onLoadLooperSession();
     
     // Recording
     void onStartRecording();
     void onStopRecording();
     void onDownloadRecording();
+    void onRetroSettingsChanged();
+    void onRetroCapture();
     
     // Playback
     void onClipSelected();
@@ -71,14 +83,27 @@ private slots:
     void onRenameClip();
     void onDeleteClip();
     void onRevealClip();
+    void onConvertClipToFlac();
+    void onExportClip();
+    void refreshClipList();
+    void onReampClips();
     void onClipVolumeChanged(int value);
     void updatePlaybackPosition();
+    void onWaveformSeek(double fraction);
+    void onLoadBackingTrack();
+    void onBackingPlayPause();
+    void updateBackingTrackStatus();
     
     // Presets
     void onSavePreset();
     void onLoadPreset();
     void onDeletePreset();
     void refreshPresetList();
+    void onAuditionPresets();
+    void onPresetHovered(QListWidgetItem* item);
+    void onPreviewPreset();
+    void updatePresetPreview();
+    void onMorphToggled(bool enabled);
     
     // UI Updates
     void updateMeters();
@@ -105,14 +130,21 @@ private:
     void savePresetToFile(const QString& name);
     void loadPresetFromFile(const QString& name);
     QString getPresetsDirectory();
+    bool requestPresetPreview(const QString& name);
+    QString getSessionsDirectory();
     
     // Helper functions
     QString formatTime(float seconds);
     float dBToLinear(float dB);
     float linearTodB(float linear);
+    QString selectedClipName() const;
+    QStringList selectedClipNames() const;
     
     std::unique_ptr<AudioEngine> audioEngine_;
     std::unique_ptr<ClipManager> clipManager_;
+    std::unique_ptr<PresetBank> presetBank_;
+    std::unique_ptr<Reamper> reamper_;
+    std::unique_ptr<AuditionRenderer> auditionRenderer_;
     
     QTimer* updateTimer_;
     
@@ -205,6 +237,9 @@ private:
     QLabel* reverbDampingLabel_;
     QLabel* reverbMixLabel_;
     
+    // Effects - Order
+    QLineEdit* effectOrderEdit_;
+    
     // Looper
     QPushButton* looperRecordButton_;
     QPushButton* looperPlayButton_;
@@ -217,27 +252,67 @@ private:
     QHBoxLayout* loopButtonsLayout_ { nullptr }; // dynamic loop slot buttons
     QPushButton* loopRemoveAllButton_ { nullptr }; 
     std::vector<QPushButton*> loopSlotButtons_;
+    QCheckBox* looperSyncCheck_;
+    QPushButton* saveSessionButton_;
+    QPushButton* loadSessionButton_;
+    bool sessionSaveReported_ { true };
     
     // Recorder
     QPushButton* recordStartButton_;
     QPushButton* recordStopButton_;
     QLineEdit* recordNameEdit_;
+    QComboBox* recordFormatCombo_;
+    QCheckBox* recordDryCheck_;
+    QCheckBox* recordWetCheck_;
+    QCheckBox* recordLoopCheck_;
+    QCheckBox* recordCombinedCheck_;
     QPushButton* downloadButton_;
     QLabel* recordStatusLabel_;
     QLabel* recordDurationLabel_;
+    QCheckBox* retroCheck_;
+    QSpinBox* retroMinutesSpin_;
+    QCheckBox* retroCompactCheck_;
+    QPushButton* retroCaptureButton_;
+    QSpinBox* retroSecondsSpin_;
+    QString retroClipName_;
+    bool retroCaptureReported_ { true };
     
     // Playback
-    QListWidget* clipList_;
+    QListView* clipList_;
+    ClipListModel* clipModel_;
+    QLineEdit* clipFilterEdit_;
+    QComboBox* clipSortCombo_;
     QPushButton* playButton_;
     QPushButton* pauseButton_;
     QPushButton* stopPlayButton_;
     QPushButton* renameButton_;
     QPushButton* deleteButton_;
     QPushButton* revealButton_;
+    QPushButton* convertFlacButton_;
+    QPushButton* exportButton_;
+    QCheckBox* exportNormalizeCheck_;
+    QSpinBox* exportTargetSpin_;
+    QString clipJobName_;
+    bool clipJobIsExport_ { false };
+    bool clipJobNormalized_ { false };
+    bool clipJobReported_ { true };
+    QPushButton* reampButton_;
+    QPushButton* cancelReampButton_;
+    QLabel* reampStatusLabel_;
+    bool reampReported_ { true };
     QSlider* clipVolumeSlider_;
     QLabel* clipVolumeLabel_;
+    QCheckBox* clipThroughChainCheck_;
+    QPushButton* backingLoadButton_;
+    QPushButton* backingPlayButton_;
+    QPushButton* backingStopButton_;
+    QCheckBox* backingThroughChainCheck_;
+    QSlider* backingVolumeSlider_;
+    QLabel* backingStatusLabel_;
     QLabel* playbackPositionLabel_;
     QProgressBar* playbackProgressBar_;
+    WaveformView* waveformView_;
+    QString waveformClip_;
     
     // Presets
     QListWidget* presetList_;
@@ -245,6 +320,18 @@ private:
     QPushButton* savePresetButton_;
     QPushButton* loadPresetButton_;
     QPushButton* deletePresetButton_;
+    QPushButton* auditionButton_;
+    QPushButton* previewButton_;
+    quint64 previewKey_ { 0 };
+    bool previewPending_ { false };
+    QLabel* auditionStatusLabel_;
+    bool auditionReported_ { true };
+    QPushButton* morphSetAButton_;
+    QPushButton* morphSetBButton_;
+    QSlider* morphSlider_;
+    QPushButton* morphButton_;
+    std::vector<float> morphA_; // parameter sets captured for the A/B morph
+    std::vector<float> morphB_;
     QPushButton* quickDistButton_;
     QPushButton* quickAcousticButton_;
     QPushButton* resetDefaultButton_;
@@ -254,12 +341,14 @@ private:
     bool isRecording_;
     QString currentClipName_;
     int currentPitchMode_; // 0=off, 1=down, 2=up
+    bool syncingControls_ { false }; // controls follow the parameters, no write-back
 
     // Helpers for loop UI
     void addLoopSlotButton(int index);
     void refreshLoopButtonsStyles();
     void onLoopSlotClicked(int index);
     void onLoopRemoveAll();
+    void rebuildLoopSlotButtons();
 
     // Quick presets
     void applyQuickPreset(const QString& name);
@@ -0,0 +1,42 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. Pointers into data() stay valid
+// until close() or destruction, so callers can reference samples in place.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filepath);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& getPath() const { return path_; }
+
+    // Faults in the pages of a byte range, so a later reader (e.g. the audio
+    // thread) finds them resident. Blocks on disk I/O; call from a worker.
+    void touch(size_t offset, size_t length) const;
+
+    static const size_t TOUCH_STRIDE = 4096; // smallest common page size
+
+private:
+    const unsigned char* data_{nullptr};
+    size_t size_{0};
+    std::string path_;
+
+#ifdef _WIN32
+    void* fileHandle_{nullptr};
+    void* mappingHandle_{nullptr};
+#endif
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,197 @@
+#include "PcmConverter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PCMCONVERTER_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PCMCONVERTER_NEON 1
+#endif
+
+namespace {
+    constexpr float SCALE_16 = 32767.0f;   // 2^15 - 1
+    constexpr float SCALE_24 = 8388607.0f; // 2^23 - 1
+}
+
+PcmConverter::PcmConverter()
+{
+}
+
+int PcmConverter::bytesPerSample(SampleFormat format)
+{
+    switch (format) {
+        case SampleFormat::Pcm16: return 2;
+        case SampleFormat::Pcm24: return 3;
+        case SampleFormat::Float32: return 4;
+    }
+    return 3;
+}
+
+int PcmConverter::getBytesPerSample() const
+{
+    return bytesPerSample(format_);
+}
+
+void PcmConverter::convert(const float* const* channels, int numChannels, int numFrames, unsigned char* out)
+{
+    if (numFrames <= 0) return;
+
+    if (format_ == SampleFormat::Float32) {
+        interleaveFloat(channels, numChannels, numFrames, out);
+        return;
+    }
+
+    const int bps = getBytesPerSample();
+    const int stride = numChannels * bps;
+    const float scale = (format_ == SampleFormat::Pcm16) ? SCALE_16 : SCALE_24;
+
+    if ((int)quantized_.size() < numFrames) {
+        quantized_.resize(numFrames);
+        ditherNoise_.resize(numFrames);
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        if (dither_) {
+            fillDither(numFrames);
+        }
+        quantize(channels[ch], numFrames, scale, quantized_.data());
+
+        // Scatter this channel into its interleaved slots
+        const int32_t* q = quantized_.data();
+        unsigned char* dst = out + ch * bps;
+        if (format_ == SampleFormat::Pcm16) {
+            for (int i = 0; i < numFrames; ++i, dst += stride) {
+                dst[0] = static_cast<unsigned char>(q[i] & 0xFF);
+                dst[1] = static_cast<unsigned char>((q[i] >> 8) & 0xFF);
+            }
+        } else {
+            for (int i = 0; i < numFrames; ++i, dst += stride) {
+                dst[0] = static_cast<unsigned char>(q[i] & 0xFF);
+                dst[1] = static_cast<unsigned char>((q[i] >> 8) & 0xFF);
+                dst[2] = static_cast<unsigned char>((q[i] >> 16) & 0xFF);
+            }
+        }
+    }
+}
+
+void PcmConverter::convertToInt(const float* const* channels, int numChannels, int numFrames, int32_t* const* out)
+{
+    if (numFrames <= 0) return;
+
+    const float scale = (format_ == SampleFormat::Pcm16) ? SCALE_16 : SCALE_24;
+    if ((int)ditherNoise_.size() < numFrames) {
+        ditherNoise_.resize(numFrames);
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        if (dither_) {
+            fillDither(numFrames);
+        }
+        quantize(channels[ch], numFrames, scale, out[ch]);
+    }
+}
+
+void PcmConverter::quantize(const float* input, int numFrames, float scale, int32_t* output)
+{
+    // clamp(x * gain, -1, 1) * scale (+ dither), rounded and kept inside the integer range
+    const float* noise = ditherNoise_.data();
+    const float gain = gain_;
+    const float lowLimit = -scale - 1.0f;
+    int i = 0;
+
+#if defined(PCMCONVERTER_SSE2)
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 plusOne = _mm_set1_ps(1.0f);
+    const __m128 vScale = _mm_set1_ps(scale);
+    const __m128 vLow = _mm_set1_ps(lowLimit);
+    const __m128 vHigh = _mm_set1_ps(scale);
+    const __m128 vGain = _mm_set1_ps(gain);
+    for (; i + 4 <= numFrames; i += 4) {
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(input + i), vGain);
+        x = _mm_min_ps(_mm_max_ps(x, minusOne), plusOne);
+        x = _mm_mul_ps(x, vScale);
+        if (dither_) {
+            x = _mm_add_ps(x, _mm_loadu_ps(noise + i));
+            x = _mm_min_ps(_mm_max_ps(x, vLow), vHigh);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_cvtps_epi32(x));
+    }
+#elif defined(PCMCONVERTER_NEON)
+    const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+    const float32x4_t plusOne = vdupq_n_f32(1.0f);
+    const float32x4_t vLow = vdupq_n_f32(lowLimit);
+    const float32x4_t vHigh = vdupq_n_f32(scale);
+    for (; i + 4 <= numFrames; i += 4) {
+        float32x4_t x = vmulq_n_f32(vld1q_f32(input + i), gain);
+        x = vminq_f32(vmaxq_f32(x, minusOne), plusOne);
+        x = vmulq_n_f32(x, scale);
+        if (dither_) {
+            x = vaddq_f32(x, vld1q_f32(noise + i));
+            x = vminq_f32(vmaxq_f32(x, vLow), vHigh);
+        }
+        vst1q_s32(output + i, vcvtnq_s32_f32(x));
+    }
+#endif
+
+    for (; i < numFrames; ++i) {
+        float x = input[i] * gain;
+        x = (x > 1.0f) ? 1.0f : (x >= -1.0f ? x : -1.0f); // NaN maps to -1 like the SIMD path
+        x *= scale;
+        if (dither_) {
+            x = std::max(lowLimit, std::min(scale, x + noise[i]));
+        }
+        output[i] = static_cast<int32_t>(std::lrint(x));
+    }
+}
+
+void PcmConverter::interleaveFloat(const float* const* channels, int numChannels, int numFrames, unsigned char* out) const
+{
+    const float gain = gain_;
+    int i = 0;
+    if (numChannels == 2) {
+        const float* left = channels[0];
+        const float* right = channels[1];
+        float* dst = reinterpret_cast<float*>(out);
+#if defined(PCMCONVERTER_SSE2)
+        const __m128 vGain = _mm_set1_ps(gain);
+        for (; i + 4 <= numFrames; i += 4) {
+            __m128 l = _mm_mul_ps(_mm_loadu_ps(left + i), vGain);
+            __m128 r = _mm_mul_ps(_mm_loadu_ps(right + i), vGain);
+            _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(l, r));
+        }
+#elif defined(PCMCONVERTER_NEON)
+        for (; i + 4 <= numFrames; i += 4) {
+            float32x4x2_t lr = { { vmulq_n_f32(vld1q_f32(left + i), gain), vmulq_n_f32(vld1q_f32(right + i), gain) } };
+            vst2q_f32(dst + 2 * i, lr);
+        }
+#endif
+    }
+
+    const int stride = numChannels * static_cast<int>(sizeof(float));
+    for (int ch = 0; ch < numChannels; ++ch) {
+        unsigned char* dst = out + static_cast<size_t>(i) * stride + ch * sizeof(float);
+        for (int n = i; n < numFrames; ++n, dst += stride) {
+            const float x = channels[ch][n] * gain;
+            std::memcpy(dst, &x, sizeof(float));
+        }
+    }
+}
+
+void PcmConverter::fillDither(int numFrames)
+{
+    // TPDF dither of +/-1 LSB: difference of two uniform values (xorshift32)
+    uint32_t state = rngState_;
+    const float norm = 1.0f / 4294967296.0f;
+    for (int i = 0; i < numFrames; ++i) {
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        float r1 = state * norm;
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        float r2 = state * norm;
+        ditherNoise_[i] = r1 - r2;
+    }
+    rngState_ = state;
+}
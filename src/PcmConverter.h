@@ -0,0 +1,53 @@
+#ifndef PCMCONVERTER_H
+#define PCMCONVERTER_H
+
+#include <vector>
+#include <cstdint>
+
+enum class SampleFormat {
+    Pcm16,
+    Pcm24,
+    Float32
+};
+
+// Block converter from planar float to interleaved little-endian PCM.
+// Clamping, scaling and optional TPDF dither run vectorised per channel;
+// the result is packed into one contiguous output buffer per call.
+// Float32 output is a plain interleave with no clamping or quantisation.
+// An optional gain (e.g. loudness normalisation on export) is applied in
+// the same pass, before clamping.
+class PcmConverter {
+public:
+    PcmConverter();
+
+    void setFormat(SampleFormat format) { format_ = format; }
+    SampleFormat getFormat() const { return format_; }
+    void setDither(bool enabled) { dither_ = enabled; }
+    bool getDither() const { return dither_; }
+    void setGain(float gain) { gain_ = gain; }
+    float getGain() const { return gain_; }
+
+    int getBytesPerSample() const;
+    static int bytesPerSample(SampleFormat format);
+
+    // out must hold numFrames * numChannels * getBytesPerSample() bytes
+    void convert(const float* const* channels, int numChannels, int numFrames, unsigned char* out);
+
+    // Planar integer samples at the format's bit depth (Float32 is treated as 24-bit)
+    void convertToInt(const float* const* channels, int numChannels, int numFrames, int32_t* const* out);
+
+private:
+    void quantize(const float* input, int numFrames, float scale, int32_t* output);
+    void interleaveFloat(const float* const* channels, int numChannels, int numFrames, unsigned char* out) const;
+    void fillDither(int numFrames);
+
+    SampleFormat format_{SampleFormat::Pcm24};
+    bool dither_{false};
+    float gain_{1.0f};
+    uint32_t rngState_{0x12345678u};
+
+    std::vector<int32_t> quantized_;
+    std::vector<float> ditherNoise_;
+};
+
+#endif // PCMCONVERTER_H
@@ -0,0 +1,280 @@
+#include "PeakFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    const char MAGIC[4] = { 'G', 'P', 'K', '1' };
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = 44;
+    const size_t LEVEL_ENTRY_SIZE = 20;
+    const size_t BIN_SIZE = 6; // int16 min, int16 max, uint16 rms
+    const size_t SOURCE_STAMP_OFFSET = 24;
+
+    void putU16(std::vector<unsigned char>& out, uint16_t v)
+    {
+        out.push_back(static_cast<unsigned char>(v & 0xFF));
+        out.push_back(static_cast<unsigned char>(v >> 8));
+    }
+
+    void putU32(std::vector<unsigned char>& out, uint32_t v)
+    {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<unsigned char>((v >> (8 * i)) & 0xFF));
+    }
+
+    void putU64(std::vector<unsigned char>& out, uint64_t v)
+    {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<unsigned char>((v >> (8 * i)) & 0xFF));
+    }
+
+    uint16_t readU16(const unsigned char* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    uint32_t readU32(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24); }
+    uint64_t readU64(const unsigned char* p) { return readU32(p) | (uint64_t(readU32(p + 4)) << 32); }
+
+    int16_t quantizeSigned(float x)
+    {
+        x = std::max(-1.0f, std::min(1.0f, x));
+        return static_cast<int16_t>(std::lrint(x * 32767.0f));
+    }
+
+    uint16_t quantizeUnsigned(float x)
+    {
+        x = std::max(0.0f, std::min(1.0f, x));
+        return static_cast<uint16_t>(std::lrint(x * 65535.0f));
+    }
+}
+
+// ===== Builder =====
+
+void PeakFile::Builder::reset(int sampleRate, int numChannels)
+{
+    sampleRate_ = sampleRate;
+    numChannels_ = numChannels;
+    numFrames_ = 0;
+    binPos_ = 0;
+    current_.assign(numChannels, Bin{ 0.0f, 0.0f, 0.0f });
+    sumSquares_.assign(numChannels, 0.0);
+    level0_.clear();
+}
+
+void PeakFile::Builder::process(const float* const* channels, int numFrames)
+{
+    int done = 0;
+    while (done < numFrames) {
+        const int frames = std::min(numFrames - done, BASE_FRAMES_PER_BIN - binPos_);
+        for (int ch = 0; ch < numChannels_; ++ch) {
+            const float* in = channels[ch] + done;
+            float lo = current_[ch].min;
+            float hi = current_[ch].max;
+            double sum = 0.0;
+            if (binPos_ == 0) {
+                lo = hi = in[0];
+            }
+            for (int i = 0; i < frames; ++i) {
+                lo = std::min(lo, in[i]);
+                hi = std::max(hi, in[i]);
+                sum += static_cast<double>(in[i]) * in[i];
+            }
+            current_[ch].min = lo;
+            current_[ch].max = hi;
+            sumSquares_[ch] += sum;
+        }
+
+        binPos_ += frames;
+        done += frames;
+        if (binPos_ == BASE_FRAMES_PER_BIN) {
+            finishBin();
+        }
+    }
+    numFrames_ += numFrames;
+}
+
+void PeakFile::Builder::finishBin()
+{
+    for (int ch = 0; ch < numChannels_; ++ch) {
+        Bin bin = current_[ch];
+        bin.rms = static_cast<float>(std::sqrt(sumSquares_[ch] / binPos_));
+        level0_.push_back(bin);
+        sumSquares_[ch] = 0.0;
+    }
+    binPos_ = 0;
+}
+
+bool PeakFile::Builder::write(const std::string& path, uint64_t sourceSize, int64_t sourceMtime)
+{
+    if (numChannels_ <= 0) return false;
+    if (binPos_ > 0) {
+        finishBin();
+    }
+
+    // Each level merges LEVEL_FACTOR bins of the one below
+    std::vector<std::vector<Bin>> levels;
+    levels.push_back(std::move(level0_));
+    while (true) {
+        const std::vector<Bin>& prev = levels.back();
+        const uint64_t prevBins = prev.size() / numChannels_;
+        const uint64_t bins = (prevBins + LEVEL_FACTOR - 1) / LEVEL_FACTOR;
+        if (bins < static_cast<uint64_t>(MIN_BINS)) break;
+
+        std::vector<Bin> next(bins * numChannels_);
+        for (uint64_t b = 0; b < bins; ++b) {
+            const uint64_t first = b * LEVEL_FACTOR;
+            const uint64_t last = std::min(prevBins, first + LEVEL_FACTOR);
+            for (int ch = 0; ch < numChannels_; ++ch) {
+                Bin merged = prev[first * numChannels_ + ch];
+                double squares = 0.0;
+                for (uint64_t i = first; i < last; ++i) {
+                    const Bin& bin = prev[i * numChannels_ + ch];
+                    merged.min = std::min(merged.min, bin.min);
+                    merged.max = std::max(merged.max, bin.max);
+                    squares += static_cast<double>(bin.rms) * bin.rms;
+                }
+                merged.rms = static_cast<float>(std::sqrt(squares / (last - first)));
+                next[b * numChannels_ + ch] = merged;
+            }
+        }
+        levels.push_back(std::move(next));
+    }
+
+    std::vector<unsigned char> header;
+    header.insert(header.end(), MAGIC, MAGIC + 4);
+    putU32(header, VERSION);
+    putU32(header, static_cast<uint32_t>(sampleRate_));
+    putU32(header, static_cast<uint32_t>(numChannels_));
+    putU64(header, numFrames_);
+    putU64(header, sourceSize);
+    putU64(header, static_cast<uint64_t>(sourceMtime));
+    putU32(header, static_cast<uint32_t>(levels.size()));
+
+    uint64_t offset = HEADER_SIZE + LEVEL_ENTRY_SIZE * levels.size();
+    int framesPerBin = BASE_FRAMES_PER_BIN;
+    for (const auto& level : levels) {
+        const uint64_t bins = level.size() / numChannels_;
+        putU32(header, static_cast<uint32_t>(framesPerBin));
+        putU64(header, bins);
+        putU64(header, offset);
+        offset += level.size() * BIN_SIZE;
+        framesPerBin *= LEVEL_FACTOR;
+    }
+
+    // Written under a temporary name so a reader never maps half a file
+    const std::string tempPath = path + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    std::vector<unsigned char> data;
+    for (const auto& level : levels) {
+        data.clear();
+        data.reserve(level.size() * BIN_SIZE);
+        for (const Bin& bin : level) {
+            putU16(data, static_cast<uint16_t>(quantizeSigned(bin.min)));
+            putU16(data, static_cast<uint16_t>(quantizeSigned(bin.max)));
+            putU16(data, quantizeUnsigned(bin.rms));
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    file.close();
+    if (!file) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    std::remove(path.c_str()); // rename does not replace on Windows
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+// ===== Reader =====
+
+bool PeakFile::open(const std::string& path)
+{
+    close();
+    if (!file_.open(path)) return false;
+
+    const unsigned char* p = file_.data();
+    const size_t size = file_.size();
+    if (size < HEADER_SIZE || std::memcmp(p, MAGIC, 4) != 0 || readU32(p + 4) != VERSION) {
+        close();
+        return false;
+    }
+
+    sampleRate_ = static_cast<int>(readU32(p + 8));
+    numChannels_ = static_cast<int>(readU32(p + 12));
+    numFrames_ = readU64(p + 16);
+    sourceSize_ = readU64(p + 24);
+    sourceMtime_ = static_cast<int64_t>(readU64(p + 32));
+    const uint32_t numLevels = readU32(p + 40);
+
+    if (numChannels_ <= 0 || numLevels == 0 || HEADER_SIZE + LEVEL_ENTRY_SIZE * numLevels > size) {
+        close();
+        return false;
+    }
+    for (uint32_t i = 0; i < numLevels; ++i) {
+        const unsigned char* entry = p + HEADER_SIZE + LEVEL_ENTRY_SIZE * i;
+        Level level{ static_cast<int>(readU32(entry)), readU64(entry + 4), readU64(entry + 12) };
+        if (level.framesPerBin <= 0 || level.offset + level.numBins * numChannels_ * BIN_SIZE > size) {
+            close();
+            return false;
+        }
+        levels_.push_back(level);
+    }
+    return true;
+}
+
+void PeakFile::close()
+{
+    file_.close();
+    levels_.clear();
+    numChannels_ = 0;
+    numFrames_ = 0;
+}
+
+bool PeakFile::matches(uint64_t sourceSize, int64_t sourceMtime) const
+{
+    return isOpen() && sourceSize_ == sourceSize && sourceMtime_ == sourceMtime;
+}
+
+int PeakFile::chooseLevel(double framesPerBin) const
+{
+    int chosen = 0;
+    for (int i = 0; i < getNumLevels(); ++i) {
+        if (levels_[i].framesPerBin <= framesPerBin) {
+            chosen = i;
+        }
+    }
+    return chosen;
+}
+
+PeakFile::Bin PeakFile::getRange(int level, int channel, uint64_t first, uint64_t last) const
+{
+    const Level& l = levels_[level];
+    last = std::min(last, l.numBins);
+    if (first >= last) return Bin{ 0.0f, 0.0f, 0.0f };
+
+    const unsigned char* p = file_.data() + l.offset + (first * numChannels_ + channel) * BIN_SIZE;
+    const size_t stride = numChannels_ * BIN_SIZE;
+    int lo = 32767, hi = -32768;
+    double squares = 0.0;
+    for (uint64_t i = first; i < last; ++i, p += stride) {
+        lo = std::min(lo, static_cast<int>(static_cast<int16_t>(readU16(p))));
+        hi = std::max(hi, static_cast<int>(static_cast<int16_t>(readU16(p + 2))));
+        const double rms = readU16(p + 4) / 65535.0;
+        squares += rms * rms;
+    }
+    return Bin{ lo / 32767.0f, hi / 32767.0f, static_cast<float>(std::sqrt(squares / (last - first))) };
+}
+
+bool PeakFile::restamp(const std::string& path, uint64_t sourceSize, int64_t sourceMtime)
+{
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) return false;
+
+    std::vector<unsigned char> stamp;
+    putU64(stamp, sourceSize);
+    putU64(stamp, static_cast<uint64_t>(sourceMtime));
+    file.seekp(SOURCE_STAMP_OFFSET);
+    file.write(reinterpret_cast<const char*>(stamp.data()), stamp.size());
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,93 @@
+#ifndef PEAKFILE_H
+#define PEAKFILE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "MappedFile.h"
+
+// Waveform overview sidecar: per channel min/max/RMS at several
+// resolutions (256 frames per bin, then 4x coarser per level), so a clip
+// can be drawn at any zoom without reading its audio. Bins are stored as
+// 16-bit values and the file is memory-mapped for reading.
+//
+// The header records the size and mtime of the audio file it was built
+// from, which is how a stale sidecar is recognised.
+class PeakFile {
+public:
+    struct Bin {
+        float min;
+        float max;
+        float rms;
+    };
+
+    // Accumulates level 0 from streamed audio and writes every level at the end
+    class Builder {
+    public:
+        void reset(int sampleRate, int numChannels);
+        void process(const float* const* channels, int numFrames);
+        bool write(const std::string& path, uint64_t sourceSize, int64_t sourceMtime);
+
+    private:
+        void finishBin();
+
+        int sampleRate_{48000};
+        int numChannels_{0};
+        uint64_t numFrames_{0};
+        int binPos_{0};
+        std::vector<Bin> current_;      // per channel, bin in progress
+        std::vector<double> sumSquares_;
+        std::vector<Bin> level0_;       // interleaved by channel
+    };
+
+    PeakFile() = default;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file_.isOpen(); }
+
+    // Whether the sidecar was built from this exact audio file version
+    bool matches(uint64_t sourceSize, int64_t sourceMtime) const;
+
+    // Points an existing sidecar at a new file with the same audio
+    // (e.g. after converting the clip to FLAC)
+    static bool restamp(const std::string& path, uint64_t sourceSize, int64_t sourceMtime);
+
+    int getSampleRate() const { return sampleRate_; }
+    int getNumChannels() const { return numChannels_; }
+    uint64_t getNumFrames() const { return numFrames_; }
+
+    int getNumLevels() const { return static_cast<int>(levels_.size()); }
+    int getFramesPerBin(int level) const { return levels_[level].framesPerBin; }
+    uint64_t getNumBins(int level) const { return levels_[level].numBins; }
+
+    // Coarsest level whose bins are no wider than framesPerBin (level 0 when
+    // zoomed in further than that)
+    int chooseLevel(double framesPerBin) const;
+
+    // Merged bin covering bins [first, last) of one channel at a level
+    Bin getRange(int level, int channel, uint64_t first, uint64_t last) const;
+
+    static const int BASE_FRAMES_PER_BIN = 256;
+    static const int LEVEL_FACTOR = 4;
+
+    // Levels stop once a level would have fewer bins than this
+    static const int MIN_BINS = 64;
+
+private:
+    struct Level {
+        int framesPerBin;
+        uint64_t numBins;
+        uint64_t offset;
+    };
+
+    MappedFile file_;
+    int sampleRate_{0};
+    int numChannels_{0};
+    uint64_t numFrames_{0};
+    uint64_t sourceSize_{0};
+    int64_t sourceMtime_{0};
+    std::vector<Level> levels_;
+};
+
+#endif // PEAKFILE_H
@@ -30,6 +30,24 @@ void PitchShifter::setSampleRate(int sampleRate)
     sampleRate_ = sampleRate;
 }
 
+void PitchShifter::reset()
+{
+    inputPos_ = 0;
+    outputPos_ = 0;
+    resampleReadPos_ = 0.0f;
+    inputWrapped_ = false;
+    vocoderStale_ = true;
+}
+
+void PitchShifter::pushInput(float sample)
+{
+    inputBuffer_[inputPos_] = sample;
+    if (++inputPos_ == static_cast<int>(inputBuffer_.size())) {
+        inputPos_ = 0;
+        inputWrapped_ = true;
+    }
+}
+
 void PitchShifter::process(const float* input, float* outputL, float* outputR, 
                            int numSamples, float semitones)
 {
@@ -37,19 +55,19 @@ void PitchShifter::process(const float* input, float* outputL, float* outputR,
 
     // Fast path for +/-1 semitone using simple resampling (lower latency, fewer artifacts).
     if (std::fabs(semitones) <= 1.0f) {
-        static float readPos = 0.0f;
+        float& readPos = resampleReadPos_;
         float rate = pitchRatio; // playback rate
         for (int i = 0; i < numSamples; ++i) {
             // Read from a small circular buffer (reuse inputBuffer_) for continuity
-            inputBuffer_[inputPos_] = input[i];
-            inputPos_ = (inputPos_ + 1) % inputBuffer_.size();
+            pushInput(input[i]);
             // Wrap readPos inside buffer
             if (readPos >= inputBuffer_.size()) readPos -= (float)inputBuffer_.size();
             // Fractional read with linear interpolation
             int i0 = (int)readPos;
             int i1 = (i0 + 1) % inputBuffer_.size();
             float frac = readPos - i0;
-            float sample = inputBuffer_[i0] + (inputBuffer_[i1] - inputBuffer_[i0]) * frac;
+            const float x0 = readInput(i0);
+            float sample = x0 + (readInput(i1) - x0) * frac;
             readPos += rate; // advance according to pitch ratio
             // Mix some dry to preserve timbre
             float out = sample * 0.85f + input[i] * 0.15f;
@@ -59,6 +77,13 @@ void PitchShifter::process(const float* input, float* outputL, float* outputR,
         return;
     }
     // Legacy phase vocoder path (higher latency, used for >1 semitone future expansion)
+    if (vocoderStale_) {
+        std::fill(lastPhase_.begin(), lastPhase_.end(), 0.0f);
+        std::fill(sumPhase_.begin(), sumPhase_.end(), 0.0f);
+        std::fill(overlapL_.begin(), overlapL_.end(), 0.0f);
+        std::fill(overlapR_.begin(), overlapR_.end(), 0.0f);
+        vocoderStale_ = false;
+    }
     const float dryMix = 0.15f;
     const float wetMix = 1.0f - dryMix;
     float rmsInAccum = 0.0f;
@@ -66,8 +91,7 @@ void PitchShifter::process(const float* input, float* outputL, float* outputR,
     
     for (int i = 0; i < numSamples; ++i) {
         // Add input to buffer
-        inputBuffer_[inputPos_] = input[i];
-        inputPos_ = (inputPos_ + 1) % inputBuffer_.size();
+        pushInput(input[i]);
         
         // Check if we have enough samples for processing
         if (inputPos_ % HOP_SIZE == 0) {
@@ -75,7 +99,7 @@ void PitchShifter::process(const float* input, float* outputL, float* outputR,
             std::vector<float> frame(FFT_SIZE);
             for (int j = 0; j < FFT_SIZE; ++j) {
                 int idx = (inputPos_ - FFT_SIZE + j + inputBuffer_.size()) % inputBuffer_.size();
-                frame[j] = inputBuffer_[idx];
+                frame[j] = readInput(idx);
             }
             
             // Process frame
@@ -10,9 +10,17 @@ public:
     PitchShifter();
     
     void setSampleRate(int sampleRate);
+
+    // Constant time, so it is safe on the audio thread: input not written
+    // since reads as silence, and the vocoder's own memory is cleared the
+    // next time that path runs
+    void reset();
     void process(const float* input, float* outputL, float* outputR, int numSamples, float semitones);
     
 private:
+    void pushInput(float sample);
+    float readInput(int index) const { return (inputWrapped_ || index < inputPos_) ? inputBuffer_[index] : 0.0f; }
+
     void processFrame(const float* input, float* outputL, float* outputR, int frameSize, float pitchRatio);
     void applyWindow(float* buffer, int size);
     void fft(std::complex<float>* data, int size, bool inverse);
@@ -33,6 +41,9 @@ private:
     
     int inputPos_{0};
     int outputPos_{0};
+    float resampleReadPos_{0.0f}; // fast-path read head, per instance
+    bool inputWrapped_{false};     // every input slot written since the last reset
+    bool vocoderStale_{false};     // overlap and phase memory predate the last reset
     
     // Overlap-add buffers
     std::vector<float> overlapL_;
@@ -0,0 +1,141 @@
+#include "PresetBank.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <cmath>
+#include <limits>
+
+namespace {
+    const int RESCAN_DELAY_MS = 200; // coalesces bursts of file events
+}
+
+PresetBank::PresetBank(QObject* parent)
+    : QObject(parent)
+{
+    rescanTimer_.setSingleShot(true);
+    rescanTimer_.setInterval(RESCAN_DELAY_MS);
+
+    // Saving over a preset changes the file but not the directory
+    connect(&watcher_, &QFileSystemWatcher::directoryChanged, this, [this]() { rescanTimer_.start(); });
+    connect(&watcher_, &QFileSystemWatcher::fileChanged, this, [this]() { rescanTimer_.start(); });
+    connect(&rescanTimer_, &QTimer::timeout, this, &PresetBank::sync);
+}
+
+void PresetBank::setDirectory(const QString& directory)
+{
+    if (!watcher_.files().isEmpty()) watcher_.removePaths(watcher_.files());
+    if (!watcher_.directories().isEmpty()) watcher_.removePaths(watcher_.directories());
+
+    directory_ = directory;
+    presets_.clear();
+    watcher_.addPath(directory_);
+    sync();
+}
+
+void PresetBank::setSampleRate(int sampleRate)
+{
+    if (sampleRate == sampleRate_) return;
+    sampleRate_ = sampleRate;
+
+    const ParamValues defaults = DSPParams().snapshot();
+    for (auto it = presets_.begin(); it != presets_.end(); ++it) {
+        auto preset = std::make_shared<Preset>(*it.value());
+        preset->settings = compile(preset->data, defaults);
+        it.value() = preset;
+    }
+}
+
+QStringList PresetBank::names() const
+{
+    return presets_.keys();
+}
+
+std::shared_ptr<const PresetBank::Preset> PresetBank::find(const QString& name) const
+{
+    return presets_.value(name);
+}
+
+std::shared_ptr<const ChainSettings> PresetBank::recall(const Preset& preset, const ParamValues& current) const
+{
+    for (int i = 0; i < DSPParams::count(); ++i) {
+        if (std::isnan(preset.data.params[i]) && current[i] != preset.settings->values[i]) {
+            return compile(preset.data, current);
+        }
+    }
+    return preset.settings;
+}
+
+void PresetBank::sync()
+{
+    if (directory_.isEmpty()) return;
+
+    QDir dir(directory_);
+    QFileInfoList files = dir.entryInfoList(QStringList() << "*.json", QDir::Files);
+
+    // Unchanged files keep their entry; new and modified ones are parsed again
+    QMap<QString, std::shared_ptr<const Preset>> updated;
+    bool changed = false;
+    for (const QFileInfo& file : files) {
+        const QString name = file.completeBaseName();
+        const qint64 mtime = file.lastModified().toMSecsSinceEpoch();
+        auto it = presets_.find(name);
+        if (it != presets_.end() && it.value()->size == file.size() && it.value()->mtime == mtime) {
+            updated.insert(name, it.value());
+            continue;
+        }
+        std::shared_ptr<Preset> preset = read(file.filePath());
+        if (preset) {
+            updated.insert(name, preset);
+        }
+        changed = true;
+    }
+    changed = changed || updated.size() != presets_.size();
+    presets_ = updated;
+
+    // Watch the files themselves for in-place rewrites
+    QStringList watched = watcher_.files();
+    if (!watched.isEmpty()) watcher_.removePaths(watched);
+    for (const QFileInfo& file : files) {
+        watcher_.addPath(file.filePath());
+    }
+
+    if (changed) {
+        emit presetsChanged();
+    }
+}
+
+std::shared_ptr<PresetBank::Preset> PresetBank::read(const QString& path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return nullptr;
+    const QByteArray bytes = file.readAll();
+
+    auto preset = std::make_shared<Preset>();
+    const float missing = std::numeric_limits<float>::quiet_NaN();
+    preset->data.params.fill(missing);
+    preset->data.inputGain = missing;
+    preset->data.outputGain = missing;
+    preset->data.loopLevel = missing;
+    if (!PresetIO::parse(bytes, preset->data)) return nullptr;
+
+    QFileInfo info(path);
+    preset->name = info.completeBaseName();
+    preset->key = static_cast<quint64>(qHash(bytes));
+    preset->size = info.size();
+    preset->mtime = info.lastModified().toMSecsSinceEpoch();
+    preset->settings = compile(preset->data, DSPParams().snapshot());
+    return preset;
+}
+
+std::shared_ptr<const ChainSettings> PresetBank::compile(const PresetData& data, const ParamValues& base) const
+{
+    ParamValues values = base;
+    for (int i = 0; i < DSPParams::count(); ++i) {
+        if (!std::isnan(data.params[i])) values[i] = data.params[i];
+    }
+    auto settings = std::make_shared<ChainSettings>();
+    settings->compile(values, sampleRate_);
+    return settings;
+}
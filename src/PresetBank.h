@@ -0,0 +1,66 @@
+#ifndef PRESETBANK_H
+#define PRESETBANK_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <memory>
+#include "PresetIO.h"
+
+// Every preset file in a directory, parsed once and held in memory with its
+// chain settings compiled for the engine's sample rate. Recalling a preset
+// is then a pointer hand-off to DSPChain::loadPreset() with no file or JSON
+// work. A QFileSystemWatcher re-reads files whose size or mtime changed.
+class PresetBank : public QObject {
+    Q_OBJECT
+
+public:
+    struct Preset {
+        QString name;
+        PresetData data;   // NaN where the file has no key
+        quint64 key{0};    // hash of the file contents
+        qint64 size{0};
+        qint64 mtime{0};   // ms since epoch
+
+        // Keys the file leaves out are taken from the DSPParams defaults
+        std::shared_ptr<const ChainSettings> settings;
+    };
+
+    explicit PresetBank(QObject* parent = nullptr);
+
+    void setDirectory(const QString& directory);
+
+    // Recompiles every preset; engine stopped or just restarted
+    void setSampleRate(int sampleRate);
+
+    // Preset names (file name without extension), sorted
+    QStringList names() const;
+    std::shared_ptr<const Preset> find(const QString& name) const;
+
+    // Settings for recalling a preset over the current parameters. Keys the
+    // file leaves out keep their current values, so the precompiled block is
+    // only used while those still match the defaults it was built with.
+    std::shared_ptr<const ChainSettings> recall(const Preset& preset, const ParamValues& current) const;
+
+    // Compares the directory listing with the bank
+    void sync();
+
+signals:
+    void presetsChanged();
+
+private:
+    std::shared_ptr<Preset> read(const QString& path) const;
+    std::shared_ptr<const ChainSettings> compile(const PresetData& data, const ParamValues& base) const;
+
+    QString directory_;
+    int sampleRate_{48000};
+    QMap<QString, std::shared_ptr<const Preset>> presets_;
+
+    QFileSystemWatcher watcher_;
+    QTimer rescanTimer_;
+};
+
+#endif // PRESETBANK_H
@@ -0,0 +1,86 @@
+#include "PresetIO.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <cmath>
+
+namespace {
+    // Parameters written to preset files, in file order
+    const ParamId PRESET_PARAMS[] = {
+        ParamId::GateBypass, ParamId::GateThreshold,
+        ParamId::DriveBypass, ParamId::DriveAmount, ParamId::DriveType, ParamId::PreGain,
+        ParamId::EqBypass, ParamId::LowGain, ParamId::LowFreq, ParamId::MidGain, ParamId::MidFreq,
+        ParamId::MidQ, ParamId::HighGain, ParamId::HighFreq, ParamId::PresenceGain,
+        ParamId::CompBypass, ParamId::CompThreshold, ParamId::CompRatio,
+        ParamId::PitchBypass, ParamId::PitchMode,
+        ParamId::DelayBypass, ParamId::DelayTime, ParamId::DelayFeedback, ParamId::DelayMix,
+        ParamId::ReverbBypass, ParamId::ReverbSize, ParamId::ReverbDamping, ParamId::ReverbMix
+    };
+
+    void readFloat(const QJsonObject& json, const char* key, float& value)
+    {
+        if (json.contains(key)) value = static_cast<float>(json[key].toDouble());
+    }
+}
+
+void PresetIO::fromJson(const QJsonObject& json, PresetData& preset)
+{
+    for (int i = 0; i < DSPParams::count(); ++i) {
+        const char* key = DSPParams::name(static_cast<ParamId>(i));
+        if (!json.contains(key)) continue;
+
+        QJsonValue value = json[key];
+        preset.params[i] = value.isBool() ? (value.toBool() ? 1.0f : 0.0f)
+                                          : static_cast<float>(value.toDouble());
+    }
+
+    readFloat(json, "inputGain", preset.inputGain);
+    readFloat(json, "outputGain", preset.outputGain);
+    readFloat(json, "loopLevel", preset.loopLevel);
+}
+
+QJsonObject PresetIO::toJson(const PresetData& preset)
+{
+    QJsonObject json;
+    for (ParamId id : PRESET_PARAMS) {
+        const float value = preset.params[static_cast<int>(id)];
+        if (DSPParams::kind(id) == ParamKind::Switch) {
+            json[DSPParams::name(id)] = value >= 0.5f;
+        } else if (DSPParams::kind(id) == ParamKind::Mode) {
+            json[DSPParams::name(id)] = static_cast<int>(std::lround(value));
+        } else {
+            json[DSPParams::name(id)] = static_cast<double>(value);
+        }
+    }
+
+    json["inputGain"] = static_cast<double>(preset.inputGain);
+    json["outputGain"] = static_cast<double>(preset.outputGain);
+    json["loopLevel"] = static_cast<double>(preset.loopLevel);
+    return json;
+}
+
+bool PresetIO::load(const QString& filepath, PresetData& preset)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    return parse(file.readAll(), preset);
+}
+
+bool PresetIO::parse(const QByteArray& data, PresetData& preset)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (!doc.isObject()) return false;
+
+    fromJson(doc.object(), preset);
+    return true;
+}
+
+bool PresetIO::save(const QString& filepath, const PresetData& preset)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QJsonDocument doc(toJson(preset));
+    return file.write(doc.toJson()) >= 0;
+}
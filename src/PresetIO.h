@@ -0,0 +1,31 @@
+#ifndef PRESETIO_H
+#define PRESETIO_H
+
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+#include "DSPChain.h"
+
+// Everything a preset file stores: the effect parameters plus the global
+// gains and loop level
+struct PresetData {
+    ParamValues params{};
+    float inputGain{1.0f};
+    float outputGain{1.0f};
+    float loopLevel{1.0f};
+};
+
+// Preset JSON files. Keys are the DSPParams names; switches are stored as
+// JSON booleans and modes as integers. Keys missing from a file leave the
+// corresponding value in the PresetData untouched.
+class PresetIO {
+public:
+    static bool load(const QString& filepath, PresetData& preset);
+    static bool parse(const QByteArray& data, PresetData& preset);
+    static bool save(const QString& filepath, const PresetData& preset);
+
+    static void fromJson(const QJsonObject& json, PresetData& preset);
+    static QJsonObject toJson(const PresetData& preset);
+};
+
+#endif // PRESETIO_H
@@ -0,0 +1,244 @@
+#include "PresetPreview.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+PresetPreview::PresetPreview()
+{
+    worker_ = std::thread(&PresetPreview::workerLoop, this);
+}
+
+PresetPreview::~PresetPreview()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        stopWorker_ = true;
+        jobWaiting_.store(true); // abandons a render in progress
+    }
+    jobCV_.notify_one();
+    worker_.join();
+    setPlaying(nullptr);
+}
+
+void PresetPreview::setSampleRate(int sampleRate)
+{
+    if (sampleRate == sampleRate_ && !history_.empty()) return;
+
+    // Renders and history at the old rate are no use any more
+    setPlaying(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        cache_.clear();
+    }
+
+    sampleRate_ = sampleRate;
+    history_.assign(static_cast<size_t>(HISTORY_SECONDS) * sampleRate, 0.0f);
+    writePos_.store(0);
+    lastActive_.store(0);
+    phrase_.reset();
+    phraseEnd_ = 0;
+}
+
+void PresetPreview::captureInput(const float* dry, int numSamples)
+{
+    if (history_.empty() || numSamples <= 0) return;
+
+    const size_t capacity = history_.size();
+    const uint64_t pos = writePos_.load(std::memory_order_relaxed);
+    size_t index = static_cast<size_t>(pos % capacity);
+    size_t first = std::min(static_cast<size_t>(numSamples), capacity - index);
+    std::memcpy(history_.data() + index, dry, first * sizeof(float));
+    std::memcpy(history_.data(), dry + first, (numSamples - first) * sizeof(float));
+
+    float peak = 0.0f;
+    for (int i = 0; i < numSamples; ++i) {
+        peak = std::max(peak, std::fabs(dry[i]));
+    }
+
+    writePos_.store(pos + numSamples, std::memory_order_release);
+    if (peak > ACTIVITY_THRESHOLD) {
+        lastActive_.store(pos + numSamples, std::memory_order_relaxed);
+    }
+}
+
+void PresetPreview::mixInto(float* left, float* right, int numSamples, float gain)
+{
+    mixing_.store(true);
+    const Render* render = playing_.load();
+    if (render) {
+        if (restart_.exchange(false)) {
+            playPos_ = 0;
+        }
+        size_t length = render->left.size();
+        size_t count = (playPos_ < length) ? std::min(static_cast<size_t>(numSamples), length - playPos_) : 0;
+        const float* srcL = render->left.data() + playPos_;
+        const float* srcR = render->right.data() + playPos_;
+        for (size_t i = 0; i < count; ++i) {
+            left[i] += srcL[i] * gain;
+            right[i] += srcR[i] * gain;
+        }
+        playPos_ += count;
+        if (playPos_ >= length) {
+            finished_.store(true);
+        }
+    }
+    mixing_.store(false);
+}
+
+void PresetPreview::updatePhrase()
+{
+    const uint64_t written = writePos_.load(std::memory_order_acquire);
+    const uint64_t active = lastActive_.load(std::memory_order_relaxed);
+    if (active == 0) return; // nothing played yet
+
+    // The phrase ends shortly after the last note, so pausing to browse
+    // presets does not fill the preview with silence
+    const uint64_t previewFrames = static_cast<uint64_t>(PREVIEW_SECONDS) * sampleRate_;
+    const uint64_t tailFrames = static_cast<uint64_t>(TAIL_MS) * sampleRate_ / 1000;
+    uint64_t end = std::min(written, active + tailFrames);
+    if (phrase_ && end <= phraseEnd_) return; // nothing new played
+
+    // A second of margin keeps the audio thread off the region being copied
+    const uint64_t capacity = history_.size();
+    const uint64_t margin = static_cast<uint64_t>(sampleRate_);
+    uint64_t start = (end > previewFrames) ? end - previewFrames : 0;
+    if (written - start + margin > capacity) {
+        if (phrase_) return; // the last notes have already scrolled out
+        end = written;
+        start = (end > previewFrames) ? end - previewFrames : 0;
+    }
+
+    auto phrase = std::make_shared<std::vector<float>>(static_cast<size_t>(end - start));
+    size_t index = static_cast<size_t>(start % capacity);
+    size_t first = std::min(phrase->size(), static_cast<size_t>(capacity) - index);
+    std::memcpy(phrase->data(), history_.data() + index, first * sizeof(float));
+    std::memcpy(phrase->data() + first, history_.data(), (phrase->size() - first) * sizeof(float));
+
+    phrase_ = std::move(phrase);
+    phraseEnd_ = end;
+    ++phraseId_;
+}
+
+bool PresetPreview::request(uint64_t key, const ParamValues& params, float inputGain)
+{
+    if (history_.empty()) return false;
+
+    updatePhrase();
+    if (!phrase_) return false;
+    if (findRender(key)) return true;
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        pendingJob_ = std::make_unique<Job>(Job{ key, phraseId_, graphId_, sampleRate_, params, inputGain, graph_, phrase_ });
+        jobWaiting_.store(true);
+    }
+    jobCV_.notify_one();
+    return true;
+}
+
+void PresetPreview::setEffectGraph(const EffectGraph& graph)
+{
+    // Renders in the old order stay cached but no longer match
+    if (graph == graph_) return;
+    graph_ = graph;
+    ++graphId_;
+}
+
+std::shared_ptr<const PresetPreview::Render> PresetPreview::findRender(uint64_t key) const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    for (const auto& render : cache_) {
+        if (render->key == key && render->phraseId == phraseId_ && render->graphId == graphId_) {
+            return render;
+        }
+    }
+    return nullptr;
+}
+
+bool PresetPreview::isReady(uint64_t key) const
+{
+    return findRender(key) != nullptr;
+}
+
+bool PresetPreview::play(uint64_t key)
+{
+    std::shared_ptr<const Render> render = findRender(key);
+    if (!render) return false;
+    setPlaying(std::move(render));
+    return true;
+}
+
+void PresetPreview::stop()
+{
+    setPlaying(nullptr);
+}
+
+bool PresetPreview::isPlaying() const
+{
+    return playing_.load() != nullptr && !finished_.load();
+}
+
+void PresetPreview::setPlaying(std::shared_ptr<const Render> render)
+{
+    restart_.store(true);
+    finished_.store(false);
+    playing_.store(render.get());
+
+    // A callback that loaded the old render may still be reading it
+    while (mixing_.load()) {
+        std::this_thread::yield();
+    }
+    playingHold_ = std::move(render);
+}
+
+void PresetPreview::workerLoop()
+{
+    std::vector<float> input(RENDER_BLOCK);
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex_);
+            jobCV_.wait(lock, [this] { return stopWorker_ || pendingJob_ != nullptr; });
+            if (stopWorker_) return;
+            job = std::move(pendingJob_);
+            jobWaiting_.store(false);
+        }
+
+        // Reusing one chain keeps each render free of allocation
+        if (job->sampleRate != chainSampleRate_) {
+            chain_.setSampleRate(job->sampleRate);
+            chainSampleRate_ = job->sampleRate;
+        }
+        chain_.reset();
+        chain_.getParams().apply(job->params);
+        chain_.setEffectGraph(job->graph);
+
+        auto render = std::make_shared<Render>();
+        render->key = job->key;
+        render->phraseId = job->phraseId;
+        render->graphId = job->graphId;
+        const std::vector<float>& phrase = *job->phrase;
+        render->left.resize(phrase.size());
+        render->right.resize(phrase.size());
+
+        bool abandoned = false;
+        for (size_t pos = 0; pos < phrase.size(); pos += RENDER_BLOCK) {
+            if (jobWaiting_.load()) {
+                abandoned = true;
+                break;
+            }
+            int frames = static_cast<int>(std::min<size_t>(RENDER_BLOCK, phrase.size() - pos));
+            for (int i = 0; i < frames; ++i) {
+                input[i] = phrase[pos + i] * job->inputGain;
+            }
+            chain_.process(input.data(), render->left.data() + pos, render->right.data() + pos, frames);
+        }
+        if (abandoned) continue;
+
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        cache_.push_front(std::move(render));
+        if (cache_.size() > static_cast<size_t>(CACHE_SIZE)) {
+            cache_.pop_back();
+        }
+    }
+}
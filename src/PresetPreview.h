@@ -0,0 +1,112 @@
+#ifndef PRESETPREVIEW_H
+#define PRESETPREVIEW_H
+
+#include <atomic>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+#include "DSPChain.h"
+
+// Audition of presets on the phrase just played, without switching the live
+// chain. The audio thread keeps a rolling DI history; a request snapshots the
+// last phrase and a worker renders it through the preset on its own chain,
+// in the live effect order. Renders are cached per (preset key, phrase,
+// order), so moving back over a preset is instant, and play() mixes a
+// render into the engine output.
+class PresetPreview {
+public:
+    PresetPreview();
+    ~PresetPreview();
+
+    // Engine stopped
+    void setSampleRate(int sampleRate);
+
+    // Audio thread: feed the DI and add the playing preview to the output
+    void captureInput(const float* dry, int numSamples);
+    void mixInto(float* left, float* right, int numSamples, float gain);
+
+    // UI thread. key identifies the preset contents (e.g. a hash of the
+    // file). Returns false when nothing has been played yet.
+    bool request(uint64_t key, const ParamValues& params, float inputGain);
+    void setEffectGraph(const EffectGraph& graph); // for later requests
+    bool isReady(uint64_t key) const;
+    bool play(uint64_t key);
+    void stop();
+    bool isPlaying() const;
+
+    static const int PREVIEW_SECONDS = 6;
+
+private:
+    struct Render {
+        uint64_t key;
+        uint64_t phraseId;
+        uint64_t graphId;
+        std::vector<float> left;
+        std::vector<float> right;
+    };
+    struct Job {
+        uint64_t key;
+        uint64_t phraseId;
+        uint64_t graphId;
+        int sampleRate;
+        ParamValues params;
+        float inputGain;
+        EffectGraph graph;
+        std::shared_ptr<const std::vector<float>> phrase;
+    };
+
+    void workerLoop();
+    void updatePhrase();
+    std::shared_ptr<const Render> findRender(uint64_t key) const;
+    void setPlaying(std::shared_ptr<const Render> render);
+
+    int sampleRate_{48000};
+
+    // DI history: audio thread writes, the UI thread snapshots
+    std::vector<float> history_;
+    std::atomic<uint64_t> writePos_{0};
+    std::atomic<uint64_t> lastActive_{0}; // frame after the last block with signal
+
+    // Current phrase (UI thread)
+    std::shared_ptr<const std::vector<float>> phrase_;
+    uint64_t phraseEnd_{0};
+    uint64_t phraseId_{0};
+
+    // Effect order of new renders (UI thread)
+    EffectGraph graph_{EffectGraph::standard()};
+    uint64_t graphId_{0};
+
+    // Most recent first
+    mutable std::mutex cacheMutex_;
+    std::list<std::shared_ptr<const Render>> cache_;
+
+    // Latest request wins; a render in progress is abandoned for a newer one
+    std::thread worker_;
+    std::mutex jobMutex_;
+    std::condition_variable jobCV_;
+    std::unique_ptr<Job> pendingJob_;
+    std::atomic<bool> jobWaiting_{false};
+    bool stopWorker_{false};
+    DSPChain chain_; // worker thread only
+    int chainSampleRate_{0};
+
+    // Playback: the UI keeps the render alive, the audio thread reads it
+    std::shared_ptr<const Render> playingHold_;
+    std::atomic<const Render*> playing_{nullptr};
+    std::atomic<bool> restart_{false};
+    std::atomic<bool> finished_{false};
+    std::atomic<bool> mixing_{false};
+    size_t playPos_{0};
+
+    static const int HISTORY_SECONDS = 20;
+    static const int TAIL_MS = 500;     // kept after the last note
+    static const int CACHE_SIZE = 16;
+    static const int RENDER_BLOCK = 512;
+    static constexpr float ACTIVITY_THRESHOLD = 0.003f; // about -50 dBFS
+};
+
+#endif // PRESETPREVIEW_H
@@ -0,0 +1,154 @@
+#include "Reamper.h"
+#include "ThreadPool.h"
+#include "AudioFileReader.h"
+#include "WavWriter.h"
+#include <algorithm>
+#include <cstdio>
+
+Reamper::Reamper()
+    : pool_(std::make_unique<ThreadPool>())
+{
+}
+
+Reamper::~Reamper()
+{
+    cancel();
+    pool_->waitAll();
+}
+
+bool Reamper::start(const std::vector<ReampJob>& jobs, const DSPParams& params, const EffectGraph& graph,
+                    SampleFormat format)
+{
+    if (isRunning()) return false;
+    pool_->waitAll();
+
+    jobs_ = jobs;
+    params_.copyFrom(params);
+    graph_ = graph;
+    format_ = format;
+
+    // Header-only pass so progress can be reported in frames
+    totalFrames_ = 0;
+    for (const auto& job : jobs_) {
+        AudioFileReader reader;
+        if (reader.open(job.inputPath)) {
+            totalFrames_ += reader.getNumFrames();
+        }
+    }
+
+    totalJobs_ = static_cast<int>(jobs_.size());
+    finishedJobs_.store(0);
+    failedJobs_.store(0);
+    renderedFrames_.store(0);
+    renderedSeconds_.store(0.0);
+    cancelled_.store(false);
+    elapsedMicros_.store(0);
+    startTime_ = std::chrono::steady_clock::now();
+
+    // One clip per task; jobs_ is not modified again until the pool is idle
+    for (const auto& job : jobs_) {
+        pool_->submit([this, &job] { renderJob(job); });
+    }
+    return true;
+}
+
+void Reamper::cancel()
+{
+    cancelled_.store(true);
+}
+
+bool Reamper::isRunning() const
+{
+    return finishedJobs_.load() < totalJobs_;
+}
+
+float Reamper::getProgress() const
+{
+    if (totalFrames_ == 0) return isRunning() ? 0.0f : 1.0f;
+    return static_cast<float>(static_cast<double>(renderedFrames_.load()) / totalFrames_);
+}
+
+float Reamper::getRealtimeFactor() const
+{
+    double elapsed = getElapsedSeconds();
+    if (elapsed <= 0.0) return 0.0f;
+    return static_cast<float>(renderedSeconds_.load() / elapsed);
+}
+
+double Reamper::getElapsedSeconds() const
+{
+    int64_t frozen = elapsedMicros_.load();
+    if (frozen > 0) return frozen * 1e-6;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+}
+
+void Reamper::renderJob(const ReampJob& job)
+{
+    bool ok = false;
+    AudioFileReader reader;
+    WavWriter writer;
+    writer.setFormat(format_);
+
+    if (!cancelled_.load() && reader.open(job.inputPath)
+        && writer.open(job.outputPath, reader.getSampleRate(), 2)) {
+        const int sampleRate = reader.getSampleRate();
+        const int inputChannels = std::min(reader.getNumChannels(), 2);
+
+        DSPChain chain;
+        chain.setSampleRate(sampleRate);
+        chain.getParams().copyFrom(params_);
+        chain.setEffectGraph(graph_);
+
+        std::vector<float> inL(BLOCK_FRAMES), inR(BLOCK_FRAMES);
+        std::vector<float> outL(BLOCK_FRAMES), outR(BLOCK_FRAMES);
+        float* in[2] = { inL.data(), inR.data() };
+        const float* out[2] = { outL.data(), outR.data() };
+
+        ok = true;
+        uint64_t position = 0;
+        const uint64_t numFrames = reader.getNumFrames();
+        while (position < numFrames) {
+            if (cancelled_.load()) {
+                ok = false;
+                break;
+            }
+            int frames = static_cast<int>(std::min<uint64_t>(BLOCK_FRAMES, numFrames - position));
+            frames = reader.read(position, in, inputChannels, frames);
+            if (frames <= 0) break;
+
+            // A stereo DI is folded to mono, the chain has a single input
+            if (inputChannels == 2) {
+                for (int i = 0; i < frames; ++i) {
+                    inL[i] = 0.5f * (inL[i] + inR[i]);
+                }
+            }
+
+            chain.process(inL.data(), outL.data(), outR.data(), frames);
+            if (!writer.write(out, frames)) {
+                ok = false;
+                break;
+            }
+
+            position += frames;
+            renderedFrames_.fetch_add(frames);
+            double seconds = static_cast<double>(frames) / sampleRate;
+            double total = renderedSeconds_.load();
+            while (!renderedSeconds_.compare_exchange_weak(total, total + seconds)) {
+            }
+        }
+    }
+
+    bool wasOpen = writer.isOpen();
+    if (!writer.close()) ok = false;
+    if (!ok) {
+        failedJobs_.fetch_add(1);
+        if (wasOpen) std::remove(job.outputPath.c_str());
+    }
+
+    // The last job to finish stops the clock for the real-time factor
+    int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime_).count();
+    if (finishedJobs_.fetch_add(1) + 1 == totalJobs_) {
+        elapsedMicros_.store(std::max<int64_t>(1, micros));
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef REAMPER_H
+#define REAMPER_H
+
+#include <atomic>
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include "DSPChain.h"
+#include "PcmConverter.h"
+
+class ThreadPool;
+
+struct ReampJob {
+    std::string inputPath;  // DI clip (WAV or FLAC)
+    std::string outputPath; // stereo render, same length as the input
+};
+
+// Offline rendering of DI clips through the effects chain, faster than real
+// time. Each clip gets its own DSPChain on a pool worker, so clips render in
+// parallel and never touch the live chain. Parameters and the effect order
+// are captured when the batch starts; later changes do not affect it.
+class Reamper {
+public:
+    Reamper();
+    ~Reamper();
+
+    // Returns false if a batch is already running
+    bool start(const std::vector<ReampJob>& jobs, const DSPParams& params, const EffectGraph& graph,
+               SampleFormat format);
+    void cancel();
+
+    bool isRunning() const;
+    int getTotalJobs() const { return totalJobs_; }
+    int getFinishedJobs() const { return finishedJobs_.load(); }
+    int getFailedJobs() const { return failedJobs_.load(); }
+
+    // Fraction of all input frames rendered so far
+    float getProgress() const;
+
+    // Seconds of audio rendered per second of wall-clock time
+    float getRealtimeFactor() const;
+
+private:
+    void renderJob(const ReampJob& job);
+    double getElapsedSeconds() const;
+
+    std::unique_ptr<ThreadPool> pool_;
+    std::vector<ReampJob> jobs_;
+    DSPParams params_;
+    EffectGraph graph_;
+    SampleFormat format_{SampleFormat::Pcm24};
+
+    int totalJobs_{0};
+    uint64_t totalFrames_{0};
+    std::atomic<int> finishedJobs_{0};
+    std::atomic<int> failedJobs_{0};
+    std::atomic<uint64_t> renderedFrames_{0};
+    std::atomic<double> renderedSeconds_{0.0};
+    std::atomic<bool> cancelled_{false};
+
+    std::chrono::steady_clock::time_point startTime_;
+    std::atomic<int64_t> elapsedMicros_{0}; // frozen when the last job finishes
+
+    static const int BLOCK_FRAMES = 1024;
+};
+
+#endif // REAMPER_H
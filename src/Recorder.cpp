@@ -1,17 +1,15 @@
 #include "Recorder.h"
 #include <fstream>
 #include <cstring>
+#include <cstdio>
 #include <algorithm>
+#include <chrono>
 
 Recorder::Recorder()
 {
-    maxRecordFrames_ = 48000 * 600; // 10 minutes max
-    recordBufferL_.reserve(maxRecordFrames_);
-    recordBufferR_.reserve(maxRecordFrames_);
-    
-    ringBufferL_.resize(RING_BUFFER_SIZE, 0.0f);
-    ringBufferR_.resize(RING_BUFFER_SIZE, 0.0f);
-    
+    ring_.reset(NumRingChannels, static_cast<size_t>(sampleRate_) * RING_BUFFER_SECONDS);
+    blocks_.assign(NumRingChannels, std::vector<float>(WRITE_BLOCK_FRAMES, 0.0f));
+
     // Start write thread
     stopWriteThread_.store(false);
     writeThread_ = std::thread(&Recorder::writeThread, this);
@@ -29,161 +27,283 @@ Recorder::~Recorder()
 
 void Recorder::setSampleRate(int sampleRate)
 {
+    // Called before the device starts, so the audio thread is not producing
+    std::lock_guard<std::mutex> lock(fileMutex_);
     sampleRate_ = sampleRate;
-    maxRecordFrames_ = sampleRate * 600;
-    recordBufferL_.reserve(maxRecordFrames_);
-    recordBufferR_.reserve(maxRecordFrames_);
+    ring_.reset(NumRingChannels, static_cast<size_t>(sampleRate) * RING_BUFFER_SECONDS);
 }
 
-void Recorder::processAudio(const float* bufferL, const float* bufferR, int numSamples)
+void Recorder::processAudio(const RecorderStreams& streams, int numSamples)
 {
     if (!recording_.load()) {
         return;
     }
-    
-    // Write to ring buffer
-    for (int i = 0; i < numSamples; ++i) {
-        ringBufferL_[ringWritePos_] = bufferL[i];
-        ringBufferR_[ringWritePos_] = bufferR[i];
-        
-        ringWritePos_ = (ringWritePos_ + 1) % RING_BUFFER_SIZE;
-        
-        // Check for overflow
-        if (ringWritePos_ == ringReadPos_) {
-            // Buffer full, advance read position (drop oldest)
-            ringReadPos_ = (ringReadPos_ + 1) % RING_BUFFER_SIZE;
-        }
+
+    // All streams go through the one ring so they stay sample-aligned.
+    // Frames that do not fit are counted, never overwritten under the reader.
+    const float* channels[NumRingChannels] = {
+        streams.mixL, streams.mixR, streams.dry,
+        streams.wetL, streams.wetR, streams.loopL, streams.loopR
+    };
+    size_t written = ring_.write(channels, static_cast<size_t>(numSamples));
+    if (written < static_cast<size_t>(numSamples)) {
+        droppedFrames_.fetch_add(numSamples - written, std::memory_order_relaxed);
     }
-    
-    writeCV_.notify_one();
 }
 
 void Recorder::writeThread()
 {
     while (!stopWriteThread_.load()) {
-        std::unique_lock<std::mutex> lock(writeMutex_);
-        writeCV_.wait(lock, [this] { 
-            return stopWriteThread_.load() || ringReadPos_ != ringWritePos_; 
-        });
-        
+        {
+            std::unique_lock<std::mutex> lock(writeMutex_);
+            writeCV_.wait_for(lock, std::chrono::milliseconds(WRITER_POLL_MS), [this] {
+                return stopWriteThread_.load();
+            });
+        }
+
         if (stopWriteThread_.load()) {
             break;
         }
-        
-        // Copy from ring buffer to main buffer
-        std::lock_guard<std::mutex> bufferLock(bufferMutex_);
-        
-        while (ringReadPos_ != ringWritePos_ && recordedFrames_ < maxRecordFrames_) {
-            recordBufferL_.push_back(ringBufferL_[ringReadPos_]);
-            recordBufferR_.push_back(ringBufferR_[ringReadPos_]);
-            
-            ringReadPos_ = (ringReadPos_ + 1) % RING_BUFFER_SIZE;
-            recordedFrames_++;
+
+        std::lock_guard<std::mutex> fileLock(fileMutex_);
+        drainRingBuffer();
+    }
+}
+
+void Recorder::drainRingBuffer()
+{
+    // Caller holds fileMutex_
+    if (!isWriterOpen()) {
+        ring_.discardAll();
+        return;
+    }
+
+    float* blocks[NumRingChannels];
+    for (int ch = 0; ch < NumRingChannels; ++ch) {
+        blocks[ch] = blocks_[ch].data();
+    }
+
+    const float* channels[NumRingChannels];
+    size_t frames;
+    while ((frames = ring_.read(blocks, WRITE_BLOCK_FRAMES)) > 0) {
+        for (auto& output : outputs_) {
+            for (size_t i = 0; i < output->channels.size(); ++i) {
+                channels[i] = blocks_[output->channels[i]].data();
+            }
+            if (output->flacEncoder.isOpen()) {
+                output->flacEncoder.write(channels, static_cast<int>(frames));
+            } else {
+                output->wavWriter.write(channels, static_cast<int>(frames));
+            }
+        }
+        recordedFrames_.fetch_add(frames);
+        framesSinceHeaderUpdate_ += frames;
+    }
+
+    // Refresh the headers about once a second so a crash leaves playable files
+    if (framesSinceHeaderUpdate_ >= static_cast<uint64_t>(sampleRate_)) {
+        for (auto& output : outputs_) {
+            if (output->flacEncoder.isOpen()) {
+                output->flacEncoder.updateHeader();
+            } else {
+                output->wavWriter.updateHeader();
+            }
         }
+        framesSinceHeaderUpdate_ = 0;
+    }
+}
+
+bool Recorder::isWriterOpen() const
+{
+    for (const auto& output : outputs_) {
+        if (output->isOpen()) return true;
+    }
+    return false;
+}
+
+void Recorder::closeOutputs()
+{
+    for (auto& output : outputs_) {
+        output->wavWriter.close();
+        output->flacEncoder.close();
+    }
+}
+
+void Recorder::setOutputFormat(SampleFormat format, bool dither)
+{
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    format_ = format;
+    dither_ = dither;
+}
+
+void Recorder::setFlacEncoding(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    flacEncoding_ = enabled;
+}
+
+void Recorder::setStems(int stemMask, bool combined)
+{
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    stemMask_ = stemMask;
+    combinedStems_ = combined;
+}
+
+std::string Recorder::stemPath(const std::string& takePath, const std::string& suffix)
+{
+    // Insert the suffix before the extension: Clip.wav -> Clip_DI.wav
+    size_t dot = takePath.find_last_of('.');
+    size_t slash = takePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return takePath + suffix;
     }
+    return takePath.substr(0, dot) + suffix + takePath.substr(dot);
 }
 
-void Recorder::startRecording()
+bool Recorder::startRecording()
 {
-    clearRecording();
+    if (recording_.load() || autoSavePath_.empty()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    recordedFrames_.store(0);
+    droppedFrames_.store(0);
+    framesSinceHeaderUpdate_ = 0;
+    ring_.discardAll();
+
+    // The mix always goes to the take file; stems get their own files or
+    // ride along as extra channels
+    struct StemLayout { int stem; const char* suffix; std::vector<int> channels; };
+    const StemLayout stems[] = {
+        { StemDry, "_DI", { RingDry } },
+        { StemWet, "_Wet", { RingWetL, RingWetR } },
+        { StemLoop, "_Loops", { RingLoopL, RingLoopR } }
+    };
+
+    outputs_.clear();
+    auto mix = std::make_unique<TakeOutput>();
+    mix->channels = { RingMixL, RingMixR };
+    outputs_.push_back(std::move(mix));
+    for (const auto& stem : stems) {
+        if (!(stemMask_ & stem.stem)) continue;
+        if (combinedStems_) {
+            auto& channels = outputs_.front()->channels;
+            channels.insert(channels.end(), stem.channels.begin(), stem.channels.end());
+        } else {
+            auto output = std::make_unique<TakeOutput>();
+            output->channels = stem.channels;
+            output->suffix = stem.suffix;
+            outputs_.push_back(std::move(output));
+        }
+    }
+
+    bool opened = true;
+    for (auto& output : outputs_) {
+        output->path = output->suffix.empty() ? autoSavePath_ : stemPath(autoSavePath_, output->suffix);
+        const int numChannels = static_cast<int>(output->channels.size());
+        if (flacEncoding_) {
+            output->flacEncoder.setFormat(format_);
+            output->flacEncoder.setDither(dither_);
+            opened = opened && output->flacEncoder.open(output->path, sampleRate_, numChannels);
+        } else {
+            output->wavWriter.setFormat(format_);
+            output->wavWriter.setDither(dither_);
+            opened = opened && output->wavWriter.open(output->path, sampleRate_, numChannels);
+        }
+    }
+
+    if (!opened) {
+        closeOutputs();
+        for (const auto& output : outputs_) {
+            std::remove(output->path.c_str());
+        }
+        outputs_.clear();
+        takePath_.clear();
+        return false;
+    }
+    takePath_ = autoSavePath_;
     recording_.store(true);
+    return true;
 }
 
 void Recorder::stopRecording()
 {
-    recording_.store(false);
+    if (!recording_.exchange(false)) {
+        return;
+    }
+
+    // Flush whatever the writer thread has not picked up yet and finalize the headers
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    drainRingBuffer();
+    closeOutputs();
 }
 
 void Recorder::clearRecording()
 {
-    std::lock_guard<std::mutex> lock(bufferMutex_);
-    recordBufferL_.clear();
-    recordBufferR_.clear();
-    recordedFrames_ = 0;
-    ringReadPos_ = ringWritePos_;
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    recordedFrames_.store(0);
+    takePath_.clear();
+    outputs_.clear();
+    ring_.discardAll();
 }
 
 float Recorder::getRecordingDuration() const
 {
-    return static_cast<float>(recordedFrames_) / sampleRate_;
+    return static_cast<float>(recordedFrames_.load()) / sampleRate_;
 }
 
-bool Recorder::saveToFile(const std::string& filepath)
+std::vector<std::string> Recorder::getTakePaths() const
 {
-    std::lock_guard<std::mutex> lock(bufferMutex_);
-    
-    if (recordedFrames_ == 0) {
+    std::vector<std::string> paths;
+    for (const auto& output : outputs_) {
+        paths.push_back(output->path);
+    }
+    return paths;
+}
+
+bool Recorder::moveFile(const std::string& from, const std::string& to)
+{
+    if (std::rename(from.c_str(), to.c_str()) == 0) {
+        return true;
+    }
+
+    // Different volume (or target exists): fall back to copy + delete
+    std::ifstream src(from, std::ios::binary);
+    std::ofstream dst(to, std::ios::binary | std::ios::trunc);
+    if (!src.is_open() || !dst.is_open()) {
+        return false;
+    }
+    dst << src.rdbuf();
+    if (!dst.good()) {
         return false;
     }
-    
-    writeWavFile(filepath);
+    src.close();
+    std::remove(from.c_str());
     return true;
 }
 
-void Recorder::writeWavFile(const std::string& filepath)
+bool Recorder::saveToFile(const std::string& filepath)
 {
-    std::ofstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        return;
+    std::lock_guard<std::mutex> lock(fileMutex_);
+
+    // The take is already on disk; saving moves it (and its stems) to the chosen location
+    if (recordedFrames_.load() == 0 || takePath_.empty() || isWriterOpen()) {
+        return false;
+    }
+    if (filepath == takePath_) {
+        return true;
     }
-    
-    // WAV header
-    const int numChannels = 2;
-    const int bitsPerSample = 24;
-    const int bytesPerSample = bitsPerSample / 8;
-    const int byteRate = sampleRate_ * numChannels * bytesPerSample;
-    const int blockAlign = numChannels * bytesPerSample;
-    const int dataSize = recordedFrames_ * numChannels * bytesPerSample;
-    
-    // RIFF header
-    file.write("RIFF", 4);
-    int chunkSize = 36 + dataSize;
-    file.write(reinterpret_cast<const char*>(&chunkSize), 4);
-    file.write("WAVE", 4);
-    
-    // fmt chunk
-    file.write("fmt ", 4);
-    int fmtSize = 16;
-    file.write(reinterpret_cast<const char*>(&fmtSize), 4);
-    short audioFormat = 1; // PCM
-    file.write(reinterpret_cast<const char*>(&audioFormat), 2);
-    short channels = numChannels;
-    file.write(reinterpret_cast<const char*>(&channels), 2);
-    file.write(reinterpret_cast<const char*>(&sampleRate_), 4);
-    file.write(reinterpret_cast<const char*>(&byteRate), 4);
-    short blockAlignShort = blockAlign;
-    file.write(reinterpret_cast<const char*>(&blockAlignShort), 2);
-    short bps = bitsPerSample;
-    file.write(reinterpret_cast<const char*>(&bps), 2);
-    
-    // data chunk
-    file.write("data", 4);
-    file.write(reinterpret_cast<const char*>(&dataSize), 4);
-    
-    // Write interleaved samples
-    for (size_t i = 0; i < recordedFrames_; ++i) {
-        // Convert float to 24-bit PCM
-        auto floatTo24bit = [](float sample) -> int {
-            sample = std::max(-1.0f, std::min(1.0f, sample));
-            return static_cast<int>(sample * 8388607.0f); // 2^23 - 1
-        };
-        
-        int sampleL = floatTo24bit(recordBufferL_[i]);
-        int sampleR = floatTo24bit(recordBufferR_[i]);
-        
-        // Write 24-bit samples (little-endian)
-        char bytes[3];
-        
-        bytes[0] = sampleL & 0xFF;
-        bytes[1] = (sampleL >> 8) & 0xFF;
-        bytes[2] = (sampleL >> 16) & 0xFF;
-        file.write(bytes, 3);
-        
-        bytes[0] = sampleR & 0xFF;
-        bytes[1] = (sampleR >> 8) & 0xFF;
-        bytes[2] = (sampleR >> 16) & 0xFF;
-        file.write(bytes, 3);
-    }
-    
-    file.close();
-}
\ No newline at end of file
+
+    for (auto& output : outputs_) {
+        std::string target = output->suffix.empty() ? filepath : stemPath(filepath, output->suffix);
+        if (!moveFile(output->path, target)) {
+            takePath_ = outputs_.front()->path;
+            return false;
+        }
+        output->path = target;
+    }
+
+    takePath_ = filepath;
+    return true;
+}
@@ -7,56 +7,125 @@
 #include <thread>
 #include <condition_variable>
 #include <string>
+#include <cstdint>
+#include <memory>
+#include "WavWriter.h"
+#include "FlacEncoder.h"
+#include "SpscRingBuffer.h"
+
+// One engine block, all streams sample-aligned. The mix is the post-gain
+// output; dry is the input after input gain, without clips or backing tracks
+// fed through the effects; wet is the effects chain output and loop the
+// looper's own output, both before output gain.
+struct RecorderStreams {
+    const float* mixL;
+    const float* mixR;
+    const float* dry;
+    const float* wetL;
+    const float* wetR;
+    const float* loopL;
+    const float* loopR;
+};
 
 class Recorder {
 public:
     Recorder();
     ~Recorder();
-    
+
+    // Optional streams recorded next to the mix
+    enum Stem {
+        StemDry = 1 << 0,
+        StemWet = 1 << 1,
+        StemLoop = 1 << 2
+    };
+
     void setSampleRate(int sampleRate);
-    void processAudio(const float* bufferL, const float* bufferR, int numSamples);
-    
-    // Recording control
-    void startRecording();
+    void processAudio(const RecorderStreams& streams, int numSamples);
+
+    // Recording control. Takes stream straight to autoSavePath while recording.
+    bool startRecording();
     void stopRecording();
     bool isRecording() const { return recording_.load(); }
-    
+
     // File management
     bool saveToFile(const std::string& filepath);
     void setAutoSavePath(const std::string& path) { autoSavePath_ = path; }
     
+    // Output format for the next take. FLAC is encoded on the writer thread.
+    void setOutputFormat(SampleFormat format, bool dither);
+    void setFlacEncoding(bool enabled);
+
+    // Stems for the next take: separate files named <take>_DI, _Wet and
+    // _Loops, or extra channels of the take file itself when combined
+    void setStems(int stemMask, bool combined);
+    const std::string& getTakePath() const { return takePath_; }
+    std::vector<std::string> getTakePaths() const;
+
     // Status
     float getRecordingDuration() const;
-    bool hasRecordedAudio() const { return recordedFrames_ > 0; }
+    bool hasRecordedAudio() const { return recordedFrames_.load() > 0; }
+    uint64_t getDroppedFrames() const { return droppedFrames_.load(); }
     void clearRecording();
-    
+
 private:
-    void writeWavFile(const std::string& filepath);
+    // Ring layout: every stream is always captured, the writer picks what it needs
+    enum RingChannel {
+        RingMixL, RingMixR, RingDry, RingWetL, RingWetR, RingLoopL, RingLoopR,
+        NumRingChannels
+    };
+
+    // One file of the take and the ring channels it receives
+    struct TakeOutput {
+        WavWriter wavWriter;
+        FlacEncoder flacEncoder;
+        std::vector<int> channels;
+        std::string suffix;
+        std::string path;
+
+        bool isOpen() const { return wavWriter.isOpen() || flacEncoder.isOpen(); }
+    };
+
     void writeThread();
-    
+    void drainRingBuffer();
+    void closeOutputs();
+    bool isWriterOpen() const;
+    static std::string stemPath(const std::string& takePath, const std::string& suffix);
+    static bool moveFile(const std::string& from, const std::string& to);
+
     std::atomic<bool> recording_{false};
     std::atomic<bool> stopWriteThread_{false};
-    
-    std::vector<float> recordBufferL_;
-    std::vector<float> recordBufferR_;
-    std::mutex bufferMutex_;
-    
+
+    // Guards the outputs and the consumer side of the ring buffer
+    std::mutex fileMutex_;
+    std::vector<std::unique_ptr<TakeOutput>> outputs_;
+    std::string takePath_;
+
+    SampleFormat format_{SampleFormat::Pcm24};
+    bool dither_{false};
+    bool flacEncoding_{false};
+    int stemMask_{0};
+    bool combinedStems_{false};
+
     int sampleRate_{48000};
-    size_t recordedFrames_{0};
-    size_t maxRecordFrames_;
-    
+    std::atomic<uint64_t> recordedFrames_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
+    uint64_t framesSinceHeaderUpdate_{0};
+
     std::string autoSavePath_;
-    
-    // Ring buffer for thread-safe recording
-    static const int RING_BUFFER_SIZE = 48000 * 10; // 10 seconds buffer
-    std::vector<float> ringBufferL_;
-    std::vector<float> ringBufferR_;
-    int ringWritePos_{0};
-    int ringReadPos_{0};
-    
+
+    // Audio thread -> writer thread hand-off (about 10 seconds)
+    static const int RING_BUFFER_SECONDS = 10;
+    SpscRingBuffer ring_;
+
+    // Contiguous blocks handed to the writers
+    static const int WRITE_BLOCK_FRAMES = 16384;
+    std::vector<std::vector<float>> blocks_;
+
+    // The audio thread never signals; the writer polls with a timed wait
+    static const int WRITER_POLL_MS = 5;
     std::thread writeThread_;
     std::condition_variable writeCV_;
     std::mutex writeMutex_;
 };
 
-#endif // RECORDER_H
\ No newline at end of file
+#endif // RECORDER_H
@@ -0,0 +1,143 @@
+#include "Resampler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    // Zeroth-order modified Bessel function, for the Kaiser window
+    double besselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 50; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+}
+
+void Resampler::reset(int numChannels, double inputRate, double outputRate)
+{
+    numChannels_ = numChannels;
+    step_ = inputRate / outputRate;
+    passthrough_ = inputRate == outputRate;
+    buffers_.assign(numChannels, std::vector<float>());
+    position_ = 0.0;
+    table_.clear();
+    if (passthrough_) return;
+
+    // Cutoff in cycles per input sample
+    const double cutoff = 0.5 * PASSBAND * std::min(1.0, outputRate / inputRate);
+    halfTaps_ = static_cast<int>(std::ceil(ZERO_CROSSINGS / (2.0 * cutoff)));
+    taps_ = 2 * halfTaps_;
+
+    // Tap k of phase p weights input sample n - halfTaps_ + 1 + k for an output at n + p / PHASES
+    table_.resize(static_cast<size_t>(PHASES + 1) * taps_);
+    const double norm = besselI0(KAISER_BETA);
+    for (int p = 0; p <= PHASES; ++p) {
+        const double frac = static_cast<double>(p) / PHASES;
+        for (int k = 0; k < taps_; ++k) {
+            const double t = (k - halfTaps_ + 1) - frac;
+            const double x = 2.0 * cutoff * t;
+            const double sinc = (std::abs(x) < 1e-9) ? 1.0 : std::sin(PI * x) / (PI * x);
+            const double r = t / halfTaps_;
+            const double window = (std::abs(r) >= 1.0) ? 0.0 : besselI0(KAISER_BETA * std::sqrt(1.0 - r * r)) / norm;
+            table_[static_cast<size_t>(p) * taps_ + k] = static_cast<float>(2.0 * cutoff * sinc * window);
+        }
+    }
+
+    // History before the first sample, so output 0 lines up with input 0
+    for (auto& buffer : buffers_) {
+        buffer.assign(halfTaps_ - 1, 0.0f);
+    }
+}
+
+void Resampler::reserve(int numFrames)
+{
+    for (auto& buffer : buffers_) {
+        buffer.reserve(static_cast<size_t>(numFrames) + taps_);
+    }
+}
+
+void Resampler::clear()
+{
+    position_ = 0.0;
+    for (auto& buffer : buffers_) {
+        buffer.assign(passthrough_ ? 0 : halfTaps_ - 1, 0.0f);
+    }
+}
+
+void Resampler::push(const float* const* input, int numFrames)
+{
+    for (int ch = 0; ch < numChannels_; ++ch) {
+        buffers_[ch].insert(buffers_[ch].end(), input[ch], input[ch] + numFrames);
+    }
+}
+
+void Resampler::flush()
+{
+    for (auto& buffer : buffers_) {
+        buffer.insert(buffer.end(), halfTaps_, 0.0f);
+    }
+}
+
+int Resampler::getAvailable() const
+{
+    if (numChannels_ == 0) return 0;
+    const double buffered = static_cast<double>(buffers_[0].size());
+    if (passthrough_) return static_cast<int>(buffered);
+
+    // Output at position x needs input up to floor(x) + taps_ - 1 (buffer coordinates)
+    const double last = buffered - taps_;
+    if (last < position_) return 0;
+    return static_cast<int>(std::floor((last - position_) / step_)) + 1;
+}
+
+int Resampler::pull(float* const* output, int maxFrames)
+{
+    const int frames = std::min(maxFrames, getAvailable());
+    if (frames <= 0) return 0;
+
+    if (passthrough_) {
+        for (int ch = 0; ch < numChannels_; ++ch) {
+            std::copy(buffers_[ch].begin(), buffers_[ch].begin() + frames, output[ch]);
+            buffers_[ch].erase(buffers_[ch].begin(), buffers_[ch].begin() + frames);
+        }
+        return frames;
+    }
+
+    for (int ch = 0; ch < numChannels_; ++ch) {
+        const float* in = buffers_[ch].data();
+        float* out = output[ch];
+        double pos = position_;
+        for (int i = 0; i < frames; ++i, pos += step_) {
+            const int base = static_cast<int>(pos);
+            const double phase = (pos - base) * PHASES;
+            const int p = static_cast<int>(phase);
+            const float mix = static_cast<float>(phase - p);
+            const float* c0 = table_.data() + static_cast<size_t>(p) * taps_;
+            const float* c1 = c0 + taps_;
+            const float* x = in + base;
+
+            float acc0 = 0.0f;
+            float acc1 = 0.0f;
+            for (int k = 0; k < taps_; ++k) {
+                acc0 += x[k] * c0[k];
+                acc1 += x[k] * c1[k];
+            }
+            out[i] = acc0 + (acc1 - acc0) * mix;
+        }
+    }
+
+    // Drop input no later output can reach
+    position_ += frames * step_;
+    const int consumed = static_cast<int>(position_);
+    for (auto& buffer : buffers_) {
+        buffer.erase(buffer.begin(), buffer.begin() + consumed);
+    }
+    position_ -= consumed;
+    return frames;
+}
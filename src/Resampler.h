@@ -0,0 +1,60 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <vector>
+
+// Streaming polyphase sample-rate converter for any rate ratio. The
+// Kaiser-windowed sinc kernel is tabulated at PHASES sub-sample offsets and
+// interpolated between neighbouring phases. When downsampling, the cutoff
+// drops to the output Nyquist and the kernel widens to keep its quality.
+// Equal rates pass samples through untouched.
+class Resampler {
+public:
+    Resampler() = default;
+
+    // Allocates; call before streaming
+    void reset(int numChannels, double inputRate, double outputRate);
+
+    // Room for numFrames of pending input beyond the kernel, so a caller on
+    // the audio thread that never holds more than that doesn't allocate
+    void reserve(int numFrames);
+
+    // Drops pending input and output, keeping the kernel (e.g. on a seek).
+    // Doesn't allocate.
+    void clear();
+
+    // Appends input frames. Converted output is taken with pull().
+    void push(const float* const* input, int numFrames);
+
+    // Returns the number of frames written (up to maxFrames)
+    int pull(float* const* output, int maxFrames);
+
+    // Pads the input so every pushed sample reaches the output
+    void flush();
+
+    // Output frames ready without more input
+    int getAvailable() const;
+
+    double getRatio() const { return step_; } // input frames per output frame
+
+    static const int PHASES = 256;
+    static const int ZERO_CROSSINGS = 32;     // per side, at the cutoff frequency
+    static constexpr double KAISER_BETA = 9.0;   // about -90 dB stopband
+    static constexpr double PASSBAND = 0.9;      // cutoff, as a fraction of the lower Nyquist
+
+private:
+    bool passthrough_{true};
+    int numChannels_{0};
+    int halfTaps_{0};
+    int taps_{0};
+    double step_{1.0};
+
+    // (PHASES + 1) x taps_ coefficients; phase PHASES is the next sample's phase 0
+    std::vector<float> table_;
+
+    // Per channel pending input; position_ is the next output's input position
+    std::vector<std::vector<float>> buffers_;
+    double position_{0.0};
+};
+
+#endif // RESAMPLER_H
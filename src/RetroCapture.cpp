@@ -0,0 +1,183 @@
+#include "RetroCapture.h"
+#include "WavWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+RetroCapture::~RetroCapture()
+{
+    if (captureThread_.joinable()) {
+        captureThread_.join();
+    }
+}
+
+void RetroCapture::configure(int maxSeconds, bool compact16)
+{
+    reallocate(sampleRate_, std::max(0, maxSeconds), compact16);
+}
+
+void RetroCapture::setSampleRate(int sampleRate)
+{
+    if (sampleRate == sampleRate_) return;
+    reallocate(sampleRate, maxSeconds_, compact16_);
+}
+
+void RetroCapture::reallocate(int sampleRate, int maxSeconds, bool compact16)
+{
+    // Stop the audio thread from touching the ring, then wait for a
+    // callback that already passed the check to finish
+    enabled_.store(false);
+    while (processing_.load()) {
+        std::this_thread::yield();
+    }
+    if (captureThread_.joinable()) {
+        captureThread_.join();
+    }
+
+    sampleRate_ = sampleRate;
+    maxSeconds_ = maxSeconds;
+    compact16_ = compact16;
+    floatData_.clear();
+    floatData_.shrink_to_fit();
+    shortData_.clear();
+    shortData_.shrink_to_fit();
+    capacity_ = 0;
+    writePos_.store(0);
+    writeIndex_ = 0;
+
+    if (maxSeconds_ <= 0) {
+        return;
+    }
+
+    capacity_ = static_cast<size_t>(maxSeconds_ + GUARD_SECONDS) * sampleRate_;
+    if (compact16_) {
+        shortData_.assign(capacity_ * NumChannels, 0);
+    } else {
+        floatData_.assign(capacity_ * NumChannels, 0.0f);
+    }
+    enabled_.store(true);
+}
+
+float RetroCapture::getAvailableSeconds() const
+{
+    if (!enabled_.load()) return 0.0f;
+    uint64_t frames = std::min<uint64_t>(writePos_.load(), static_cast<uint64_t>(maxSeconds_) * sampleRate_);
+    return static_cast<float>(frames) / sampleRate_;
+}
+
+void RetroCapture::process(const float* dry, const float* wetL, const float* wetR, int numSamples)
+{
+    processing_.store(true);
+    if (!enabled_.load()) {
+        processing_.store(false);
+        return;
+    }
+
+    const float* channels[NumChannels] = { dry, wetL, wetR };
+    int done = 0;
+    while (done < numSamples) {
+        const int count = static_cast<int>(std::min<size_t>(numSamples - done, capacity_ - writeIndex_));
+        for (int ch = 0; ch < NumChannels; ++ch) {
+            const float* src = channels[ch] + done;
+            const size_t offset = ch * capacity_ + writeIndex_;
+            if (compact16_) {
+                int16_t* dst = shortData_.data() + offset;
+                for (int i = 0; i < count; ++i) {
+                    float x = std::max(-1.0f, std::min(1.0f, src[i]));
+                    dst[i] = static_cast<int16_t>(std::lrint(x * 32767.0f));
+                }
+            } else {
+                std::memcpy(floatData_.data() + offset, src, count * sizeof(float));
+            }
+        }
+        writeIndex_ += count;
+        if (writeIndex_ == capacity_) writeIndex_ = 0;
+        done += count;
+    }
+
+    writePos_.store(writePos_.load(std::memory_order_relaxed) + numSamples, std::memory_order_release);
+    processing_.store(false);
+}
+
+void RetroCapture::readFrames(uint64_t startFrame, int numFrames, float* const* out) const
+{
+    size_t index = static_cast<size_t>(startFrame % capacity_);
+    int done = 0;
+    while (done < numFrames) {
+        const int count = static_cast<int>(std::min<size_t>(numFrames - done, capacity_ - index));
+        for (int ch = 0; ch < NumChannels; ++ch) {
+            const size_t offset = ch * capacity_ + index;
+            if (compact16_) {
+                const int16_t* src = shortData_.data() + offset;
+                for (int i = 0; i < count; ++i) {
+                    out[ch][done + i] = src[i] * (1.0f / 32767.0f);
+                }
+            } else {
+                std::memcpy(out[ch] + done, floatData_.data() + offset, count * sizeof(float));
+            }
+        }
+        index = (index + count) % capacity_;
+        done += count;
+    }
+}
+
+bool RetroCapture::captureLast(float seconds, const std::string& wetPath, const std::string& diPath, SampleFormat format)
+{
+    if (!enabled_.load() || capturing_.load()) {
+        return false;
+    }
+    if (captureThread_.joinable()) {
+        captureThread_.join();
+    }
+
+    // The window ends now; everything before it stays put for GUARD_SECONDS
+    const uint64_t end = writePos_.load(std::memory_order_acquire);
+    const uint64_t maxFrames = static_cast<uint64_t>(maxSeconds_) * sampleRate_;
+    const uint64_t frames = std::min({ static_cast<uint64_t>(seconds * sampleRate_), end, maxFrames });
+    if (frames == 0) {
+        return false;
+    }
+
+    capturing_.store(true);
+    captureThread_ = std::thread([this, wetPath, diPath, format, end, frames]() {
+        WavWriter wetWriter;
+        WavWriter diWriter;
+        wetWriter.setFormat(format);
+        diWriter.setFormat(format);
+        bool ok = wetWriter.open(wetPath, sampleRate_, 2) && diWriter.open(diPath, sampleRate_, 1);
+
+        std::vector<float> block(static_cast<size_t>(COPY_BLOCK_FRAMES) * NumChannels);
+        float* channels[NumChannels] = {
+            block.data(), block.data() + COPY_BLOCK_FRAMES, block.data() + 2 * COPY_BLOCK_FRAMES
+        };
+        const float* wet[2] = { channels[ChannelWetL], channels[ChannelWetR] };
+        const float* di[1] = { channels[ChannelDry] };
+
+        for (uint64_t pos = end - frames; ok && pos < end; ) {
+            const int count = static_cast<int>(std::min<uint64_t>(COPY_BLOCK_FRAMES, end - pos));
+            readFrames(pos, count, channels);
+
+            // If the audio thread lapped this block while it was copied, the
+            // audio is no longer the take; give up rather than write garbage
+            const uint64_t guard = static_cast<uint64_t>(COPY_BLOCK_FRAMES);
+            if (writePos_.load(std::memory_order_acquire) + guard > pos + capacity_) {
+                ok = false;
+                break;
+            }
+
+            ok = wetWriter.write(wet, count) && diWriter.write(di, count);
+            pos += count;
+        }
+
+        ok = wetWriter.close() && ok;
+        ok = diWriter.close() && ok;
+        if (!ok) {
+            std::remove(wetPath.c_str());
+            std::remove(diPath.c_str());
+        }
+        captureOk_.store(ok);
+        capturing_.store(false);
+    });
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef RETROCAPTURE_H
+#define RETROCAPTURE_H
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <string>
+#include <cstdint>
+#include "PcmConverter.h"
+
+// Always-on history of the last few minutes of DI and wet output, so a take
+// can be kept after it was played. The audio thread writes into a
+// preallocated planar ring (float, or int16 to halve memory); captureLast()
+// copies a window out and writes it to disk on a background thread.
+class RetroCapture {
+public:
+    RetroCapture() = default;
+    ~RetroCapture();
+
+    // Either call (re)allocates the ring; maxSeconds of 0 turns capture off
+    void configure(int maxSeconds, bool compact16);
+    void setSampleRate(int sampleRate);
+
+    bool isEnabled() const { return enabled_.load(); }
+    int getMaxSeconds() const { return maxSeconds_; }
+    bool isCompact() const { return compact16_; }
+    float getAvailableSeconds() const;
+
+    // Audio thread
+    void process(const float* dry, const float* wetL, const float* wetR, int numSamples);
+
+    // Writes the last `seconds` as a stereo wet file and a mono DI file
+    bool captureLast(float seconds, const std::string& wetPath, const std::string& diPath, SampleFormat format);
+    bool isCapturing() const { return capturing_.load(); }
+    bool lastCaptureOk() const { return captureOk_.load(); }
+
+private:
+    enum Channel { ChannelDry, ChannelWetL, ChannelWetR, NumChannels };
+
+    void reallocate(int sampleRate, int maxSeconds, bool compact16);
+    void readFrames(uint64_t startFrame, int numFrames, float* const* out) const;
+
+    int sampleRate_{48000};
+    int maxSeconds_{0};
+    bool compact16_{false};
+
+    // Planar storage; channel c occupies [c * capacity_, (c + 1) * capacity_)
+    size_t capacity_{0};
+    std::vector<float> floatData_;
+    std::vector<int16_t> shortData_;
+
+    // Total frames written (monotonic) and the audio thread's ring index
+    std::atomic<uint64_t> writePos_{0};
+    size_t writeIndex_{0};
+
+    // enabled_/processing_ let reallocation wait out a callback in flight
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> processing_{false};
+
+    // Headroom beyond the longest window so a capture in progress is not
+    // overwritten by the audio thread before it has been copied
+    static const int GUARD_SECONDS = 5;
+    static const int COPY_BLOCK_FRAMES = 16384;
+
+    std::thread captureThread_;
+    std::atomic<bool> capturing_{false};
+    std::atomic<bool> captureOk_{true};
+};
+
+#endif // RETROCAPTURE_H
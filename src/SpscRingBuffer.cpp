@@ -0,0 +1,76 @@
+#include "SpscRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+void SpscRingBuffer::reset(int numChannels, size_t minCapacityFrames)
+{
+    // Power-of-two capacity so positions wrap with a mask
+    size_t capacity = 1;
+    while (capacity < minCapacityFrames) {
+        capacity <<= 1;
+    }
+
+    numChannels_ = numChannels;
+    capacity_ = capacity;
+    mask_ = capacity - 1;
+    data_.assign(capacity * numChannels, 0.0f);
+    writePos_.value.store(0, std::memory_order_relaxed);
+    readPos_.value.store(0, std::memory_order_relaxed);
+}
+
+size_t SpscRingBuffer::write(const float* const* channels, size_t numFrames)
+{
+    const size_t write = writePos_.value.load(std::memory_order_relaxed);
+    const size_t read = readPos_.value.load(std::memory_order_acquire);
+    const size_t frames = std::min(numFrames, capacity_ - (write - read));
+    if (frames == 0) {
+        return 0;
+    }
+
+    const size_t start = write & mask_;
+    const size_t first = std::min(frames, capacity_ - start);
+    for (int ch = 0; ch < numChannels_; ++ch) {
+        float* base = data_.data() + ch * capacity_;
+        std::memcpy(base + start, channels[ch], first * sizeof(float));
+        std::memcpy(base, channels[ch] + first, (frames - first) * sizeof(float));
+    }
+
+    writePos_.value.store(write + frames, std::memory_order_release);
+    return frames;
+}
+
+size_t SpscRingBuffer::read(float* const* channels, size_t maxFrames)
+{
+    const size_t read = readPos_.value.load(std::memory_order_relaxed);
+    const size_t write = writePos_.value.load(std::memory_order_acquire);
+    const size_t frames = std::min(maxFrames, write - read);
+    if (frames == 0) {
+        return 0;
+    }
+
+    const size_t start = read & mask_;
+    const size_t first = std::min(frames, capacity_ - start);
+    for (int ch = 0; ch < numChannels_; ++ch) {
+        const float* base = data_.data() + ch * capacity_;
+        std::memcpy(channels[ch], base + start, first * sizeof(float));
+        std::memcpy(channels[ch] + first, base, (frames - first) * sizeof(float));
+    }
+
+    readPos_.value.store(read + frames, std::memory_order_release);
+    return frames;
+}
+
+void SpscRingBuffer::discardAll()
+{
+    readPos_.value.store(writePos_.value.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+size_t SpscRingBuffer::getReadAvailable() const
+{
+    return writePos_.value.load(std::memory_order_acquire) - readPos_.value.load(std::memory_order_relaxed);
+}
+
+size_t SpscRingBuffer::getWriteAvailable() const
+{
+    return capacity_ - (writePos_.value.load(std::memory_order_relaxed) - readPos_.value.load(std::memory_order_acquire));
+}
@@ -0,0 +1,48 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Wait-free single-producer / single-consumer ring of planar float frames.
+// The producer (audio thread) only writes writePos_, the consumer only
+// writes readPos_; each sits on its own cache line. Data moves in at most
+// two memcpy segments per channel.
+class SpscRingBuffer {
+public:
+    SpscRingBuffer() = default;
+
+    // Not thread-safe: call while neither side is running
+    void reset(int numChannels, size_t minCapacityFrames);
+
+    // Producer side. Returns the number of frames stored; the remainder
+    // did not fit and is the caller's to count as dropped.
+    size_t write(const float* const* channels, size_t numFrames);
+
+    // Consumer side
+    size_t read(float* const* channels, size_t maxFrames);
+    void discardAll();
+
+    size_t getReadAvailable() const;
+    size_t getWriteAvailable() const;
+    size_t getCapacity() const { return capacity_; }
+    int getNumChannels() const { return numChannels_; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    int numChannels_{0};
+    size_t capacity_{0};
+    size_t mask_{0};
+    std::vector<float> data_; // channel c occupies [c * capacity_, (c + 1) * capacity_)
+
+    // alignas pads each index out to a full cache line
+    struct alignas(CACHE_LINE) PaddedIndex {
+        std::atomic<size_t> value{0};
+    };
+    PaddedIndex writePos_;
+    PaddedIndex readPos_;
+};
+
+#endif // SPSCRINGBUFFER_H
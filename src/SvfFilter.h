@@ -0,0 +1,293 @@
+#ifndef SVFFILTER_H
+#define SVFFILTER_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SVFFILTER_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SVFFILTER_NEON 1
+#endif
+
+// Coefficients of a state-variable filter with trapezoidal integrators
+// (Simper's form): a1..a3 run the filter, m0..m2 mix the input, band and
+// low outputs into the response. Unlike a direct-form biquad it stays
+// stable and quiet while the coefficients move and keeps its precision at
+// low cutoffs and high sample rates, so filters can be swept and ramped.
+template <typename T>
+struct SvfCoeffs {
+    T a1{1}, a2{0}, a3{0};
+    T m0{1}, m1{0}, m2{0};
+
+    // Same responses as the RBJ cookbook filters at a given Q; gains in dB
+    static SvfCoeffs lowPass(T freq, T q, int sampleRate);
+    static SvfCoeffs peak(T freq, T q, T gain, int sampleRate);
+    static SvfCoeffs lowShelf(T freq, T q, T gain, int sampleRate);
+    static SvfCoeffs highShelf(T freq, T q, T gain, int sampleRate);
+
+private:
+    void setTuning(T g, T k);
+};
+
+// tan(pi * f / fs), kept below Nyquist. Floats come from a table, so a
+// swept filter costs a lookup instead of a trig call; linear interpolation
+// stays within about 1e-6 of tan() below 0.45 fs.
+template <typename T>
+inline T svfPrewarp(T freq, int sampleRate)
+{
+    const T x = std::max(T(0), std::min(T(0.49), freq / sampleRate));
+    return std::tan(T(3.14159265358979323846) * x);
+}
+
+template <>
+inline float svfPrewarp<float>(float freq, int sampleRate)
+{
+    constexpr int TABLE_SIZE = 4096; // steps over 0..0.5
+    static const std::vector<float> table = [] {
+        std::vector<float> t(TABLE_SIZE + 1);
+        for (int i = 0; i <= TABLE_SIZE; ++i) {
+            t[i] = static_cast<float>(std::tan(3.14159265358979323846 * 0.5 * std::min(i, TABLE_SIZE - 1) / TABLE_SIZE));
+        }
+        return t;
+    }();
+
+    const float x = std::max(0.0f, std::min(0.49f, freq / sampleRate)) * (2.0f * TABLE_SIZE);
+    const int index = static_cast<int>(x);
+    const float frac = x - index;
+    return table[index] + (table[index + 1] - table[index]) * frac;
+}
+
+template <typename T>
+void SvfCoeffs<T>::setTuning(T g, T k)
+{
+    a1 = T(1) / (T(1) + g * (g + k));
+    a2 = g * a1;
+    a3 = g * a2;
+}
+
+template <typename T>
+SvfCoeffs<T> SvfCoeffs<T>::lowPass(T freq, T q, int sampleRate)
+{
+    SvfCoeffs c;
+    c.setTuning(svfPrewarp(freq, sampleRate), T(1) / q);
+    c.m0 = T(0);
+    c.m2 = T(1);
+    return c;
+}
+
+template <typename T>
+SvfCoeffs<T> SvfCoeffs<T>::peak(T freq, T q, T gain, int sampleRate)
+{
+    const T A = std::pow(T(10), gain / T(40));
+    const T k = T(1) / (q * A);
+    SvfCoeffs c;
+    c.setTuning(svfPrewarp(freq, sampleRate), k);
+    c.m1 = k * (A * A - T(1));
+    return c;
+}
+
+template <typename T>
+SvfCoeffs<T> SvfCoeffs<T>::lowShelf(T freq, T q, T gain, int sampleRate)
+{
+    const T A = std::pow(T(10), gain / T(40));
+    const T k = T(1) / q;
+    SvfCoeffs c;
+    c.setTuning(svfPrewarp(freq, sampleRate) / std::sqrt(A), k);
+    c.m1 = k * (A - T(1));
+    c.m2 = A * A - T(1);
+    return c;
+}
+
+template <typename T>
+SvfCoeffs<T> SvfCoeffs<T>::highShelf(T freq, T q, T gain, int sampleRate)
+{
+    const T A = std::pow(T(10), gain / T(40));
+    const T k = T(1) / q;
+    SvfCoeffs c;
+    c.setTuning(svfPrewarp(freq, sampleRate) * std::sqrt(A), k);
+    c.m0 = A * A;
+    c.m1 = k * (T(1) - A) * A;
+    c.m2 = T(1) - A * A;
+    return c;
+}
+
+// One sample of every channel. Stereo float and double frames sit in one
+// SSE2/NEON register, so a filter runs both channels for about the cost of
+// one; other layouts fall back to plain loops with the same arithmetic.
+template <typename T, int Channels>
+struct SvfFrame {
+    T v[Channels];
+
+    static SvfFrame fill(T x)
+    {
+        SvfFrame f;
+        for (int ch = 0; ch < Channels; ++ch) f.v[ch] = x;
+        return f;
+    }
+    static SvfFrame load(const T* const* channels, int i)
+    {
+        SvfFrame f;
+        for (int ch = 0; ch < Channels; ++ch) f.v[ch] = channels[ch][i];
+        return f;
+    }
+    void store(T* const* channels, int i) const
+    {
+        for (int ch = 0; ch < Channels; ++ch) channels[ch][i] = v[ch];
+    }
+
+    SvfFrame operator+(const SvfFrame& o) const
+    {
+        SvfFrame f;
+        for (int ch = 0; ch < Channels; ++ch) f.v[ch] = v[ch] + o.v[ch];
+        return f;
+    }
+    SvfFrame operator-(const SvfFrame& o) const
+    {
+        SvfFrame f;
+        for (int ch = 0; ch < Channels; ++ch) f.v[ch] = v[ch] - o.v[ch];
+        return f;
+    }
+    SvfFrame operator*(const SvfFrame& o) const
+    {
+        SvfFrame f;
+        for (int ch = 0; ch < Channels; ++ch) f.v[ch] = v[ch] * o.v[ch];
+        return f;
+    }
+};
+
+#if defined(SVFFILTER_SSE2)
+template <>
+struct SvfFrame<float, 2> {
+    __m128 v; // L, R, 0, 0
+
+    static SvfFrame fill(float x) { return { _mm_set1_ps(x) }; }
+    static SvfFrame load(const float* const* channels, int i)
+    {
+        return { _mm_unpacklo_ps(_mm_load_ss(channels[0] + i), _mm_load_ss(channels[1] + i)) };
+    }
+    void store(float* const* channels, int i) const
+    {
+        _mm_store_ss(channels[0] + i, v);
+        _mm_store_ss(channels[1] + i, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+
+    SvfFrame operator+(const SvfFrame& o) const { return { _mm_add_ps(v, o.v) }; }
+    SvfFrame operator-(const SvfFrame& o) const { return { _mm_sub_ps(v, o.v) }; }
+    SvfFrame operator*(const SvfFrame& o) const { return { _mm_mul_ps(v, o.v) }; }
+};
+
+template <>
+struct SvfFrame<double, 2> {
+    __m128d v;
+
+    static SvfFrame fill(double x) { return { _mm_set1_pd(x) }; }
+    static SvfFrame load(const double* const* channels, int i)
+    {
+        return { _mm_unpacklo_pd(_mm_load_sd(channels[0] + i), _mm_load_sd(channels[1] + i)) };
+    }
+    void store(double* const* channels, int i) const
+    {
+        _mm_store_sd(channels[0] + i, v);
+        _mm_storeh_pd(channels[1] + i, v);
+    }
+
+    SvfFrame operator+(const SvfFrame& o) const { return { _mm_add_pd(v, o.v) }; }
+    SvfFrame operator-(const SvfFrame& o) const { return { _mm_sub_pd(v, o.v) }; }
+    SvfFrame operator*(const SvfFrame& o) const { return { _mm_mul_pd(v, o.v) }; }
+};
+#elif defined(SVFFILTER_NEON)
+template <>
+struct SvfFrame<float, 2> {
+    float32x2_t v;
+
+    static SvfFrame fill(float x) { return { vdup_n_f32(x) }; }
+    static SvfFrame load(const float* const* channels, int i)
+    {
+        return { vset_lane_f32(channels[1][i], vdup_n_f32(channels[0][i]), 1) };
+    }
+    void store(float* const* channels, int i) const
+    {
+        vst1_lane_f32(channels[0] + i, v, 0);
+        vst1_lane_f32(channels[1] + i, v, 1);
+    }
+
+    SvfFrame operator+(const SvfFrame& o) const { return { vadd_f32(v, o.v) }; }
+    SvfFrame operator-(const SvfFrame& o) const { return { vsub_f32(v, o.v) }; }
+    SvfFrame operator*(const SvfFrame& o) const { return { vmul_f32(v, o.v) }; }
+};
+
+template <>
+struct SvfFrame<double, 2> {
+    float64x2_t v;
+
+    static SvfFrame fill(double x) { return { vdupq_n_f64(x) }; }
+    static SvfFrame load(const double* const* channels, int i)
+    {
+        return { vsetq_lane_f64(channels[1][i], vdupq_n_f64(channels[0][i]), 1) };
+    }
+    void store(double* const* channels, int i) const
+    {
+        vst1q_lane_f64(channels[0] + i, v, 0);
+        vst1q_lane_f64(channels[1] + i, v, 1);
+    }
+
+    SvfFrame operator+(const SvfFrame& o) const { return { vaddq_f64(v, o.v) }; }
+    SvfFrame operator-(const SvfFrame& o) const { return { vsubq_f64(v, o.v) }; }
+    SvfFrame operator*(const SvfFrame& o) const { return { vmulq_f64(v, o.v) }; }
+};
+#endif
+
+// Topology-preserving state-variable filter over Channels channels that
+// share one set of coefficients. The shared primitive for every filter in
+// the chain (EQ bands, delay high-cut).
+template <typename T, int Channels>
+class SvfFilter {
+public:
+    using Frame = SvfFrame<T, Channels>;
+
+    // Coefficients spread across the channels; prepare once per change
+    struct Prepared {
+        Prepared() : Prepared(SvfCoeffs<T>()) {}
+        explicit Prepared(const SvfCoeffs<T>& c)
+            : a1(Frame::fill(c.a1)), a2(Frame::fill(c.a2)), a3(Frame::fill(c.a3)),
+              m0(Frame::fill(c.m0)), m1(Frame::fill(c.m1)), m2(Frame::fill(c.m2)) {}
+
+        Frame a1, a2, a3, m0, m1, m2;
+    };
+
+    void reset()
+    {
+        ic1_ = Frame::fill(T(0));
+        ic2_ = Frame::fill(T(0));
+    }
+
+    // One frame. Inline, so a cascade of filters keeps it in registers.
+    Frame process(const Frame& x, const Prepared& c)
+    {
+        const Frame v3 = x - ic2_;
+        const Frame v1 = c.a1 * ic1_ + c.a2 * v3;
+        const Frame v2 = ic2_ + c.a2 * ic1_ + c.a3 * v3;
+        ic1_ = v1 + v1 - ic1_;
+        ic2_ = v2 + v2 - ic2_;
+        return c.m0 * x + c.m1 * v1 + c.m2 * v2;
+    }
+
+    // Planar block, in place
+    void process(T* const* channels, int numFrames, const SvfCoeffs<T>& coeffs)
+    {
+        const Prepared c(coeffs);
+        for (int i = 0; i < numFrames; ++i) {
+            process(Frame::load(channels, i), c).store(channels, i);
+        }
+    }
+
+private:
+    Frame ic1_ = Frame::fill(T(0));
+    Frame ic2_ = Frame::fill(T(0));
+};
+
+#endif // SVFFILTER_H
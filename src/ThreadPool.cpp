@@ -0,0 +1,113 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace {
+    // Which pool and worker the current thread belongs to, if any
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local int currentWorker = -1;
+}
+
+ThreadPool::ThreadPool(int numThreads)
+{
+    if (numThreads <= 0) {
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    queues_.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers_.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wakeCV_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    int index = (currentPool == this)
+        ? currentWorker
+        : static_cast<int>(nextQueue_.fetch_add(1) % queues_.size());
+    // Counted before it becomes visible, so finishing it can never take
+    // pending_ below zero; under the sleep lock so a worker about to wait sees it
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        pending_.fetch_add(1);
+        queued_.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    wakeCV_.notify_one();
+}
+
+void ThreadPool::waitAll()
+{
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    idleCV_.wait(lock, [this] { return pending_.load() == 0; });
+}
+
+bool ThreadPool::popLocal(int index, std::function<void()>& task)
+{
+    // Newest first: its data is most likely still in this core's cache
+    WorkerQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(int thief, std::function<void()>& task)
+{
+    // Oldest first from the victim, away from where its owner works
+    const int numQueues = static_cast<int>(queues_.size());
+    for (int offset = 1; offset < numQueues; ++offset) {
+        WorkerQueue& queue = *queues_[(thief + offset) % numQueues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    std::function<void()> task;
+    while (true) {
+        if (popLocal(index, task) || steal(index, task)) {
+            queued_.fetch_sub(1);
+            task();
+            task = nullptr;
+
+            if (pending_.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(sleepMutex_);
+                idleCV_.notify_all();
+            }
+            continue;
+        }
+
+        // Queued work is finished before shutting down
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeCV_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+        if (stopping_ && queued_.load() == 0) return;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+// Work-stealing pool for offline work (batch renders) that must stay off
+// both the UI and audio threads. Each worker has its own deque: outside
+// submissions are dealt round-robin, tasks submitted from a worker stay on
+// its deque, and an idle worker steals from the far end of another's, so a
+// batch of uneven jobs keeps every core busy until the end.
+class ThreadPool {
+public:
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(int numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Blocks until every submitted task has finished
+    void waitAll();
+
+    int getNumThreads() const { return static_cast<int>(workers_.size()); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(int index);
+    bool popLocal(int index, std::function<void()>& task);
+    bool steal(int thief, std::function<void()>& task);
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::atomic<unsigned> nextQueue_{0};
+
+    // queued_ counts tasks sitting in deques, pending_ also counts running ones
+    std::atomic<int> queued_{0};
+    std::atomic<int> pending_{0};
+
+    std::mutex sleepMutex_;
+    std::condition_variable wakeCV_;
+    std::condition_variable idleCV_;
+    bool stopping_{false};
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,164 @@
+#include "TimeStretcher.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define TIMESTRETCHER_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define TIMESTRETCHER_NEON 1
+#endif
+
+namespace {
+    constexpr float PI = 3.14159265358979323846f;
+
+    // Correlation kernel for the splice search; this is where WSOLA spends its time
+    float dotProduct(const float* a, const float* b, int n)
+    {
+        int i = 0;
+        float sum = 0.0f;
+#if defined(TIMESTRETCHER_SSE)
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        for (; i + 8 <= n; i += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+        sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(TIMESTRETCHER_NEON)
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        for (; i + 8 <= n; i += 8) {
+            acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+            acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+        sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+        for (; i < n; ++i) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    // acc[i] += src[i] * window[i]
+    void addWindowed(float* acc, const float* src, const float* window, int n)
+    {
+        int i = 0;
+#if defined(TIMESTRETCHER_SSE)
+        for (; i + 4 <= n; i += 4) {
+            __m128 w = _mm_loadu_ps(window + i);
+            _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(_mm_loadu_ps(src + i), w)));
+        }
+#elif defined(TIMESTRETCHER_NEON)
+        for (; i + 4 <= n; i += 4) {
+            vst1q_f32(acc + i, vmlaq_f32(vld1q_f32(acc + i), vld1q_f32(src + i), vld1q_f32(window + i)));
+        }
+#endif
+        for (; i < n; ++i) {
+            acc[i] += src[i] * window[i];
+        }
+    }
+}
+
+TimeStretcher::TimeStretcher()
+{
+    setSampleRate(48000);
+}
+
+void TimeStretcher::setSampleRate(int sampleRate)
+{
+    sampleRate_ = sampleRate;
+
+    // ~40 ms frames with 50% overlap, splice search of +/- 5 ms
+    frameSize_ = std::max(64, static_cast<int>(sampleRate * 0.04f)) & ~1;
+    hopSize_ = frameSize_ / 2;
+    tolerance_ = frameSize_ / 8;
+
+    // Periodic Hann sums to a constant at 50% overlap
+    window_.resize(frameSize_);
+    for (int i = 0; i < frameSize_; ++i) {
+        window_[i] = 0.5f * (1.0f - std::cos(2.0f * PI * i / frameSize_));
+    }
+}
+
+void TimeStretcher::process(const float* inL, const float* inR, int inLength,
+                            float* outL, float* outR, int outLength)
+{
+    if (inLength <= 0 || outLength <= 0) return;
+
+    // Pad the input with wrapped copies so every window and search candidate
+    // is a contiguous read
+    const int extLength = inLength + 2 * frameSize_;
+    monoExt_.resize(extLength);
+    leftExt_.resize(extLength);
+    rightExt_.resize(extLength);
+    for (int i = 0; i < extLength; ++i) {
+        int src = i % inLength;
+        leftExt_[i] = inL[src];
+        rightExt_[i] = inR[src];
+        monoExt_[i] = inL[src] + inR[src];
+    }
+
+    const int numFrames = (outLength + hopSize_ - 1) / hopSize_;
+    const int accLength = numFrames * hopSize_ + frameSize_;
+    accL_.assign(accLength, 0.0f);
+    accR_.assign(accLength, 0.0f);
+    accWeight_.assign(accLength, 0.0f);
+
+    const double analysisHop = static_cast<double>(hopSize_) * inLength / outLength;
+    const int overlap = frameSize_ - hopSize_;
+    int prevStart = 0;
+
+    for (int k = 0; k < numFrames; ++k) {
+        int start = 0;
+        if (k > 0) {
+            // Pick the input position whose start best continues the previous frame
+            int nominal = static_cast<int>(std::lround(k * analysisHop));
+            const float* reference = monoExt_.data() + prevStart + hopSize_;
+            start = findBestOffset(reference, nominal, overlap);
+            start %= inLength;
+        }
+
+        const int outPos = k * hopSize_;
+        addWindowed(accL_.data() + outPos, leftExt_.data() + start, window_.data(), frameSize_);
+        addWindowed(accR_.data() + outPos, rightExt_.data() + start, window_.data(), frameSize_);
+        for (int i = 0; i < frameSize_; ++i) {
+            accWeight_[outPos + i] += window_[i];
+        }
+        prevStart = start;
+    }
+
+    // Fold the tail back onto the start so the output loops seamlessly
+    for (int i = outLength; i < accLength; ++i) {
+        int dst = i % outLength;
+        accL_[dst] += accL_[i];
+        accR_[dst] += accR_[i];
+        accWeight_[dst] += accWeight_[i];
+    }
+
+    for (int i = 0; i < outLength; ++i) {
+        float norm = accWeight_[i] > 1e-6f ? 1.0f / accWeight_[i] : 0.0f;
+        outL[i] = accL_[i] * norm;
+        outR[i] = accR_[i] * norm;
+    }
+}
+
+int TimeStretcher::findBestOffset(const float* reference, int nominal, int overlap) const
+{
+    const int inLength = static_cast<int>(monoExt_.size()) - 2 * frameSize_;
+    int bestStart = ((nominal % inLength) + inLength) % inLength;
+    float bestScore = -1e30f;
+
+    for (int d = -tolerance_; d <= tolerance_; ++d) {
+        int candidate = (((nominal + d) % inLength) + inLength) % inLength;
+        float score = dotProduct(monoExt_.data() + candidate, reference, overlap);
+        if (score > bestScore) {
+            bestScore = score;
+            bestStart = candidate;
+        }
+    }
+    return bestStart;
+}
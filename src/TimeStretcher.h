@@ -0,0 +1,41 @@
+#ifndef TIMESTRETCHER_H
+#define TIMESTRETCHER_H
+
+#include <vector>
+
+// WSOLA time-stretcher for loop material. Input and output are treated as
+// circular, so a stretched loop wraps seamlessly at its new length. Both
+// channels share the same splice points to keep the stereo image intact.
+class TimeStretcher {
+public:
+    TimeStretcher();
+
+    void setSampleRate(int sampleRate);
+
+    // Stretches inLength samples to exactly outLength samples. Not real-time
+    // safe (allocates); meant for worker threads.
+    void process(const float* inL, const float* inR, int inLength,
+                 float* outL, float* outR, int outLength);
+
+private:
+    int findBestOffset(const float* reference, int nominal, int overlap) const;
+
+    int sampleRate_{48000};
+    int frameSize_{0};
+    int hopSize_{0};
+    int tolerance_{0};
+
+    std::vector<float> window_;
+
+    // Input padded with its own beginning so windows can run past the loop end
+    std::vector<float> monoExt_;
+    std::vector<float> leftExt_;
+    std::vector<float> rightExt_;
+
+    // Output accumulators (also padded, folded back onto the start at the end)
+    std::vector<float> accL_;
+    std::vector<float> accR_;
+    std::vector<float> accWeight_;
+};
+
+#endif // TIMESTRETCHER_H
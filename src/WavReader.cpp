@@ -0,0 +1,211 @@
+#include "WavReader.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WAVREADER_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define WAVREADER_NEON 1
+#endif
+
+namespace {
+    uint16_t readU16(const unsigned char* p)
+    {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    uint32_t readU32(const unsigned char* p)
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+             | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    uint64_t readU64(const unsigned char* p)
+    {
+        return static_cast<uint64_t>(readU32(p)) | (static_cast<uint64_t>(readU32(p + 4)) << 32);
+    }
+
+    int32_t decodeInt(const unsigned char* p, int bytes)
+    {
+        switch (bytes) {
+            case 1: return static_cast<int32_t>(p[0]) - 128;
+            case 2: return static_cast<int16_t>(readU16(p));
+            case 3: return static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 8) | (static_cast<uint32_t>(p[1]) << 16)
+                                                | (static_cast<uint32_t>(p[2]) << 24)) >> 8; // sign-extend
+            default: return static_cast<int32_t>(readU32(p));
+        }
+    }
+}
+
+bool WavReader::open(const std::string& filepath)
+{
+    close();
+    if (!file_.open(filepath)) {
+        return false;
+    }
+
+    const unsigned char* base = file_.data();
+    const size_t size = file_.size();
+    if (size < 12 || std::memcmp(base + 8, "WAVE", 4) != 0) {
+        close();
+        return false;
+    }
+    const bool rf64 = std::memcmp(base, "RF64", 4) == 0;
+    if (!rf64 && std::memcmp(base, "RIFF", 4) != 0) {
+        close();
+        return false;
+    }
+
+    uint64_t dataSize64 = 0;
+    uint16_t formatTag = 0;
+    bool haveFormat = false;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const unsigned char* chunk = base + pos;
+        const uint32_t chunkSize = readU32(chunk + 4);
+        const size_t body = pos + 8;
+
+        if (std::memcmp(chunk, "ds64", 4) == 0 && chunkSize >= 24 && body + 24 <= size) {
+            dataSize64 = readU64(base + body + 8);
+        } else if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 && body + 16 <= size) {
+            formatTag = readU16(base + body);
+            numChannels_ = readU16(base + body + 2);
+            sampleRate_ = static_cast<int>(readU32(base + body + 4));
+            blockAlign_ = readU16(base + body + 12);
+            bitsPerSample_ = readU16(base + body + 14);
+            if (formatTag == 0xFFFE && chunkSize >= 26 && body + 26 <= size) {
+                formatTag = readU16(base + body + 24); // WAVE_FORMAT_EXTENSIBLE sub-format
+            }
+            haveFormat = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) break;
+            uint64_t dataBytes = (rf64 && chunkSize == 0xFFFFFFFFu) ? dataSize64 : chunkSize;
+            // A take still being written may be shorter than its header claims
+            dataBytes = std::min<uint64_t>(dataBytes, size - body);
+            data_ = base + body;
+            isFloat_ = (formatTag == 3);
+            if (blockAlign_ > 0) {
+                numFrames_ = dataBytes / blockAlign_;
+            }
+            break;
+        }
+
+        pos = body + chunkSize + (chunkSize & 1);
+    }
+
+    const bool supported = (formatTag == 1 && bitsPerSample_ >= 8 && bitsPerSample_ <= 32 && bitsPerSample_ % 8 == 0)
+                        || (formatTag == 3 && bitsPerSample_ == 32);
+    if (!data_ || !supported || numChannels_ <= 0 || sampleRate_ <= 0
+        || blockAlign_ != numChannels_ * bitsPerSample_ / 8) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WavReader::close()
+{
+    file_.close();
+    data_ = nullptr;
+    sampleRate_ = 0;
+    numChannels_ = 0;
+    bitsPerSample_ = 0;
+    blockAlign_ = 0;
+    isFloat_ = false;
+    numFrames_ = 0;
+}
+
+int WavReader::read(uint64_t startFrame, float* const* channels, int numChannels, int numFrames) const
+{
+    if (!isOpen() || startFrame >= numFrames_ || numFrames <= 0) {
+        return 0;
+    }
+
+    const int frames = static_cast<int>(std::min<uint64_t>(numFrames, numFrames_ - startFrame));
+    const int bytes = bitsPerSample_ / 8;
+    const float scale = isFloat_ ? 1.0f : 1.0f / static_cast<float>(1u << (bitsPerSample_ - 1));
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        const int source = std::min(ch, numChannels_ - 1);
+        const unsigned char* p = data_ + startFrame * blockAlign_ + source * bytes;
+        float* out = channels[ch];
+        if (isFloat_) {
+            for (int i = 0; i < frames; ++i, p += blockAlign_) {
+                std::memcpy(&out[i], p, sizeof(float));
+            }
+        } else if (bytes == 2 || bytes == 3) {
+            // Whole-word loads may read past the last sample, so the final
+            // frame of the file always goes through the scalar path
+            const bool atEnd = startFrame + frames == numFrames_;
+            convertPacked(p, blockAlign_, bytes, atEnd ? frames - 1 : frames, out);
+            if (atEnd) {
+                out[frames - 1] = decodeInt(p + static_cast<size_t>(frames - 1) * blockAlign_, bytes) * scale;
+            }
+        } else {
+            for (int i = 0; i < frames; ++i, p += blockAlign_) {
+                out[i] = decodeInt(p, bytes) * scale;
+            }
+        }
+    }
+    return frames;
+}
+
+void WavReader::convertPacked(const unsigned char* p, int stride, int bytes, int numFrames, float* out)
+{
+    // Each sample is loaded as a little-endian 32-bit word and shifted so its
+    // top byte is the sign, then sign-extended, converted and scaled together
+    const int shift = 32 - 8 * bytes;
+    const float scale = 1.0f / 2147483648.0f * static_cast<float>(1u << shift);
+    int i = 0;
+
+#if defined(WAVREADER_SSE2) || defined(WAVREADER_NEON)
+    for (; i + 4 <= numFrames; i += 4, p += 4 * stride) {
+        uint32_t words[4];
+        for (int k = 0; k < 4; ++k) {
+            std::memcpy(&words[k], p + k * stride, sizeof(uint32_t));
+        }
+#if defined(WAVREADER_SSE2)
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words));
+        v = _mm_srai_epi32(_mm_slli_epi32(v, shift), shift);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(scale)));
+#else
+        int32x4_t v = vreinterpretq_s32_u32(vld1q_u32(words));
+        v = vshlq_s32(vshlq_s32(v, vdupq_n_s32(shift)), vdupq_n_s32(-shift));
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(v), scale));
+#endif
+    }
+#endif
+
+    for (; i < numFrames; ++i, p += stride) {
+        out[i] = decodeInt(p, bytes) * scale;
+    }
+}
+
+void WavReader::prefetch(uint64_t startFrame, uint64_t numFrames) const
+{
+    if (!isOpen() || startFrame >= numFrames_) return;
+    numFrames = std::min(numFrames, numFrames_ - startFrame);
+    const size_t offset = static_cast<size_t>((data_ - file_.data()) + startFrame * blockAlign_);
+    file_.touch(offset, static_cast<size_t>(numFrames * blockAlign_));
+}
+
+int WavReader::readInt(uint64_t startFrame, int32_t* const* channels, int numChannels, int numFrames) const
+{
+    if (!isOpen() || isFloat_ || startFrame >= numFrames_ || numFrames <= 0) {
+        return 0;
+    }
+
+    const int frames = static_cast<int>(std::min<uint64_t>(numFrames, numFrames_ - startFrame));
+    const int bytes = bitsPerSample_ / 8;
+    for (int ch = 0; ch < numChannels; ++ch) {
+        const int source = std::min(ch, numChannels_ - 1);
+        const unsigned char* p = data_ + startFrame * blockAlign_ + source * bytes;
+        int32_t* out = channels[ch];
+        for (int i = 0; i < frames; ++i, p += blockAlign_) {
+            out[i] = decodeInt(p, bytes);
+        }
+    }
+    return frames;
+}
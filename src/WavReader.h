@@ -0,0 +1,49 @@
+#ifndef WAVREADER_H
+#define WAVREADER_H
+
+#include <string>
+#include <cstdint>
+#include "MappedFile.h"
+
+// Read-only WAV / RF64 decoder over a memory mapping. The chunk list is
+// walked rather than read at fixed offsets, so files with JUNK, fact or
+// LIST chunks open correctly. Supports 8/16/24/32-bit PCM and 32-bit float;
+// 16 and 24-bit samples are converted to float four at a time with SIMD.
+class WavReader {
+public:
+    WavReader() = default;
+
+    bool open(const std::string& filepath);
+    void close();
+
+    bool isOpen() const { return file_.isOpen() && data_ != nullptr; }
+    int getSampleRate() const { return sampleRate_; }
+    int getNumChannels() const { return numChannels_; }
+    int getBitsPerSample() const { return bitsPerSample_; }
+    bool isFloat() const { return isFloat_; }
+    uint64_t getNumFrames() const { return numFrames_; }
+
+    // Planar float output; extra output channels repeat the last file channel.
+    // Returns the number of frames read.
+    int read(uint64_t startFrame, float* const* channels, int numChannels, int numFrames) const;
+
+    // Planar integers at the file's own bit depth (integer formats only)
+    int readInt(uint64_t startFrame, int32_t* const* channels, int numChannels, int numFrames) const;
+
+    // Faults in the mapped pages of a frame range ahead of a real-time reader
+    void prefetch(uint64_t startFrame, uint64_t numFrames) const;
+
+private:
+    static void convertPacked(const unsigned char* p, int stride, int bytes, int numFrames, float* out);
+
+    MappedFile file_;
+    const unsigned char* data_{nullptr};
+    int sampleRate_{0};
+    int numChannels_{0};
+    int bitsPerSample_{0};
+    int blockAlign_{0};
+    bool isFloat_{false};
+    uint64_t numFrames_{0};
+};
+
+#endif // WAVREADER_H
@@ -0,0 +1,164 @@
+#include "WavWriter.h"
+
+namespace {
+    // RIFF(12) + JUNK/ds64(36) + fmt + [fact(12)] + data header(8)
+    constexpr uint32_t DS64_SIZE = 28;
+    constexpr uint64_t RIFF_LIMIT = 0xFFFFFFFFull;
+    constexpr uint32_t FMT_EXTENSIBLE_SIZE = 40;
+
+    // KSDATAFORMAT_SUBTYPE_PCM / _IEEE_FLOAT after the leading format code
+    const unsigned char SUBFORMAT_GUID_TAIL[12] = {
+        0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+    };
+
+    // Mono and stereo map to speakers; wider files are stems, left unassigned
+    uint32_t channelMask(int numChannels)
+    {
+        if (numChannels == 1) return 0x4; // front centre
+        if (numChannels == 2) return 0x3; // front left, front right
+        return 0;
+    }
+
+    void writeU32(std::ofstream& file, uint32_t value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), 4);
+    }
+
+    void writeU16(std::ofstream& file, uint16_t value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), 2);
+    }
+
+    void writeU64(std::ofstream& file, uint64_t value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), 8);
+    }
+}
+
+WavWriter::~WavWriter()
+{
+    close();
+}
+
+bool WavWriter::open(const std::string& filepath, int sampleRate, int numChannels)
+{
+    close();
+
+    file_.open(filepath, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    path_ = filepath;
+    sampleRate_ = sampleRate;
+    numChannels_ = numChannels;
+    framesWritten_ = 0;
+    bytesPerSample_ = converter_.getBytesPerSample();
+    isFloat_ = converter_.getFormat() == SampleFormat::Float32;
+    extensible_ = numChannels_ > 2 || bytesPerSample_ > 2;
+    const uint32_t fmtSize = extensible_ ? FMT_EXTENSIBLE_SIZE : (isFloat_ ? 18 : 16);
+    dataOffset_ = 12 + (8 + DS64_SIZE) + (8 + fmtSize) + (isFloat_ ? 12 : 0) + 8;
+
+    writeHeader();
+    return file_.good();
+}
+
+void WavWriter::writeHeader()
+{
+    const uint32_t blockAlign = numChannels_ * bytesPerSample_;
+    const uint32_t byteRate = sampleRate_ * blockAlign;
+
+    // Past 4 GB the 32-bit sizes are set to 0xFFFFFFFF and the real values
+    // go into the ds64 chunk, which takes over the space reserved by JUNK
+    const uint64_t dataBytes = framesWritten_ * blockAlign;
+    const uint64_t riffBytes = dataOffset_ - 8 + dataBytes;
+    const bool rf64 = riffBytes > RIFF_LIMIT;
+
+    file_.write(rf64 ? "RF64" : "RIFF", 4);
+    writeU32(file_, rf64 ? 0xFFFFFFFFu : static_cast<uint32_t>(riffBytes));
+    file_.write("WAVE", 4);
+
+    if (rf64) {
+        file_.write("ds64", 4);
+        writeU32(file_, DS64_SIZE);
+        writeU64(file_, riffBytes);
+        writeU64(file_, dataBytes);
+        writeU64(file_, framesWritten_);
+        writeU32(file_, 0); // no table entries
+    } else {
+        static const char zeros[DS64_SIZE] = {};
+        file_.write("JUNK", 4);
+        writeU32(file_, DS64_SIZE);
+        file_.write(zeros, DS64_SIZE);
+    }
+
+    // fmt chunk
+    const uint16_t formatCode = isFloat_ ? 3 : 1; // IEEE float : PCM
+    const uint16_t bits = static_cast<uint16_t>(bytesPerSample_ * 8);
+    file_.write("fmt ", 4);
+    writeU32(file_, extensible_ ? FMT_EXTENSIBLE_SIZE : (isFloat_ ? 18 : 16));
+    writeU16(file_, extensible_ ? 0xFFFE : formatCode);
+    writeU16(file_, static_cast<uint16_t>(numChannels_));
+    writeU32(file_, static_cast<uint32_t>(sampleRate_));
+    writeU32(file_, byteRate);
+    writeU16(file_, static_cast<uint16_t>(blockAlign));
+    writeU16(file_, bits);
+    if (extensible_) {
+        writeU16(file_, 22); // cbSize
+        writeU16(file_, bits); // valid bits
+        writeU32(file_, channelMask(numChannels_));
+        writeU32(file_, formatCode);
+        file_.write(reinterpret_cast<const char*>(SUBFORMAT_GUID_TAIL), sizeof(SUBFORMAT_GUID_TAIL));
+    } else if (isFloat_) {
+        writeU16(file_, 0); // cbSize
+    }
+    if (isFloat_) {
+        // Non-PCM formats carry a fact chunk with the frame count
+        file_.write("fact", 4);
+        writeU32(file_, 4);
+        writeU32(file_, rf64 ? 0xFFFFFFFFu : static_cast<uint32_t>(framesWritten_));
+    }
+
+    // data chunk
+    file_.write("data", 4);
+    writeU32(file_, rf64 ? 0xFFFFFFFFu : static_cast<uint32_t>(dataBytes));
+}
+
+bool WavWriter::write(const float* const* channels, int numFrames)
+{
+    if (!file_.is_open() || numFrames <= 0) {
+        return false;
+    }
+
+    // Convert the whole block and issue a single write
+    byteBuffer_.resize(static_cast<size_t>(numFrames) * numChannels_ * bytesPerSample_);
+    converter_.convert(channels, numChannels_, numFrames, byteBuffer_.data());
+    file_.write(reinterpret_cast<const char*>(byteBuffer_.data()), static_cast<std::streamsize>(byteBuffer_.size()));
+    framesWritten_ += numFrames;
+    return file_.good();
+}
+
+bool WavWriter::updateHeader()
+{
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    std::streampos end = file_.tellp();
+    file_.seekp(0);
+    writeHeader();
+    file_.seekp(end);
+    file_.flush();
+    return file_.good();
+}
+
+bool WavWriter::close()
+{
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    bool ok = updateHeader();
+    file_.close();
+    return ok;
+}
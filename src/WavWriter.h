@@ -0,0 +1,52 @@
+#ifndef WAVWRITER_H
+#define WAVWRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "PcmConverter.h"
+
+// Incremental WAV writer (16/24-bit PCM or 32-bit float). Audio is appended
+// in blocks and the header sizes can be refreshed at any time, so the file on
+// disk is always a valid WAV up to the last updateHeader() call. Space for a
+// ds64 chunk is reserved up front, so a take that grows past 4 GB is promoted
+// to RF64 in place without moving any audio. More than two channels or
+// more than 16 bits use a WAVE_FORMAT_EXTENSIBLE fmt chunk, as the format
+// requires.
+class WavWriter {
+public:
+    WavWriter() = default;
+    ~WavWriter();
+
+    // Format and dither apply to the next open()
+    void setFormat(SampleFormat format) { converter_.setFormat(format); }
+    void setDither(bool enabled) { converter_.setDither(enabled); }
+    void setGain(float gain) { converter_.setGain(gain); }
+
+    bool open(const std::string& filepath, int sampleRate, int numChannels);
+    bool write(const float* const* channels, int numFrames);
+    bool updateHeader();
+    bool close();
+
+    bool isOpen() const { return file_.is_open(); }
+    uint64_t getFramesWritten() const { return framesWritten_; }
+    const std::string& getPath() const { return path_; }
+
+private:
+    void writeHeader();
+
+    std::ofstream file_;
+    std::string path_;
+    int sampleRate_{48000};
+    int numChannels_{2};
+    uint64_t framesWritten_{0};
+    int bytesPerSample_{3};
+    bool isFloat_{false};
+    bool extensible_{false};
+    uint32_t dataOffset_{0};
+    PcmConverter converter_;
+    std::vector<unsigned char> byteBuffer_;
+};
+
+#endif // WAVWRITER_H
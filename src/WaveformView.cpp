@@ -0,0 +1,134 @@
+#include "WaveformView.h"
+#include <QPainter>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <algorithm>
+#include <cmath>
+
+WaveformView::WaveformView(QWidget* parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(70);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
+
+bool WaveformView::setPeakFile(const QString& path, qint64 sourceSize, qint64 sourceMtime)
+{
+    peaks_.close();
+    position_ = 0.0;
+    if (peaks_.open(path.toStdString())
+        && !peaks_.matches(static_cast<uint64_t>(sourceSize), sourceMtime)) {
+        peaks_.close();
+    }
+    viewStart_ = 0.0;
+    viewFrames_ = peaks_.isOpen() ? static_cast<double>(peaks_.getNumFrames()) : 0.0;
+    update();
+    return peaks_.isOpen();
+}
+
+void WaveformView::clear()
+{
+    peaks_.close();
+    position_ = 0.0;
+    viewStart_ = 0.0;
+    viewFrames_ = 0.0;
+    update();
+}
+
+void WaveformView::setPosition(double fraction)
+{
+    fraction = std::max(0.0, std::min(1.0, fraction));
+    if (fraction == position_) return;
+    position_ = fraction;
+    update();
+}
+
+double WaveformView::fractionAt(double x) const
+{
+    if (!peaks_.isOpen() || peaks_.getNumFrames() == 0 || width() <= 0) return 0.0;
+    double frame = viewStart_ + viewFrames_ * x / width();
+    return std::max(0.0, std::min(1.0, frame / peaks_.getNumFrames()));
+}
+
+void WaveformView::clampView()
+{
+    const double total = static_cast<double>(peaks_.getNumFrames());
+    const double minFrames = std::max(1.0, MAX_ZOOM_FRAMES_PER_PIXEL * width());
+    viewFrames_ = std::max(std::min(viewFrames_, total), std::min(minFrames, total));
+    viewStart_ = std::max(0.0, std::min(viewStart_, total - viewFrames_));
+}
+
+void WaveformView::wheelEvent(QWheelEvent* event)
+{
+    if (!peaks_.isOpen() || width() <= 0) return;
+
+    // Zoom around the frame under the cursor
+    const double x = event->position().x();
+    const double anchor = viewStart_ + viewFrames_ * x / width();
+    const double steps = event->angleDelta().y() / 120.0;
+    viewFrames_ *= std::pow(0.8, steps);
+    clampView();
+    viewStart_ = anchor - viewFrames_ * x / width();
+    clampView();
+    update();
+    event->accept();
+}
+
+void WaveformView::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton && peaks_.isOpen()) {
+        emit seekRequested(fractionAt(event->position().x()));
+    }
+}
+
+void WaveformView::paintEvent(QPaintEvent*)
+{
+    QPainter painter(this);
+    const QColor background = palette().color(QPalette::Base);
+    const QColor outline = palette().color(QPalette::Highlight);
+    QColor body = outline.lighter(150);
+    painter.fillRect(rect(), background);
+
+    if (!peaks_.isOpen() || peaks_.getNumFrames() == 0 || width() <= 0) {
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(rect(), Qt::AlignCenter, "No waveform");
+        return;
+    }
+
+    const int w = width();
+    const int numChannels = peaks_.getNumChannels();
+    const double laneHeight = static_cast<double>(height()) / numChannels;
+
+    // Coarsest level that still has at least one bin per pixel column
+    const double framesPerPixel = viewFrames_ / w;
+    const int level = peaks_.chooseLevel(framesPerPixel);
+    const double framesPerBin = peaks_.getFramesPerBin(level);
+    const uint64_t numBins = peaks_.getNumBins(level);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        const double mid = laneHeight * (ch + 0.5);
+        const double half = laneHeight * 0.5 - 1.0;
+
+        for (int x = 0; x < w; ++x) {
+            const double startFrame = viewStart_ + x * framesPerPixel;
+            uint64_t first = static_cast<uint64_t>(startFrame / framesPerBin);
+            uint64_t last = static_cast<uint64_t>(std::ceil((startFrame + framesPerPixel) / framesPerBin));
+            if (first >= numBins) break;
+            last = std::min(std::max(last, first + 1), numBins);
+
+            const PeakFile::Bin bin = peaks_.getRange(level, ch, first, last);
+            painter.setPen(outline);
+            painter.drawLine(QPointF(x + 0.5, mid - bin.max * half), QPointF(x + 0.5, mid - bin.min * half));
+            painter.setPen(body);
+            painter.drawLine(QPointF(x + 0.5, mid - bin.rms * half), QPointF(x + 0.5, mid + bin.rms * half));
+        }
+    }
+
+    // Playback cursor
+    const double cursorFrame = position_ * peaks_.getNumFrames();
+    if (cursorFrame >= viewStart_ && cursorFrame <= viewStart_ + viewFrames_) {
+        const double cx = (cursorFrame - viewStart_) / viewFrames_ * w;
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawLine(QPointF(cx, 0), QPointF(cx, height()));
+    }
+}
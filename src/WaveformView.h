@@ -0,0 +1,48 @@
+#ifndef WAVEFORMVIEW_H
+#define WAVEFORMVIEW_H
+
+#include <QWidget>
+#include <QString>
+#include "PeakFile.h"
+
+// Clip overview drawn from its peak sidecar: min/max outline with the RMS
+// body, one column per pixel. The wheel zooms around the cursor and a
+// click asks for a seek, so the audio file itself is never read.
+class WaveformView : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit WaveformView(QWidget* parent = nullptr);
+
+    // Opens the sidecar if it was built from this version of the clip;
+    // otherwise the view stays empty until the index rebuilds it
+    bool setPeakFile(const QString& path, qint64 sourceSize, qint64 sourceMtime);
+    void clear();
+    bool hasPeaks() const { return peaks_.isOpen(); }
+
+    // Playback cursor, as a fraction of the clip
+    void setPosition(double fraction);
+
+signals:
+    void seekRequested(double fraction);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+
+private:
+    double fractionAt(double x) const;
+    void clampView();
+
+    PeakFile peaks_;
+    double position_{0.0};
+
+    // Visible window in frames
+    double viewStart_{0.0};
+    double viewFrames_{0.0};
+
+    static constexpr double MAX_ZOOM_FRAMES_PER_PIXEL = 1.0;
+};
+
+#endif // WAVEFORMVIEW_H